@@ -1,13 +1,20 @@
 #include "scriptbuilder.h"
 #include <vector>
+#include <deque>
+#include <algorithm>
 using namespace std;
 
 #include <stdio.h>
+#include <string.h>
 #if defined(_MSC_VER) && !defined(_WIN32_WCE)
 #include <direct.h>
 #endif
-#ifdef _WIN32_WCE
-#include <windows.h> // For GetModuleFileName
+#ifdef _WIN32
+#include <windows.h> // For GetModuleFileName, the loader threads and the timer
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
 #endif
 
 
@@ -15,14 +22,30 @@ BEGIN_AS_NAMESPACE
 
 // Helper functions
 static const char *GetCurrentDir(char *buf, size_t size);
+static asQWORD HashBuffer(const void *data, size_t size, asQWORD hash);
+static void   *CreateLock();
+static void    DestroyLock(void *lock);
+static void    Lock(void *lock);
+static void    Unlock(void *lock);
+static double  GetTimeMs();
+
+// FNV-1a 64 bit
+static const asQWORD HASH_OFFSET_BASIS = 14695981039346656037ULL;
+static const asQWORD HASH_PRIME        = 1099511628211ULL;
 
 CScriptBuilder::CScriptBuilder()
 {
 	engine = 0;
 	module = 0;
+	sectionsHash = HASH_OFFSET_BASIS;
+	definedWordsHash = HASH_OFFSET_BASIS;
+	memset(&statistics, 0, sizeof(statistics));
 
 	includeCallback = 0;
 	callbackParam   = 0;
+
+	loaderThreads = 1;
+	sectionCache  = 0;
 }
 
 void CScriptBuilder::SetIncludeCallback(INCLUDECALLBACK_t callback, void *userParam)
@@ -36,6 +59,7 @@ int CScriptBuilder::StartNewModule(asIScriptEngine *engine, const char *moduleNa
 	if( engine == 0 ) return -1;
 
 	this->engine = engine;
+	this->moduleName = moduleName;
 	module = engine->GetModule(moduleName, asGM_ALWAYS_CREATE);
 	if( module == 0 )
 		return -1;
@@ -50,8 +74,21 @@ int CScriptBuilder::AddSectionFromFile(const char *filename)
 	// TODO: The file name stored in the set should be the fully resolved name because
 	// it is possible to name the same file in multiple ways using relative paths.
 
+	// Read the whole include tree ahead in parallel, unless that is already being done
+	if( loaderThreads > 1 && includeCallback == 0 && prefetched.empty() &&
+		includedScripts.find(filename) == includedScripts.end() )
+		return LoadIncludeTree(filename);
+
 	if( IncludeIfNotAlreadyIncluded(filename) )
 	{
+		map<string, SPreprocessedSection>::iterator it = prefetched.find(filename);
+		if( it != prefetched.end() )
+		{
+			if( it->second.result < 0 )
+				return it->second.result;
+			return AddPreprocessedSection(filename, it->second);
+		}
+
 		int r = LoadScriptSection(filename);
 		if( r < 0 )
 			return r;
@@ -77,24 +114,84 @@ int CScriptBuilder::BuildModule()
 	return Build();
 }
 
+int CScriptBuilder::LoadModule(asIBinaryStream *in)
+{
+	if( module == 0 || in == 0 )
+		return -1;
+
+	double start = GetTimeMs();
+	int r = module->LoadByteCode(in);
+	statistics.loadTime += GetTimeMs() - start;
+	if( r < 0 )
+	{
+		// Start over with an empty module, the sections are still there to build it
+		module = engine->GetModule(moduleName.c_str(), asGM_ALWAYS_CREATE);
+		return r;
+	}
+
+	StoreMetadata();
+
+	return 0;
+}
+
+asQWORD CScriptBuilder::GetSectionsHash() const
+{
+	return sectionsHash;
+}
+
+const vector<CScriptBuilder::SSectionDependency> &CScriptBuilder::GetDependencies() const
+{
+	return dependencies;
+}
+
+const CScriptBuilder::SBuildStatistics &CScriptBuilder::GetStatistics() const
+{
+	return statistics;
+}
+
 void CScriptBuilder::DefineWord(const char *word)
 {
 	string sword = word;
 	if( definedWords.find(sword) == definedWords.end() )
 	{
 		definedWords.insert(sword);
+
+		// The set is ordered, so the hash doesn't depend on the order the words were defined in
+		definedWordsHash = HASH_OFFSET_BASIS;
+		for( set<string>::iterator it = definedWords.begin(); it != definedWords.end(); it++ )
+			definedWordsHash = HashBuffer(it->c_str(), it->size() + 1, definedWordsHash);
 	}
 }
 
+void CScriptBuilder::SetLoaderThreads(int count)
+{
+	loaderThreads = count > 1 ? count : 1;
+}
+
+void CScriptBuilder::SetSectionCache(CSectionCache *cache)
+{
+	sectionCache = cache;
+}
+
 void CScriptBuilder::ClearAll()
 {
 	includedScripts.clear();
+	prefetched.clear();
+	sections.clear();
+	dependencies.clear();
+	macros.clear();
+	memset(&statistics, 0, sizeof(statistics));
+	sectionsHash = HASH_OFFSET_BASIS;
 
 #if AS_PROCESS_METADATA == 1	
 	foundDeclarations.clear();
 	typeMetadataMap.clear();
 	funcMetadataMap.clear();
 	varMetadataMap.clear();
+	typeAttributeMap.clear();
+	funcAttributeMap.clear();
+	varAttributeMap.clear();
+	attributeIndex.clear();
 #endif
 }
 
@@ -115,53 +212,584 @@ bool CScriptBuilder::IncludeIfNotAlreadyIncluded(const char *filename)
 
 int CScriptBuilder::ProcessScriptSection(const char *script, const char *sectionname)
 {
-	vector<string> includes;
+	SPreprocessedSection section;
+	PreprocessSection(sectionname, script, strlen(script), section);
 
-	// Perform a superficial parsing of the script first to store the metadata
-	modifiedScript = script;
+	return AddPreprocessedSection(sectionname, section);
+}
 
-	// First perform the checks for #if directives to exclude code that shouldn't be compiled
+int CScriptBuilder::AddPreprocessedSection(const char *sectionname, SPreprocessedSection &section)
+{
+	// Store the preprocessed section, it is added to the module when it gets built
+	sectionsHash = HashBuffer(sectionname, strlen(sectionname) + 1, sectionsHash);
+	sectionsHash = HashBuffer(section.code.c_str(), section.code.size(), sectionsHash);
+	statistics.sections++;
+	statistics.cachedSections += section.cached ? 1 : 0;
+	statistics.preprocessTime += section.preprocessTime;
+	statistics.metadataTime   += section.metadataTime;
+	statistics.tokens         += section.tokens;
+	statistics.bytes          += (asUINT)section.code.size();
+	statistics.lines          += 1;
+	for( size_t n = 0; n < section.code.size(); n++ )
+		if( section.code[n] == '\n' )
+			statistics.lines++;
+
+	sections.push_back(SScriptSection(sectionname, ""));
+	sections.back().code.swap(section.code);
+
+#if AS_PROCESS_METADATA == 1
+	foundDeclarations.insert(foundDeclarations.end(), section.declarations.begin(), section.declarations.end());
+#endif
+
+	// Remember where the section came from and what it includes. The callback
+	// resolves the includes itself, so they are kept as they were written then.
+	vector<string> &includes = section.includes;
+	if( includeCallback == 0 )
+	{
+		// By default we try to load the included file from the relative directory of the current file
+		for( int n = 0; n < (int)includes.size(); n++ )
+			includes[n] = ResolveInclude(includes[n], sectionname);
+	}
+
+	dependencies.push_back(SSectionDependency());
+	dependencies.back().name       = sectionname;
+	dependencies.back().sourceHash = section.sourceHash;
+	dependencies.back().includes   = includes;
+
+	// Collect the macros, they are expanded in all sections when the module is built
+	for( int n = 0; n < (int)section.macros.size(); n++ )
+	{
+		SMacro &macro = section.macros[n];
+		macro.section = sectionname;
+		if( macro.error.empty() )
+		{
+			map<string, SMacro>::iterator it = macros.find(macro.name);
+			if( it == macros.end() )
+				macros.insert(map<string, SMacro>::value_type(macro.name, macro));
+			else
+			{
+				// Defining the same macro twice is fine as long as it is the same
+				bool same = it->second.params == macro.params && it->second.body.size() == macro.body.size();
+				for( int i = 0; same && i < (int)macro.body.size(); i++ )
+					same = it->second.body[i].text == macro.body[i].text;
+				if( !same )
+					macro.error = "Macro '" + macro.name + "' is already defined differently in '" + it->second.section + "'";
+			}
+		}
+
+		if( !macro.error.empty() )
+		{
+			engine->WriteMessage(sectionname, macro.row, macro.col, asMSGTYPE_ERROR, macro.error.c_str());
+			return -1;
+		}
+
+		// The definitions were blanked out of the code, so a changed macro must go into the hash on its own
+		asUINT counts[2] = { (asUINT)macro.params.size(), (asUINT)macro.body.size() };
+		sectionsHash = HashBuffer(macro.name.c_str(), macro.name.size() + 1, sectionsHash);
+		sectionsHash = HashBuffer(counts, sizeof(counts), sectionsHash);
+		for( int i = 0; i < (int)macro.params.size(); i++ )
+			sectionsHash = HashBuffer(macro.params[i].c_str(), macro.params[i].size() + 1, sectionsHash);
+		for( int i = 0; i < (int)macro.body.size(); i++ )
+			sectionsHash = HashBuffer(macro.body[i].text.c_str(), macro.body[i].text.size() + 1, sectionsHash);
+	}
+
+	for( int n = 0; n < (int)includes.size(); n++ )
+	{
+		// If the callback has been set, then call it for each included file
+		int r;
+		if( includeCallback )
+			r = includeCallback(includes[n].c_str(), sectionname, this, callbackParam);
+		else
+			r = AddSectionFromFile(includes[n].c_str());
+		if( r < 0 )
+			return r;
+	}
+
+	return 0;
+}
+
+string CScriptBuilder::ResolveInclude(const string &include, const char *sectionname) const
+{
+	// If the include is a relative path, then prepend the path of the originating script
+	if( include.find_first_of("/\\") == 0 ||
+		include.find_first_of(":") != string::npos )
+		return include;
+
+	string path = sectionname;
+	size_t posOfSlash = path.find_last_of("/\\");
+	if( posOfSlash != string::npos )
+		path.resize(posOfSlash+1);
+	else
+		path = "";
+
+	return path + include;
+}
+
+int CScriptBuilder::LoadScriptSection(const char *filename)
+{
+	SPreprocessedSection section;
+	double readTime = 0;
+	int r = LoadAndPreprocessSection(filename, section, readTime);
+	statistics.readTime += readTime;
+	if( r < 0 )
+		return r;
+
+	return AddPreprocessedSection(filename, section);
+}
+
+int CScriptBuilder::ReadScriptSection(const char * /*filename*/, string & /*code*/)
+{
+	// The application must implement either this or LoadScriptSection
+	return -1;
+}
+
+int CScriptBuilder::MapScriptSection(const char * /*filename*/, const char *& /*data*/, size_t & /*length*/, void *& /*handle*/)
+{
+	// Mapping is optional, by default the file is read
+	return -1;
+}
+
+void CScriptBuilder::UnmapScriptSection(void * /*handle*/)
+{
+}
+
+int CScriptBuilder::LoadAndPreprocessSection(const char *filename, SPreprocessedSection &out, double &readTime)
+{
+	double start = GetTimeMs();
+
+	// A mapped file is preprocessed where it is, the
+	// preprocessed code is the only copy that is made
+	const char *data = 0;
+	size_t length = 0;
+	void *handle = 0;
+	if( MapScriptSection(filename, data, length, handle) >= 0 )
+	{
+		readTime = GetTimeMs() - start;
+
+		// Like any other script the section ends at the first null character
+		const char *end = (const char*)memchr(data, 0, length);
+		if( end )
+			length = end - data;
+
+		PreprocessSection(filename, data, length, out);
+		UnmapScriptSection(handle);
+		return 0;
+	}
+
+	string code;
+	int r = ReadScriptSection(filename, code);
+	readTime = GetTimeMs() - start;
+	if( r < 0 )
+		return r;
+
+	PreprocessSection(filename, code.c_str(), strlen(code.c_str()), out);
+	return 0;
+}
+
+// Counts the files that are queued for the loader threads
+class CWorkSemaphore
+{
+public:
+	CWorkSemaphore()
+	{
+#ifdef _WIN32
+		handle = CreateSemaphore(0, 0, 0x7fffffff, 0);
+#else
+		value = 0;
+		pthread_mutex_init(&mutex, 0);
+		pthread_cond_init(&cond, 0);
+#endif
+	}
+
+	~CWorkSemaphore()
+	{
+#ifdef _WIN32
+		CloseHandle(handle);
+#else
+		pthread_cond_destroy(&cond);
+		pthread_mutex_destroy(&mutex);
+#endif
+	}
+
+	void Post(int count)
+	{
+#ifdef _WIN32
+		ReleaseSemaphore(handle, count, 0);
+#else
+		pthread_mutex_lock(&mutex);
+		value += count;
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+
+	void Wait()
+	{
+#ifdef _WIN32
+		WaitForSingleObject(handle, INFINITE);
+#else
+		pthread_mutex_lock(&mutex);
+		while( value == 0 )
+			pthread_cond_wait(&cond, &mutex);
+		value--;
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+
+protected:
+#ifdef _WIN32
+	HANDLE          handle;
+#else
+	pthread_mutex_t mutex;
+	pthread_cond_t  cond;
+	int             value;
+#endif
+};
+
+// The include tree is read and preprocessed by one set of loader threads. An
+// include is queued as soon as the file including it is preprocessed, so the
+// threads don't wait for each other between the levels of the tree.
+struct SLoaderQueue
+{
+	SLoaderQueue(CScriptBuilder *b, const set<string> &included, int count) : builder(b), seen(included), pending(0), threads(count), readTime(0) {}
+
+	// Only called while holding the lock, or before the threads are started
+	void Add(const string &name)
+	{
+		if( !seen.insert(name).second )
+			return;
+		queue.push_back(name);
+		pending++;
+		work.Post(1);
+	}
+
+	void Run()
+	{
+		for(;;)
+		{
+			work.Wait();
+
+			lock.Lock();
+			if( queue.empty() )
+			{
+				// The tree is done, every thread got a wake up to leave
+				lock.Unlock();
+				break;
+			}
+			string name = queue.front();
+			queue.pop_front();
+			// The map doesn't move its elements, the section is filled without holding the lock
+			CScriptBuilder::SPreprocessedSection &section = builder->prefetched[name];
+			lock.Unlock();
+
+			double time = 0;
+			section.result = builder->LoadAndPreprocessSection(name.c_str(), section, time);
+
+			lock.Lock();
+			readTime += time;
+			for( int n = 0; n < (int)section.includes.size(); n++ )
+				Add(builder->ResolveInclude(section.includes[n], name.c_str()));
+			if( --pending == 0 )
+				work.Post(threads);
+			lock.Unlock();
+		}
+	}
+
+	CScriptBuilder         *builder;
+	set<string>             seen;
+	deque<string>           queue;
+	int                     pending; // files that are queued or being loaded
+	int                     threads;
+	double                  readTime;
+	CScriptBuilder::CLock   lock;
+	CWorkSemaphore          work;
+};
+
+static void LoaderThread(void *param)
+{
+	((SLoaderQueue*)param)->Run();
+}
+
+int CScriptBuilder::LoadIncludeTree(const char *filename)
+{
+	SLoaderQueue loader(this, includedScripts, loaderThreads);
+	loader.Add(filename);
+
+	// The calling thread loads files as well, if a thread can't be
+	// started the remaining ones just do more of the work
+	vector<void*> threads;
+	for( int n = 1; n < loaderThreads; n++ )
+	{
+		void *thread = StartThread(LoaderThread, &loader);
+		if( thread )
+			threads.push_back(thread);
+	}
+	loader.Run();
+	for( int n = 0; n < (int)threads.size(); n++ )
+		JoinThread(threads[n]);
+	statistics.readTime += loader.readTime;
+
+	// Add the sections in the same depth first order as when loading them one by one,
+	// so the module and the sections hash don't depend on which thread was faster
+	int r = AddSectionFromFile(filename);
+	prefetched.clear();
+
+	return r;
+}
+
+void CScriptBuilder::PreprocessSection(const char *sectionname, const char *script, size_t length, SPreprocessedSection &out)
+{
+	out.sourceHash = HashBuffer(script, length, HASH_OFFSET_BASIS);
+
+	// The result only depends on the script code and the defined words
+	if( sectionCache && sectionCache->Find(sectionname, definedWordsHash, out.sourceHash, out) )
+	{
+		out.cached = true;
+		return;
+	}
+
+	CPreprocessor(engine, definedWords).Process(script, length, out);
+
+	if( sectionCache )
+		sectionCache->Store(sectionname, definedWordsHash, out);
+}
+
+int CScriptBuilder::ExpandSectionMacros()
+{
+	// A macro may only use its parameters and other macros
+	int r = 0;
+	for( map<string, SMacro>::iterator it = macros.begin(); it != macros.end(); it++ )
+	{
+		const SMacro &macro = it->second;
+		for( int n = 0; n < (int)macro.body.size(); n++ )
+		{
+			if( macro.body[n].param == -2 && macros.find(macro.body[n].text) == macros.end() )
+			{
+				string msg = "'" + macro.body[n].text + "' in macro '" + macro.name + "' is neither a parameter nor a macro";
+				engine->WriteMessage(macro.section.c_str(), macro.row, macro.col, asMSGTYPE_ERROR, msg.c_str());
+				r = -1;
+			}
+		}
+	}
+	if( r < 0 )
+		return r;
+
+	for( int n = 0; n < (int)sections.size(); n++ )
+	{
+		string code;
+		if( ExpandMacros(sections[n].code, code, sections[n].name.c_str(), 1, 1, 0) < 0 )
+			r = -1;
+		else
+			sections[n].code.swap(code);
+	}
+
+	return r;
+}
+
+// Expand the macro calls in the code. Errors within an expansion are
+// reported at the call it came from, which is given by row and col.
+int CScriptBuilder::ExpandMacros(const string &code, string &out, const char *section, int row, int col, int depth)
+{
+	out.clear();
+	out.reserve(code.size());
+
+	int r = 0;
+	int size = (int)code.size();
 	int pos = 0;
-	int nested = 0;
-	while( pos < (int)modifiedScript.size() )
+	int lineStart = 0;
+	bool member = false;
+	while( pos < size )
 	{
-		int len;
-		asETokenClass t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-		if( t == asTC_UNKNOWN && modifiedScript[pos] == '#' )
+		int len = 0;
+		asETokenClass t = engine->ParseToken(&code[pos], size - pos, &len);
+		if( len <= 0 )
+			len = 1;
+
+		// Is this a call of a macro? Members with the same name as a macro are left alone
+		map<string, SMacro>::const_iterator it = macros.end();
+		if( t == asTC_IDENTIFIER && !member )
+			it = macros.find(string(&code[pos], len));
+
+		vector<string> args;
+		int callEnd = 0;
+		if( it != macros.end() )
+			callEnd = GetMacroArguments(code, pos + len, args);
+
+		string msg;
+		if( callEnd != 0 )
 		{
-			int start = pos++;
+			const SMacro &macro = it->second;
+			if( args.size() == 1 && macro.params.empty() && args[0].find_first_not_of(" \t\r\n") == string::npos )
+				args.clear();
+
+			char count[16];
+			sprintf(count, "%d", (int)macro.params.size());
+			if( callEnd < 0 )
+				msg = "Expected ')' to end the call of macro '" + macro.name + "'";
+			else if( args.size() != macro.params.size() )
+				msg = "Macro '" + macro.name + "' expects " + count + " arguments";
+			else if( depth >= 16 )
+				msg = "Macro '" + macro.name + "' is nested too deep, does it use itself?";
+		}
 
-			// Is this an #if directive?
-			asETokenClass t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
+		if( depth == 0 )
+			col = pos - lineStart + 1;
 
-			string token;
-			token.assign(&modifiedScript[pos], len);
+		if( callEnd == 0 || msg.size() )
+		{
+			if( msg.size() )
+			{
+				engine->WriteMessage(section, row, col, asMSGTYPE_ERROR, msg.c_str());
+				if( callEnd < 0 )
+					return -1;
+				r = -1;
+			}
 
-			pos += len;
+			// Copy the token as it is
+			out.append(&code[pos], len);
+			if( t != asTC_WHITESPACE && t != asTC_COMMENT )
+				member = (len == 1 && code[pos] == '.');
+			callEnd = pos + len;
+		}
+		else
+		{
+			// Put the arguments in place of the parameters. Both are put in
+			// parentheses, so the precedence of the operators can't change
+			const SMacro &macro = it->second;
+			string text = "(";
+			for( int n = 0; n < (int)macro.body.size(); n++ )
+			{
+				if( macro.body[n].param >= 0 )
+					text += "(" + args[macro.body[n].param] + ")";
+				else
+					text += macro.body[n].text;
+				text += " ";
+			}
+			text += ")";
+
+			// The expansion may call other macros
+			string expanded;
+			if( ExpandMacros(text, expanded, section, row, col, depth + 1) < 0 )
+				r = -1;
+
+			// Keep the expansion on the line of the call, so all following code stays on its line
+			for( int n = 0; n < (int)expanded.size(); n++ )
+				out += (expanded[n] == '\n' || expanded[n] == '\r') ? ' ' : expanded[n];
+			for( int n = pos; n < callEnd; n++ )
+				if( code[n] == '\n' )
+					out += '\n';
+			member = false;
+		}
 
-			if( token == "if" )
+		if( depth == 0 )
+		{
+			for( int n = pos; n < callEnd; n++ )
 			{
-				t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-				if( t == asTC_WHITESPACE )
+				if( code[n] == '\n' )
 				{
-					pos += len;
-					t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
+					row++;
+					lineStart = n + 1;
 				}
+			}
+		}
+		pos = callEnd;
+	}
+
+	return r;
+}
+
+// Get the arguments of a macro call, pos is right after the name of the macro. Returns the
+// position after the closing parenthesis, 0 if it isn't a call or -1 if it isn't closed.
+int CScriptBuilder::GetMacroArguments(const string &code, int pos, vector<string> &args)
+{
+	int size = (int)code.size();
+	while( pos < size && (code[pos] == ' ' || code[pos] == '\t' || code[pos] == '\r' || code[pos] == '\n') )
+		pos++;
+	if( pos >= size || code[pos] != '(' )
+		return 0;
+
+	int level = 0;
+	int argStart = pos + 1;
+	while( pos < size )
+	{
+		int len = 0;
+		asETokenClass t = engine->ParseToken(&code[pos], size - pos, &len);
+		if( len <= 0 )
+			len = 1;
+
+		if( t == asTC_KEYWORD && len == 1 )
+		{
+			char c = code[pos];
+			if( c == '(' || c == '[' )
+				level++;
+			else if( (c == ')' || c == ']') && --level == 0 )
+			{
+				args.push_back(code.substr(argStart, pos - argStart));
+				return pos + 1;
+			}
+			else if( c == ',' && level == 1 )
+			{
+				args.push_back(code.substr(argStart, pos - argStart));
+				argStart = pos + 1;
+			}
+		}
+		pos += len;
+	}
+
+	return -1;
+}
+
+CScriptBuilder::CPreprocessor::CPreprocessor(asIScriptEngine *engine, const set<string> &words) : definedWords(words)
+{
+	this->engine = engine;
+	script = 0;
+	length = 0;
+}
+
+void CScriptBuilder::CPreprocessor::Process(const char *script, size_t length, SPreprocessedSection &out)
+{
+	double start = GetTimeMs();
+
+	// Split the script into tokens once, all preprocessing steps below work on this token list
+	this->script = script;
+	this->length = length;
+	Tokenize();
+	int numTokens = (int)tokens.size();
+	out.tokens = (asUINT)numTokens;
+
+	// First perform the checks for #if directives to exclude code that shouldn't be compiled
+	int n = 0;
+	int nested = 0;
+	while( n < numTokens )
+	{
+		if( tokens[n].type == asTC_UNKNOWN && TokenChar(n) == '#' && n + 1 < numTokens )
+		{
+			int start = n++;
+
+			// Is this an #if directive?
+			bool isIf    = TokenIs(n, "if");
+			bool isEndif = TokenIs(n, "endif");
+			n++;
+
+			if( isIf )
+			{
+				if( n < numTokens && tokens[n].type == asTC_WHITESPACE )
+					n++;
 
-				if( t == asTC_IDENTIFIER )
+				if( n < numTokens && tokens[n].type == asTC_IDENTIFIER )
 				{
 					string word;
-					word.assign(&modifiedScript[pos], len);
+					word.assign(&script[tokens[n].pos], tokens[n].len);
 
 					// Overwrite the #if directive with space characters to avoid compiler error
-					pos += len;
-					OverwriteCode(start, pos-start);
+					n++;
+					OverwriteTokens(start, n);
 
 					// Has this identifier been defined by the application or not?
 					if( definedWords.find(word) == definedWords.end() )
 					{
 						// Exclude all the code until and including the #endif
-						pos = ExcludeCode(pos);
+						n = ExcludeCode(n);
 					}
 					else
 					{
@@ -169,18 +797,18 @@ int CScriptBuilder::ProcessScriptSection(const char *script, const char *section
 					}
 				}
 			}
-			else if( token == "endif" )
+			else if( isEndif )
 			{
 				// Only remove the #endif if there was a matching #if
 				if( nested > 0 )
 				{
-					OverwriteCode(start, pos-start);
+					OverwriteTokens(start, n);
 					nested--;
 				}
-			}			
+			}
 		}
 		else
-			pos += len;
+			n++;
 	}
 
 #if AS_PROCESS_METADATA == 1
@@ -190,135 +818,119 @@ int CScriptBuilder::ProcessScriptSection(const char *script, const char *section
 	declaration.reserve(100);
 #endif
 
+	double metadataStart = GetTimeMs();
+	out.preprocessTime = metadataStart - start;
+
 	// Then check for meta data and #include directives
-	pos = 0;
-	while( pos < (int)modifiedScript.size() )
+	n = 0;
+	while( n < numTokens )
 	{
-		int len;
-		asETokenClass t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
+		asETokenClass t = tokens[n].type;
 		if( t == asTC_COMMENT || t == asTC_WHITESPACE )
 		{
-			pos += len;
+			n++;
 			continue;
 		}
 
 #if AS_PROCESS_METADATA == 1
 		// Is this the start of metadata?
-		if( modifiedScript[pos] == '[' )
+		if( TokenChar(n) == '[' )
 		{
 			// Get the metadata string
-			pos = ExtractMetadataString(pos, metadata);
+			n = ExtractMetadataString(n, metadata);
 
 			// Determine what this metadata is for
 			int type;
-			pos = ExtractDeclaration(pos, declaration, type);
+			n = ExtractDeclaration(n, declaration, type);
 			
 			// Store away the declaration in a map for lookup after the build has completed
 			if( type > 0 )
 			{
 				SMetadataDecl decl(metadata, declaration, type);
-				foundDeclarations.push_back(decl);
+				out.declarations.push_back(decl);
 			}
 		}
 		else 
 #endif
 		// Is this a preprocessor directive?
-		if( modifiedScript[pos] == '#' )
+		if( TokenChar(n) == '#' )
 		{
-			int start = pos++;
+			int start = n++;
 
-			asETokenClass t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-			if( t == asTC_IDENTIFIER )
+			if( n < numTokens && tokens[n].type == asTC_IDENTIFIER && TokenIs(n, "include") )
 			{
-				string token;
-				token.assign(&modifiedScript[pos], len);
-				if( token == "include" )
-				{
-					pos += len;
-					t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-					if( t == asTC_WHITESPACE )
-					{
-						pos += len;
-						t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-					}
+				n++;
+				if( n < numTokens && tokens[n].type == asTC_WHITESPACE )
+					n++;
 
-					if( t == asTC_VALUE && len > 2 && modifiedScript[pos] == '"' )
-					{
-						// Get the include file
-						string includefile;
-						includefile.assign(&modifiedScript[pos+1], len-2);
-						pos += len;
-
-						// Store it for later processing
-						includes.push_back(includefile);
+				if( n < numTokens && tokens[n].type == asTC_VALUE && tokens[n].len > 2 && script[tokens[n].pos] == '"' )
+				{
+					// Store the include file for later processing
+					out.includes.push_back(string(&script[tokens[n].pos+1], tokens[n].len-2));
+					n++;
 
-						// Overwrite the include directive with space characters to avoid compiler error
-						OverwriteCode(start, pos-start);
-					}
+					// Overwrite the include directive with space characters to avoid compiler error
+					OverwriteTokens(start, n);
 				}
 			}
+			else if( n < numTokens && tokens[n].type == asTC_IDENTIFIER && TokenIs(n, "define") )
+			{
+				n = ExtractMacro(start, n + 1, out);
+			}
 		}
 		// Don't search for metadata/includes within statement blocks or between tokens in statements
 		else 
-			pos = SkipStatement(pos);
+			n = SkipStatement(n);
 	}
 
-	// Build the actual script
-	engine->SetEngineProperty(asEP_COPY_SCRIPT_SECTIONS, true);
-	module->AddScriptSection(sectionname, modifiedScript.c_str(), modifiedScript.size());
+	// This is the only copy of the script that is made
+	WriteCode(out.code);
+	tokens.clear();
 
-	if( includes.size() > 0 )
-	{
-		// If the callback has been set, then call it for each included file
-		if( includeCallback )
-		{
-			for( int n = 0; n < (int)includes.size(); n++ )
-			{
-				int r = includeCallback(includes[n].c_str(), sectionname, this, callbackParam);
-				if( r < 0 )
-					return r;
-			}
-		}
-		else
-		{
-			// By default we try to load the included file from the relative directory of the current file
+	out.metadataTime = GetTimeMs() - metadataStart;
+}
 
-			// Determine the path of the current script so that we can resolve relative paths for includes
-			string path = sectionname;
-			size_t posOfSlash = path.find_last_of("/\\");
-			if( posOfSlash != string::npos )
-				path.resize(posOfSlash+1);
-			else
-				path = "";
+int CScriptBuilder::Build()
+{
+	// Build the actual script
+	// Expand the macro calls, the sections are then ready to be compiled
+	if( macros.size() > 0 )
+	{
+		double expandStart = GetTimeMs();
+		int r = ExpandSectionMacros();
+		statistics.preprocessTime += GetTimeMs() - expandStart;
+		if( r < 0 )
+			return r;
+	}
 
-			// Load the included scripts
-			for( int n = 0; n < (int)includes.size(); n++ )
-			{
-				// If the include is a relative path, then prepend the path of the originating script
-				if( includes[n].find_first_of("/\\") != 0 &&
-					includes[n].find_first_of(":") == string::npos )
-				{
-					includes[n] = path + includes[n];
-				}
+	double start = GetTimeMs();
 
-				// Include the script section
-				int r = AddSectionFromFile(includes[n].c_str());
-				if( r < 0 )
-					return r;
-			}
-		}
-	}
+	// The sections are kept until the builder is cleared, so the engine
+	// can use them without making yet another copy of the code
+	asPWORD copySections = engine->GetEngineProperty(asEP_COPY_SCRIPT_SECTIONS);
+	engine->SetEngineProperty(asEP_COPY_SCRIPT_SECTIONS, false);
+	for( int n = 0; n < (int)sections.size(); n++ )
+		module->AddScriptSection(sections[n].name.c_str(), sections[n].code.c_str(), sections[n].code.size());
 
-	return 0;
-}
+	double buildStart = GetTimeMs();
+	statistics.addSectionTime += buildStart - start;
 
-int CScriptBuilder::Build()
-{
 	int r = module->Build();
+	engine->SetEngineProperty(asEP_COPY_SCRIPT_SECTIONS, copySections);
+	statistics.buildTime += GetTimeMs() - buildStart;
 	if( r < 0 )
 		return r;
 
+	StoreMetadata();
+
+	return 0;
+}
+
+void CScriptBuilder::StoreMetadata()
+{
 #if AS_PROCESS_METADATA == 1
+	double start = GetTimeMs();
+
 	// After the script has been built, the metadata strings should be 
 	// stored for later lookup by function id, type id, and variable index
 	for( int n = 0; n < (int)foundDeclarations.size(); n++ )
@@ -328,196 +940,364 @@ int CScriptBuilder::Build()
 		{
 			// Find the type id
 			int typeId = module->GetTypeIdByDecl(decl->declaration.c_str());
-			if( typeId >= 0 )
-				typeMetadataMap.insert(map<int, string>::value_type(typeId, decl->metadata));
+			if( typeId >= 0 && typeMetadataMap.insert(map<int, string>::value_type(typeId, decl->metadata)).second )
+				IndexAttributes(1, typeId, decl->metadata);
 		}
 		else if( decl->type == 2 )
 		{
 			// Find the function id
 			int funcId = module->GetFunctionIdByDecl(decl->declaration.c_str());
-			if( funcId >= 0 )
-				funcMetadataMap.insert(map<int, string>::value_type(funcId, decl->metadata));
+			if( funcId >= 0 && funcMetadataMap.insert(map<int, string>::value_type(funcId, decl->metadata)).second )
+				IndexAttributes(2, funcId, decl->metadata);
 		}
 		else if( decl->type == 3 )
 		{
 			// Find the global variable index
 			int varIdx = module->GetGlobalVarIndexByDecl(decl->declaration.c_str());
-			if( varIdx >= 0 )
-				varMetadataMap.insert(map<int, string>::value_type(varIdx, decl->metadata));
+			if( varIdx >= 0 && varMetadataMap.insert(map<int, string>::value_type(varIdx, decl->metadata)).second )
+				IndexAttributes(3, varIdx, decl->metadata);
 		}
 	}
-#endif
 
-	return 0;
+	statistics.metadataTime += GetTimeMs() - start;
+#endif
 }
 
-int CScriptBuilder::SkipStatement(int pos)
+void CScriptBuilder::CPreprocessor::Tokenize()
 {
-	int len;
+	tokens.clear();
+	tokens.reserve(length / 4);
 
-	// Skip until ; or { whichever comes first
-	while( pos < (int)modifiedScript.length() && modifiedScript[pos] != ';' && modifiedScript[pos] != '{' )
+	int size = (int)length;
+	int pos = 0;
+	while( pos < size )
 	{
-		engine->ParseToken(&modifiedScript[pos], 0, &len);
+		int len = 0;
+		asETokenClass t = engine->ParseToken(&script[pos], size - pos, &len);
+		if( len <= 0 )
+			len = 1;
+
+		tokens.push_back(SToken(pos, len, t));
 		pos += len;
 	}
+}
+
+bool CScriptBuilder::CPreprocessor::TokenIs(int n, const char *text) const
+{
+	// An overwritten token only consists of blanks
+	if( tokens[n].overwritten )
+		return false;
+
+	size_t len = strlen(text);
+	return len == (size_t)tokens[n].len && memcmp(&script[tokens[n].pos], text, len) == 0;
+}
+
+// The first character of the token as it is in the output code
+char CScriptBuilder::CPreprocessor::TokenChar(int n) const
+{
+	char c = script[tokens[n].pos];
+	if( tokens[n].overwritten && c != '\n' )
+		return ' ';
+	return c;
+}
+
+// Append the token as it is in the output code
+void CScriptBuilder::CPreprocessor::AppendToken(int n, string &str) const
+{
+	const char *code = &script[tokens[n].pos];
+	if( !tokens[n].overwritten )
+	{
+		str.append(code, tokens[n].len);
+		return;
+	}
+
+	for( int i = 0; i < tokens[n].len; i++ )
+		str += code[i] == '\n' ? '\n' : ' ';
+}
+
+// Overwrite the tokens [first, last) with blanks, they are treated as white space afterwards
+void CScriptBuilder::CPreprocessor::OverwriteTokens(int first, int last)
+{
+	for( int n = first; n < last; n++ )
+	{
+		tokens[n].type = asTC_WHITESPACE;
+		tokens[n].overwritten = true;
+	}
+}
+
+// Copy the script to the output, overwriting all characters
+// of the overwritten tokens except line breaks with blanks
+void CScriptBuilder::CPreprocessor::WriteCode(string &code) const
+{
+	code.assign(script, length);
+
+	int numTokens = (int)tokens.size();
+	for( int n = 0; n < numTokens; n++ )
+	{
+		if( !tokens[n].overwritten )
+			continue;
+
+		char *c = &code[tokens[n].pos];
+		for( int i = 0; i < tokens[n].len; i++ )
+		{
+			if( c[i] != '\n' )
+				c[i] = ' ';
+		}
+	}
+}
+
+int CScriptBuilder::CPreprocessor::SkipStatement(int n)
+{
+	int numTokens = (int)tokens.size();
+
+	// Skip until ; or { whichever comes first
+	while( n < numTokens && TokenChar(n) != ';' && TokenChar(n) != '{' )
+		n++;
 
 	// Skip entire statement block
-	if( pos < (int)modifiedScript.length() && modifiedScript[pos] == '{' )
+	if( n < numTokens && TokenChar(n) == '{' )
 	{
-		pos += 1;
+		n += 1;
 
 		// Find the end of the statement block
 		int level = 1;
-		while( level > 0 && pos < (int)modifiedScript.size() )
+		while( level > 0 && n < numTokens )
 		{
-			asETokenClass t = engine->ParseToken(&modifiedScript[pos], 0, &len);
-			if( t == asTC_KEYWORD )
+			if( tokens[n].type == asTC_KEYWORD )
 			{
-				if( modifiedScript[pos] == '{' )
+				if( TokenChar(n) == '{' )
 					level++;
-				else if( modifiedScript[pos] == '}' )
+				else if( TokenChar(n) == '}' )
 					level--;
 			}
 
-			pos += len;
+			n++;
 		}
 	}
 	else
-		pos += 1;
+		n += 1;
 
-	return pos;
+	return n;
 }
 
 // Overwrite all code with blanks until the matching #endif
-int CScriptBuilder::ExcludeCode(int pos)
+int CScriptBuilder::CPreprocessor::ExcludeCode(int n)
 {
-	int len;
+	int numTokens = (int)tokens.size();
 	int nested = 0;
-	while( pos < (int)modifiedScript.size() )
+	while( n < numTokens )
 	{
-		asETokenClass t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-		if( modifiedScript[pos] == '#' )
+		if( TokenChar(n) == '#' )
 		{
-			modifiedScript[pos] = ' ';
-			pos++;
+			OverwriteTokens(n, n+1);
+			n++;
+			if( n >= numTokens )
+				break;
 
 			// Is it an #if or #endif directive?
-			t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-			string token;
-			token.assign(&modifiedScript[pos], len);
-			OverwriteCode(pos, len);
+			bool isIf    = TokenIs(n, "if");
+			bool isEndif = TokenIs(n, "endif");
+			OverwriteTokens(n, n+1);
 
-			if( token == "if" )
+			if( isIf )
 			{
 				nested++;
 			}
-			else if( token == "endif" )
+			else if( isEndif )
 			{
 				if( nested-- == 0 )
 				{
-					pos += len;
+					n++;
 					break;
 				}
 			}
 		}
-		else if( modifiedScript[pos] != '\n' )
+		else if( TokenChar(n) != '\n' )
 		{
-			OverwriteCode(pos, len);
+			OverwriteTokens(n, n+1);
 		}
-		pos += len;
+		n++;
 	}
 
-	return pos;
+	return n;
 }
 
-// Overwrite all characters except line breaks with blanks 
-void CScriptBuilder::OverwriteCode(int start, int len)
+// Extract the function like macro of a #define directive, n is the token after #define
+int CScriptBuilder::CPreprocessor::ExtractMacro(int start, int n, SPreprocessedSection &out)
 {
-	char *code = &modifiedScript[start];
-	for( int n = 0; n < len; n++ )
+	int numTokens = (int)tokens.size();
+
+	// The definition ends at the end of the line
+	int end = n;
+	for( ; end < numTokens; end++ )
+	{
+		asETokenClass t = tokens[end].type;
+		if( (t == asTC_WHITESPACE || t == asTC_COMMENT) && memchr(&script[tokens[end].pos], '\n', tokens[end].len) )
+			break;
+	}
+
+	SMacro macro;
+	macro.row = 1;
+	int lineStart = 0;
+	for( int i = 0; i < tokens[start].pos; i++ )
+	{
+		if( script[i] == '\n' )
+		{
+			macro.row++;
+			lineStart = i + 1;
+		}
+	}
+	macro.col = tokens[start].pos - lineStart + 1;
+
+	// The parameter list must follow the name directly
+	if( n < end && tokens[n].type == asTC_WHITESPACE )
+		n++;
+	if( n < end && tokens[n].type == asTC_IDENTIFIER )
+	{
+		macro.name.assign(&script[tokens[n].pos], tokens[n].len);
+		n++;
+	}
+
+	if( macro.name.empty() )
+		macro.error = "Expected a macro name after #define";
+	else if( n >= end || !TokenIs(n, "(") )
+		macro.error = "Macro '" + macro.name + "' has no parameter list, only function like macros are supported";
+	else
 	{
-		if( *code != '\n' )
-			*code = ' ';
-		code++;
+		for( n++; n < end && tokens[n].type == asTC_WHITESPACE; n++ ) {}
+		if( n < end && TokenIs(n, ")") )
+			n++;
+		else
+		{
+			while( macro.error.empty() )
+			{
+				for( ; n < end && tokens[n].type == asTC_WHITESPACE; n++ ) {}
+				string param;
+				if( n < end && tokens[n].type == asTC_IDENTIFIER )
+				{
+					param.assign(&script[tokens[n].pos], tokens[n].len);
+					n++;
+				}
+				if( param.empty() || find(macro.params.begin(), macro.params.end(), param) != macro.params.end() )
+				{
+					macro.error = "Expected a unique parameter name in macro '" + macro.name + "'";
+					break;
+				}
+				macro.params.push_back(param);
+
+				for( ; n < end && tokens[n].type == asTC_WHITESPACE; n++ ) {}
+				if( n < end && TokenIs(n, ")") )
+				{
+					n++;
+					break;
+				}
+				if( n >= end || !TokenIs(n, ",") )
+					macro.error = "Expected ',' or ')' in the parameter list of macro '" + macro.name + "'";
+				n++;
+			}
+		}
+
+		// The rest of the line is the expression. Names other than the parameters and
+		// their members must be macros, which is checked when all macros are known
+		bool member = false;
+		for( ; n < end && macro.error.empty(); n++ )
+		{
+			asETokenClass t = tokens[n].type;
+			if( t == asTC_WHITESPACE || t == asTC_COMMENT )
+				continue;
+
+			string text(&script[tokens[n].pos], tokens[n].len);
+			if( t == asTC_UNKNOWN || text == ";" || text == "{" || text == "}" )
+				macro.error = "Macro '" + macro.name + "' must be a single expression";
+
+			int param = -1;
+			if( t == asTC_IDENTIFIER && !member )
+			{
+				param = -2;
+				for( int i = 0; i < (int)macro.params.size(); i++ )
+					if( macro.params[i] == text )
+						param = i;
+			}
+			member = (text == ".");
+			macro.body.push_back(SMacroToken(text, param));
+		}
+
+		if( macro.error.empty() && macro.body.empty() )
+			macro.error = "Macro '" + macro.name + "' has no expression";
 	}
+
+	// Overwrite the directive with space characters to avoid compiler error
+	OverwriteTokens(start, end);
+	out.macros.push_back(macro);
+
+	return end;
 }
 
 #if AS_PROCESS_METADATA == 1
-int CScriptBuilder::ExtractMetadataString(int pos, string &metadata)
+int CScriptBuilder::CPreprocessor::ExtractMetadataString(int n, string &metadata)
 {
 	metadata = "";
 
 	// Overwrite the metadata with space characters to allow compilation
-	modifiedScript[pos] = ' ';
+	OverwriteTokens(n, n+1);
 
 	// Skip opening brackets
-	pos += 1;
+	n += 1;
 
+	int numTokens = (int)tokens.size();
 	int level = 1;
-	int len;
-	while( level > 0 && pos < (int)modifiedScript.size() )
+	while( level > 0 && n < numTokens )
 	{
-		asETokenClass t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
+		asETokenClass t = tokens[n].type;
 		if( t == asTC_KEYWORD )
 		{
-			if( modifiedScript[pos] == '[' )
+			if( TokenChar(n) == '[' )
 				level++;
-			else if( modifiedScript[pos] == ']' )
+			else if( TokenChar(n) == ']' )
 				level--;
 		}
 
 		// Copy the metadata to our buffer
 		if( level > 0 )
-			metadata.append(&modifiedScript[pos], len);
+			AppendToken(n, metadata);
 
 		// Overwrite the metadata with space characters to allow compilation
 		if( t != asTC_WHITESPACE )
-			OverwriteCode(pos, len);
+			OverwriteTokens(n, n+1);
 
-		pos += len;
+		n++;
 	}
 
-	return pos;
+	return n;
 }
 
-int CScriptBuilder::ExtractDeclaration(int pos, string &declaration, int &type)
+int CScriptBuilder::CPreprocessor::ExtractDeclaration(int n, string &declaration, int &type)
 {
 	declaration = "";
 	type = 0;
 
-	int start = pos;
-
-	std::string token;
-	int len = 0;
-	asETokenClass t = asTC_WHITESPACE;
+	int start = n;
+	int numTokens = (int)tokens.size();
 
 	// Skip white spaces and comments
-	do
-	{
-		pos += len;
-		t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-	} while ( t == asTC_WHITESPACE || t == asTC_COMMENT );
+	while( n < numTokens && (tokens[n].type == asTC_WHITESPACE || tokens[n].type == asTC_COMMENT) )
+		n++;
 
 	// We're expecting, either a class, interface, function, or variable declaration
-	if( t == asTC_KEYWORD || t == asTC_IDENTIFIER )
+	if( n < numTokens && (tokens[n].type == asTC_KEYWORD || tokens[n].type == asTC_IDENTIFIER) )
 	{
-		token.assign(&modifiedScript[pos], len);
-		if( token == "interface" || token == "class" )
+		if( TokenIs(n, "interface") || TokenIs(n, "class") )
 		{
 			// Skip white spaces and comments
-			do
-			{
-				pos += len;
-				t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-			} while ( t == asTC_WHITESPACE || t == asTC_COMMENT );
+			n++;
+			while( n < numTokens && (tokens[n].type == asTC_WHITESPACE || tokens[n].type == asTC_COMMENT) )
+				n++;
 
-			if( t == asTC_IDENTIFIER )
+			if( n < numTokens && tokens[n].type == asTC_IDENTIFIER )
 			{
 				type = 1;
-				declaration.assign(&modifiedScript[pos], len);
-				pos += len;
-				return pos;
+				declaration.assign(&script[tokens[n].pos], tokens[n].len);
+				return n + 1;
 			}
 		}
 		else
@@ -528,29 +1308,26 @@ int CScriptBuilder::ExtractDeclaration(int pos, string &declaration, int &type)
 
 			// We'll only know if the declaration is a variable or function declaration when we see the statement block, or absense of a statement block.
 			int varLength = 0;
-			declaration.append(&modifiedScript[pos], len);
-			pos += len;
-			for(; pos < (int)modifiedScript.size();)
+			AppendToken(n, declaration);
+			for( n++; n < numTokens; n++ )
 			{
-				t = engine->ParseToken(&modifiedScript[pos], modifiedScript.size() - pos, &len);
-				if( t == asTC_KEYWORD )
+				if( tokens[n].type == asTC_KEYWORD )
 				{
-					token.assign(&modifiedScript[pos], len);
-					if( token == "{" )
+					if( TokenIs(n, "{") )
 					{
 						// We've found the end of a function signature
 						type = 2;
-						return pos;
+						return n;
 					}
-					if( token == "=" || token == ";" )
+					if( TokenIs(n, "=") || TokenIs(n, ";") )
 					{
 						// We've found the end of a variable declaration.
 						if( varLength != 0 )
 							declaration.resize(varLength);
 						type = 3;
-						return pos;
+						return n;
 					}
-					else if( token == "(" && varLength == 0 )
+					else if( TokenIs(n, "(") && varLength == 0 )
 					{
 						// This is the first parenthesis we encounter. If the parenthesis isn't followed 
 						// by a statement block, then this is a variable declaration, in which case we 
@@ -559,8 +1336,7 @@ int CScriptBuilder::ExtractDeclaration(int pos, string &declaration, int &type)
 					}
 				}
 
-				declaration.append(&modifiedScript[pos], len);
-				pos += len;
+				AppendToken(n, declaration);
 			}
 		}
 	}
@@ -594,7 +1370,350 @@ const char *CScriptBuilder::GetMetadataStringForVar(int varIdx)
 
 	return "";
 }
+
+// Split the metadata into attributes and add them to the index
+void CScriptBuilder::IndexAttributes(int target, int id, const string &metadata)
+{
+	vector<SMetadataAttribute> *attributes;
+	if( target == 1 )
+		attributes = &typeAttributeMap[id];
+	else if( target == 2 )
+		attributes = &funcAttributeMap[id];
+	else
+		attributes = &varAttributeMap[id];
+
+	size_t pos = 0;
+	while( pos < metadata.size() )
+	{
+		// Find the end of the attribute, commas within brackets or strings don't count
+		size_t end = pos;
+		int level = 0;
+		char quote = 0;
+		for( ; end < metadata.size(); end++ )
+		{
+			char c = metadata[end];
+			if( quote )
+			{
+				if( c == quote )
+					quote = 0;
+			}
+			else if( c == '"' || c == '\'' )
+				quote = c;
+			else if( c == '(' || c == '[' || c == '{' )
+				level++;
+			else if( (c == ')' || c == ']' || c == '}') && level > 0 )
+				level--;
+			else if( c == ',' && level == 0 )
+				break;
+		}
+
+		// The first word is the name, the rest is the value
+		static const char *whiteSpace = " \t\r\n";
+		size_t nameStart = metadata.find_first_not_of(whiteSpace, pos);
+		if( nameStart != string::npos && nameStart < end )
+		{
+			size_t nameEnd = metadata.find_first_of(" \t\r\n(", nameStart);
+			if( nameEnd == string::npos || nameEnd > end )
+				nameEnd = end;
+
+			SMetadataAttribute attribute;
+			attribute.name.assign(metadata, nameStart, nameEnd - nameStart);
+
+			size_t valueStart = metadata.find_first_not_of(whiteSpace, nameEnd);
+			if( valueStart != string::npos && valueStart < end )
+			{
+				size_t valueEnd = metadata.find_last_not_of(whiteSpace, end - 1);
+				attribute.value.assign(metadata, valueStart, valueEnd + 1 - valueStart);
+			}
+			attributes->push_back(attribute);
+
+			SAttributedEntity entity;
+			entity.target = target;
+			entity.id     = id;
+			entity.value  = attribute.value;
+			attributeIndex[attribute.name].push_back(entity);
+		}
+
+		pos = end + 1;
+	}
+}
+
+static const vector<CScriptBuilder::SMetadataAttribute> &FindAttributes(const map<int, vector<CScriptBuilder::SMetadataAttribute> > &attributeMap, int id)
+{
+	static const vector<CScriptBuilder::SMetadataAttribute> none;
+
+	map<int, vector<CScriptBuilder::SMetadataAttribute> >::const_iterator it = attributeMap.find(id);
+	if( it != attributeMap.end() )
+		return it->second;
+
+	return none;
+}
+
+const vector<CScriptBuilder::SMetadataAttribute> &CScriptBuilder::GetAttributesForType(int typeId) const
+{
+	return FindAttributes(typeAttributeMap, typeId);
+}
+
+const vector<CScriptBuilder::SMetadataAttribute> &CScriptBuilder::GetAttributesForFunc(int funcId) const
+{
+	return FindAttributes(funcAttributeMap, funcId);
+}
+
+const vector<CScriptBuilder::SMetadataAttribute> &CScriptBuilder::GetAttributesForVar(int varIdx) const
+{
+	return FindAttributes(varAttributeMap, varIdx);
+}
+
+const vector<CScriptBuilder::SAttributedEntity> &CScriptBuilder::GetEntitiesWithAttribute(const char *name) const
+{
+	static const vector<SAttributedEntity> none;
+
+	map<string, vector<SAttributedEntity> >::const_iterator it = attributeIndex.find(name);
+	if( it != attributeIndex.end() )
+		return it->second;
+
+	return none;
+}
+#endif
+
+CScriptBuilder::CSectionCache::CSectionCache()
+{
+	hits   = 0;
+	misses = 0;
+	lock   = CreateLock();
+}
+
+CScriptBuilder::CSectionCache::~CSectionCache()
+{
+	DestroyLock(lock);
+}
+
+void CScriptBuilder::CSectionCache::Clear()
+{
+	Lock(lock);
+	sections.clear();
+	hits   = 0;
+	misses = 0;
+	Unlock(lock);
+}
+
+int CScriptBuilder::CSectionCache::GetSectionCount() const
+{
+	Lock(lock);
+	int count = (int)sections.size();
+	Unlock(lock);
+
+	return count;
+}
+
+void CScriptBuilder::CSectionCache::GetStatistics(asUINT &outHits, asUINT &outMisses) const
+{
+	Lock(lock);
+	outHits   = hits;
+	outMisses = misses;
+	Unlock(lock);
+}
+
+bool CScriptBuilder::CSectionCache::Find(const string &name, asQWORD definedWordsHash, asQWORD sourceHash, SPreprocessedSection &out)
+{
+	Lock(lock);
+	map<pair<string, asQWORD>, SPreprocessedSection>::iterator it = sections.find(make_pair(name, definedWordsHash));
+	bool found = it != sections.end() && it->second.sourceHash == sourceHash;
+	if( found )
+	{
+		out.result   = it->second.result;
+		out.tokens   = it->second.tokens;
+		out.code     = it->second.code;
+		out.includes = it->second.includes;
+		// the definitions are already removed from the cached code
+		out.macros   = it->second.macros;
+#if AS_PROCESS_METADATA == 1
+		out.declarations = it->second.declarations;
+#endif
+		hits++;
+	}
+	else
+		misses++;
+	Unlock(lock);
+
+	return found;
+}
+
+void CScriptBuilder::CSectionCache::Store(const string &name, asQWORD definedWordsHash, const SPreprocessedSection &section)
+{
+	// An edited file replaces its old version, so the cache does not grow with every reload
+	Lock(lock);
+	sections[make_pair(name, definedWordsHash)] = section;
+	Unlock(lock);
+}
+
+CScriptBuilder::CLock::CLock()
+{
+	handle = CreateLock();
+}
+
+CScriptBuilder::CLock::~CLock()
+{
+	DestroyLock(handle);
+}
+
+// The members hide the helper functions of the same name
+void CScriptBuilder::CLock::Lock()
+{
+#ifdef _WIN32
+	EnterCriticalSection((CRITICAL_SECTION*)handle);
+#else
+	pthread_mutex_lock((pthread_mutex_t*)handle);
+#endif
+}
+
+void CScriptBuilder::CLock::Unlock()
+{
+#ifdef _WIN32
+	LeaveCriticalSection((CRITICAL_SECTION*)handle);
+#else
+	pthread_mutex_unlock((pthread_mutex_t*)handle);
+#endif
+}
+
+struct SThreadStart
+{
+	void (*func)(void *);
+	void  *param;
+	bool   lowPriority;
+};
+
+#ifdef _WIN32
+static DWORD WINAPI ThreadMain(LPVOID param)
+#else
+static void *ThreadMain(void *param)
+#endif
+{
+	SThreadStart start = *(SThreadStart*)param;
+	delete (SThreadStart*)param;
+
+	if( start.lowPriority )
+	{
+#ifdef _WIN32
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(SCHED_IDLE)
+		struct sched_param sp;
+		sp.sched_priority = 0;
+		pthread_setschedparam(pthread_self(), SCHED_IDLE, &sp);
+#endif
+	}
+
+	start.func(start.param);
+	return 0;
+}
+
+void *CScriptBuilder::StartThread(void (*func)(void *), void *param, bool lowPriority)
+{
+	SThreadStart *start = new SThreadStart;
+	start->func        = func;
+	start->param       = param;
+	start->lowPriority = lowPriority;
+
+#ifdef _WIN32
+	HANDLE thread = CreateThread(0, 0, ThreadMain, start, 0, 0);
+	if( thread == 0 )
+	{
+		delete start;
+		return 0;
+	}
+	return thread;
+#else
+	pthread_t *thread = new pthread_t;
+	if( pthread_create(thread, 0, ThreadMain, start) != 0 )
+	{
+		delete thread;
+		delete start;
+		return 0;
+	}
+	return thread;
+#endif
+}
+
+void CScriptBuilder::JoinThread(void *thread)
+{
+	if( thread == 0 )
+		return;
+
+#ifdef _WIN32
+	WaitForSingleObject((HANDLE)thread, INFINITE);
+	CloseHandle((HANDLE)thread);
+#else
+	pthread_join(*(pthread_t*)thread, 0);
+	delete (pthread_t*)thread;
 #endif
+}
+
+static void *CreateLock()
+{
+#ifdef _WIN32
+	CRITICAL_SECTION *cs = new CRITICAL_SECTION;
+	InitializeCriticalSection(cs);
+	return cs;
+#else
+	pthread_mutex_t *mutex = new pthread_mutex_t;
+	pthread_mutex_init(mutex, 0);
+	return mutex;
+#endif
+}
+
+static void DestroyLock(void *lock)
+{
+#ifdef _WIN32
+	DeleteCriticalSection((CRITICAL_SECTION*)lock);
+	delete (CRITICAL_SECTION*)lock;
+#else
+	pthread_mutex_destroy((pthread_mutex_t*)lock);
+	delete (pthread_mutex_t*)lock;
+#endif
+}
+
+static void Lock(void *lock)
+{
+#ifdef _WIN32
+	EnterCriticalSection((CRITICAL_SECTION*)lock);
+#else
+	pthread_mutex_lock((pthread_mutex_t*)lock);
+#endif
+}
+
+static void Unlock(void *lock)
+{
+#ifdef _WIN32
+	LeaveCriticalSection((CRITICAL_SECTION*)lock);
+#else
+	pthread_mutex_unlock((pthread_mutex_t*)lock);
+#endif
+}
+
+static double GetTimeMs()
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+static asQWORD HashBuffer(const void *data, size_t size, asQWORD hash)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	for( size_t n = 0; n < size; n++ )
+	{
+		hash ^= p[n];
+		hash *= HASH_PRIME;
+	}
+	return hash;
+}
 
 static const char *GetCurrentDir(char *buf, size_t size)
 {
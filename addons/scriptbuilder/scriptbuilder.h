@@ -51,6 +51,14 @@ typedef int (*INCLUDECALLBACK_t)(const char *include, const char *from, CScriptB
 
 // Helper class for loading and pre-processing script files to 
 // support include directives and metadata declarations
+//
+// Scripts can define function like macros with #define name(a, b) expression,
+// the calls are expanded when the module is built. The expression must fit on
+// one line and may only use its parameters, members of them and other macros,
+// so it can't capture the variables at the place it is used. The parameters
+// and the expression are put in parentheses and the expansion stays on the
+// line of the call, so errors are reported on the correct line.
+// Note that, like in C, an argument is evaluated as often as it is used.
 class CScriptBuilder
 {
 public:
@@ -69,12 +77,88 @@ public:
 	// Build the added script sections
 	int BuildModule();
 
+	// Load the module from precompiled bytecode instead of building the added
+	// script sections. If the bytecode can't be loaded the sections are kept,
+	// so BuildModule can still be called afterwards.
+	int LoadModule(asIBinaryStream *in);
+
+	// Returns a hash of all preprocessed script sections added so far, it
+	// changes whenever the code that would be compiled changes
+	asQWORD GetSectionsHash() const;
+
 	// Register the callback for resolving include directive
 	void SetIncludeCallback(INCLUDECALLBACK_t callback, void *userParam);
 
 	// Add a pre-processor define for conditional compilation
 	void DefineWord(const char *word);
 
+	// Read and preprocess included files on this many threads. With more
+	// than one thread ReadScriptSection must be thread safe, the include
+	// callback is always called serially.
+	void SetLoaderThreads(int count);
+
+	// Use a cache of preprocessed sections. The cache can be shared by several
+	// builders, sections that were already preprocessed with the same defined
+	// words are then added without preprocessing them again.
+	class CSectionCache;
+	void SetSectionCache(CSectionCache *cache);
+
+	// Portable lock and thread helpers, the loader threads use them. They are
+	// public for applications that implement ReadScriptSection for several
+	// threads or build modules in the background.
+	class CLock
+	{
+	public:
+		CLock();
+		~CLock();
+		void Lock();
+		void Unlock();
+	protected:
+		void *handle;
+	private:
+		// Not copyable
+		CLock(const CLock &);
+		CLock &operator=(const CLock &);
+	};
+
+	// Runs func(param) on a new thread, returns 0 if the thread can't be started.
+	// A low priority thread only gets the time that other threads don't use.
+	static void *StartThread(void (*func)(void *param), void *param, bool lowPriority = false);
+
+	// Waits until the thread has finished and frees it
+	static void  JoinThread(void *thread);
+
+	// The sections the module is made of, with a hash of the code they were
+	// read from and the sections they include. The application can keep this
+	// after the build to find the modules that depend on a changed file.
+	struct SSectionDependency
+	{
+		std::string              name;
+		asQWORD                  sourceHash;
+		std::vector<std::string> includes;
+	};
+	const std::vector<SSectionDependency> &GetDependencies() const;
+
+	// What the phases of loading and building the module cost since
+	// StartNewModule. Times are in milliseconds, the read and preprocess
+	// times are summed up over all loader threads. Only the sections that
+	// weren't found in the section cache are tokenized.
+	struct SBuildStatistics
+	{
+		double readTime;
+		double preprocessTime;
+		double metadataTime;
+		double addSectionTime;
+		double buildTime;
+		double loadTime;
+		asUINT sections;
+		asUINT cachedSections;
+		asUINT bytes;
+		asUINT lines;
+		asUINT tokens;
+	};
+	const SBuildStatistics &GetStatistics() const;
+
 #if AS_PROCESS_METADATA == 1
 	// Get metadata declared for class types and interfaces
 	const char *GetMetadataStringForType(int typeId);
@@ -84,31 +168,51 @@ public:
 
 	// Get metadata declared for global variables
 	const char *GetMetadataStringForVar(int varIdx);
+
+	// The metadata is also parsed into attributes. Each comma separated part
+	// is an attribute, its first word is the name and the rest is the value,
+	// e.g. [event frameStep, hz 10] has the attributes event and hz.
+	struct SMetadataAttribute
+	{
+		std::string name;
+		std::string value;
+	};
+
+	// An entity that declared an attribute, the target is the same as
+	// for the declarations: 1 = type, 2 = function, 3 = global variable
+	struct SAttributedEntity
+	{
+		int         target;
+		int         id;
+		std::string value;
+	};
+
+	// Get the attributes declared for a type, function or global variable
+	const std::vector<SMetadataAttribute> &GetAttributesForType(int typeId) const;
+	const std::vector<SMetadataAttribute> &GetAttributesForFunc(int funcId) const;
+	const std::vector<SMetadataAttribute> &GetAttributesForVar(int varIdx) const;
+
+	// Get all entities that declared an attribute with the given name
+	const std::vector<SAttributedEntity> &GetEntitiesWithAttribute(const char *name) const;
 #endif
 
 protected:
 	void ClearAll();
 	int  Build();
+	void StoreMetadata();
 	int  ProcessScriptSection(const char *script, const char *sectionname);
-	virtual int  LoadScriptSection(const char *filename) = 0;
+	virtual int  LoadScriptSection(const char *filename);
+	virtual int  ReadScriptSection(const char *filename, std::string &code);
+
+	// Optionally map the file instead of reading it, the script is then preprocessed
+	// right from the mapped memory. The memory must stay valid until UnmapScriptSection
+	// is called with the returned handle. Returning a negative value falls back
+	// to ReadScriptSection. Both must be thread safe when using loader threads.
+	virtual int  MapScriptSection(const char *filename, const char *&data, size_t &length, void *&handle);
+	virtual void UnmapScriptSection(void *handle);
 	bool IncludeIfNotAlreadyIncluded(const char *filename);
 
-	int  SkipStatement(int pos);
-
-	int  ExcludeCode(int start);
-	void OverwriteCode(int start, int len);
-
-	asIScriptEngine           *engine;
-	asIScriptModule           *module;
-	std::string                modifiedScript;
-
-	INCLUDECALLBACK_t  includeCallback;
-	void              *callbackParam;
-
 #if AS_PROCESS_METADATA == 1
-	int  ExtractMetadataString(int pos, std::string &outMetadata);
-	int  ExtractDeclaration(int pos, std::string &outDeclaration, int &outType);
-
 	// Temporary structure for storing metadata and declaration
 	struct SMetadataDecl
 	{
@@ -117,17 +221,180 @@ protected:
 		std::string declaration;
 		int         type;
 	};
+#endif
+
+	// A function like macro defined with #define
+	struct SMacroToken
+	{
+		SMacroToken(const std::string &t, int p) : text(t), param(p) {}
+		std::string text;
+		int         param; // index of the parameter, -1 for other tokens and -2 for names of other macros
+	};
+	struct SMacro
+	{
+		SMacro() : row(0), col(0) {}
+		std::string              name;
+		std::vector<std::string> params;
+		std::vector<SMacroToken> body;
+		std::string              section;
+		int                      row;
+		int                      col;
+		std::string              error;
+	};
+
+	// The result of preprocessing a single section. It only depends on the
+	// section itself and the defined words, not on the other sections
+	struct SPreprocessedSection
+	{
+		SPreprocessedSection() : result(0), sourceHash(0), preprocessTime(0), metadataTime(0), tokens(0), cached(false) {}
+		int                        result;
+		asQWORD                    sourceHash;
+		double                     preprocessTime;
+		double                     metadataTime;
+		asUINT                     tokens;
+		bool                       cached;
+		std::string                code;
+		std::vector<std::string>   includes;
+		std::vector<SMacro>        macros;
+#if AS_PROCESS_METADATA == 1
+		std::vector<SMetadataDecl> declarations;
+#endif
+	};
+
+	int         AddPreprocessedSection(const char *sectionname, SPreprocessedSection &section);
+	std::string ResolveInclude(const std::string &include, const char *sectionname) const;
+	int         LoadIncludeTree(const char *filename);
+	int         LoadAndPreprocessSection(const char *filename, SPreprocessedSection &out, double &readTime);
+	void        PreprocessSection(const char *sectionname, const char *script, size_t length, SPreprocessedSection &out);
+	int         ExpandSectionMacros();
+	int         ExpandMacros(const std::string &code, std::string &out, const char *section, int row, int col, int depth);
+	int         GetMacroArguments(const std::string &code, int pos, std::vector<std::string> &args);
+
+	// Preprocesses one section. All state is kept in the preprocessor,
+	// so different sections can be preprocessed on different threads
+	class CPreprocessor
+	{
+	public:
+		CPreprocessor(asIScriptEngine *engine, const std::set<std::string> &definedWords);
+
+		void Process(const char *script, size_t length, SPreprocessedSection &out);
+
+	protected:
+		// The script is split into tokens once, the preprocessing steps work on
+		// token indices. The script itself is never modified, overwritten tokens
+		// are only flagged and blanked when the output code is written.
+		struct SToken
+		{
+			SToken(int p, int l, asETokenClass t) : pos(p), len(l), type(t), overwritten(false) {}
+			int           pos;
+			int           len;
+			asETokenClass type;
+			bool          overwritten;
+		};
+		void Tokenize();
+		bool TokenIs(int n, const char *text) const;
+		char TokenChar(int n) const;
+		void AppendToken(int n, std::string &str) const;
+		void OverwriteTokens(int first, int last);
+		void WriteCode(std::string &code) const;
+
+		int  SkipStatement(int n);
+
+		int  ExcludeCode(int n);
+		int  ExtractMacro(int start, int n, SPreprocessedSection &out);
+
+#if AS_PROCESS_METADATA == 1
+		int  ExtractMetadataString(int n, std::string &outMetadata);
+		int  ExtractDeclaration(int n, std::string &outDeclaration, int &outType);
+#endif
+
+		asIScriptEngine             *engine;
+		const std::set<std::string> &definedWords;
+		const char                  *script;
+		size_t                       length;
+		std::vector<SToken>          tokens;
+	};
+	friend struct SLoaderQueue;
+
+	asIScriptEngine           *engine;
+	asIScriptModule           *module;
+	std::string                moduleName;
+
+	// The preprocessed sections, they are only added to the module when it is built
+	struct SScriptSection
+	{
+		SScriptSection(const std::string &n, const std::string &c) : name(n), code(c) {}
+		std::string name;
+		std::string code;
+	};
+	std::vector<SScriptSection> sections;
+	asQWORD                     sectionsHash;
+
+	std::vector<SSectionDependency> dependencies;
+	SBuildStatistics                statistics;
+	std::map<std::string, SMacro>   macros;
+
+	INCLUDECALLBACK_t  includeCallback;
+	void              *callbackParam;
 
+	// Sections of the include tree that were read ahead, see LoadIncludeTree
+	int                                         loaderThreads;
+	std::map<std::string, SPreprocessedSection> prefetched;
+
+	CSectionCache     *sectionCache;
+
+#if AS_PROCESS_METADATA == 1
 	std::vector<SMetadataDecl> foundDeclarations;
 
 	std::map<int, std::string> typeMetadataMap;
 	std::map<int, std::string> funcMetadataMap;
 	std::map<int, std::string> varMetadataMap;
+
+	void IndexAttributes(int target, int id, const std::string &metadata);
+
+	std::map<int, std::vector<SMetadataAttribute> >         typeAttributeMap;
+	std::map<int, std::vector<SMetadataAttribute> >         funcAttributeMap;
+	std::map<int, std::vector<SMetadataAttribute> >         varAttributeMap;
+	std::map<std::string, std::vector<SAttributedEntity> >  attributeIndex;
 #endif
 
 	std::set<std::string>      includedScripts;
 
 	std::set<std::string>      definedWords;
+	asQWORD                    definedWordsHash;
+};
+
+// Preprocessed sections keyed by the section name and the defined words. Only
+// the latest version of each section is kept, a section is found again as long
+// as its code has not changed. It is thread safe, so the loader threads of the
+// builders can use it.
+class CScriptBuilder::CSectionCache
+{
+public:
+	CSectionCache();
+	~CSectionCache();
+
+	// Remove all cached sections
+	void Clear();
+
+	// Number of cached sections and how many lookups found a section or not
+	int  GetSectionCount() const;
+	void GetStatistics(asUINT &hits, asUINT &misses) const;
+
+protected:
+	friend class CScriptBuilder;
+	bool Find(const std::string &name, asQWORD definedWordsHash, asQWORD sourceHash, SPreprocessedSection &out);
+	void Store(const std::string &name, asQWORD definedWordsHash, const SPreprocessedSection &section);
+
+	std::map<std::pair<std::string, asQWORD>, SPreprocessedSection> sections;
+	asUINT                                                          hits;
+	asUINT                                                          misses;
+	void                                                           *lock;
+
+private:
+	// Not copyable
+	CSectionCache(const CSectionCache &);
+	CSectionCache &operator=(const CSectionCache &);
 };
 
 END_AS_NAMESPACE
@@ -3,6 +3,10 @@
 #include <string>
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
 using namespace std;
 
@@ -162,40 +166,41 @@ int ExecuteString(asIScriptEngine *engine, const char *code, asIScriptModule *mo
 
 int WriteConfigToFile(asIScriptEngine *engine, const char *filename)
 {
-	int c, n;
-
-	FILE *f = 0;
-#if _MSC_VER >= 1400 // MSVC 8.0 / 2005
-	fopen_s(&f, filename, "wt");
-#else
-	f = fopen(filename, "wt");
-#endif
-	if( f == 0 )
+	ofstream strm;
+	strm.open(filename);
+	if( !strm.is_open() )
 		return -1;
 
+	return WriteConfigToStream(engine, strm);
+}
+
+int WriteConfigToStream(asIScriptEngine *engine, ostream &strm)
+{
+	int c, n;
+
 	// Make sure the default array type is expanded to the template form 
 	bool expandDefArrayToTempl = engine->GetEngineProperty(asEP_EXPAND_DEF_ARRAY_TO_TMPL) ? true : false;
 	engine->SetEngineProperty(asEP_EXPAND_DEF_ARRAY_TO_TMPL, true);
 
 	// Write enum types and their values
-	fprintf(f, "// Enums\n");
+	strm << "// Enums\n";
 	c = engine->GetEnumCount();
 	for( n = 0; n < c; n++ )
 	{
 		int typeId;
 		const char *enumName = engine->GetEnumByIndex(n, &typeId);
-		fprintf(f, "enum %s\n", enumName);
+		strm << "enum " << enumName << "\n";
 		for( int m = 0; m < engine->GetEnumValueCount(typeId); m++ )
 		{
 			const char *valName;
 			int val;
 			valName = engine->GetEnumValueByIndex(typeId, m, &val);
-			fprintf(f, "enumval %s %s %d\n", enumName, valName, val);
+			strm << "enumval " << enumName << " " << valName << " " << val << "\n";
 		}
 	}
 
 	// Enumerate all types
-	fprintf(f, "\n// Types\n");
+	strm << "\n// Types\n";
 
 	c = engine->GetObjectTypeCount();
 	for( n = 0; n < c; n++ )
@@ -206,14 +211,18 @@ int WriteConfigToFile(asIScriptEngine *engine, const char *filename)
 			// This should only be interfaces
 			assert( type->GetSize() == 0 );
 
-			fprintf(f, "intf %s\n", type->GetName());
+			strm << "intf " << type->GetName() << "\n";
 		}
 		else
 		{
 			// Only the type flags are necessary. The application flags are application 
 			// specific and doesn't matter to the offline compiler. The object size is also
 			// unnecessary for the offline compiler
-			fprintf(f, "objtype \"%s\" %u\n", engine->GetTypeDeclaration(type->GetTypeId()), (unsigned int)(type->GetFlags() & 0xFF));
+			strm << "objtype \"" << engine->GetTypeDeclaration(type->GetTypeId()) << "\" " << (unsigned int)(type->GetFlags() & 0xFF);
+			// The size of value types decides the stack layout of the compiled bytecode
+			if( type->GetFlags() & asOBJ_VALUE )
+				strm << " " << type->GetSize();
+			strm << "\n";
 		}
 	}
 
@@ -222,18 +231,18 @@ int WriteConfigToFile(asIScriptEngine *engine, const char *filename)
 	{
 		int typeId;
 		const char *typeDef = engine->GetTypedefByIndex(n, &typeId);
-		fprintf(f, "typedef %s \"%s\"\n", typeDef, engine->GetTypeDeclaration(typeId));
+		strm << "typedef " << typeDef << " \"" << engine->GetTypeDeclaration(typeId) << "\"\n";
 	}
 
 	c = engine->GetFuncdefCount();
 	for( n = 0; n < c; n++ )
 	{
 		asIScriptFunction *funcDef = engine->GetFuncdefByIndex(n);
-		fprintf(f, "funcdef \"%s\"\n", funcDef->GetDeclaration());
+		strm << "funcdef \"" << funcDef->GetDeclaration() << "\"\n";
 	}
 
 	// Write the object types members
-	fprintf(f, "\n// Type members\n");
+	strm << "\n// Type members\n";
 	
 	c = engine->GetObjectTypeCount();
 	for( n = 0; n < c; n++ )
@@ -245,7 +254,7 @@ int WriteConfigToFile(asIScriptEngine *engine, const char *filename)
 			for( int m = 0; m < type->GetMethodCount(); m++ )
 			{
 				asIScriptFunction *func = type->GetMethodDescriptorByIndex(m);
-				fprintf(f, "intfmthd %s \"%s\"\n", typeDecl.c_str(), func->GetDeclaration(false));
+				strm << "intfmthd " << typeDecl << " \"" << func->GetDeclaration(false) << "\"\n";
 			}
 		}
 		else
@@ -254,38 +263,38 @@ int WriteConfigToFile(asIScriptEngine *engine, const char *filename)
 			for( m = 0; m < type->GetFactoryCount(); m++ )
 			{
 				asIScriptFunction *func = engine->GetFunctionDescriptorById(type->GetFactoryIdByIndex(m));
-				fprintf(f, "objbeh \"%s\" %d \"%s\"\n", typeDecl.c_str(), asBEHAVE_FACTORY, func->GetDeclaration(false));
+				strm << "objbeh \"" << typeDecl << "\" " << asBEHAVE_FACTORY << " \"" << func->GetDeclaration(false) << "\"\n";
 			}
 			for( m = 0; m < type->GetBehaviourCount(); m++ )
 			{
 				asEBehaviours beh;
 				asIScriptFunction *func = engine->GetFunctionDescriptorById(type->GetBehaviourByIndex(m, &beh));
-				fprintf(f, "objbeh \"%s\" %d \"%s\"\n", typeDecl.c_str(), beh, func->GetDeclaration(false));
+				strm << "objbeh \"" << typeDecl << "\" " << beh << " \"" << func->GetDeclaration(false) << "\"\n";
 			}
 			for( m = 0; m < type->GetMethodCount(); m++ )
 			{
 				asIScriptFunction *func = type->GetMethodDescriptorByIndex(m);
-				fprintf(f, "objmthd \"%s\" \"%s\"\n", typeDecl.c_str(), func->GetDeclaration(false));
+				strm << "objmthd \"" << typeDecl << "\" \"" << func->GetDeclaration(false) << "\"\n";
 			}
 			for( m = 0; m < type->GetPropertyCount(); m++ )
 			{
-				fprintf(f, "objprop \"%s\" \"%s\"\n", typeDecl.c_str(), type->GetPropertyDeclaration(m));
+				strm << "objprop \"" << typeDecl << "\" \"" << type->GetPropertyDeclaration(m) << "\" " << type->GetPropertyOffset(m) << "\n";
 			}
 		}
 	}
 
 	// Write functions
-	fprintf(f, "\n// Functions\n");
+	strm << "\n// Functions\n";
 
 	c = engine->GetGlobalFunctionCount();
 	for( n = 0; n < c; n++ )
 	{
 		asIScriptFunction *func = engine->GetFunctionDescriptorById(engine->GetGlobalFunctionIdByIndex(n));
-		fprintf(f, "func \"%s\"\n", func->GetDeclaration());
+		strm << "func \"" << func->GetDeclaration() << "\"\n";
 	}
 
 	// Write global properties
-	fprintf(f, "\n// Properties\n");
+	strm << "\n// Properties\n";
 
 	c = engine->GetGlobalPropertyCount();
 	for( n = 0; n < c; n++ )
@@ -294,22 +303,20 @@ int WriteConfigToFile(asIScriptEngine *engine, const char *filename)
 		int typeId;
 		bool isConst;
 		engine->GetGlobalPropertyByIndex(n, &name, &typeId, &isConst); 
-		fprintf(f, "prop \"%s%s %s\"\n", isConst ? "const " : "", engine->GetTypeDeclaration(typeId), name);
+		strm << "prop \"" << (isConst ? "const " : "") << engine->GetTypeDeclaration(typeId) << " " << name << "\"\n";
 	}
 
 	// Write string factory
-	fprintf(f, "\n// String factory\n");
+	strm << "\n// String factory\n";
 	int typeId = engine->GetStringFactoryReturnTypeId();
 	if( typeId > 0 )
-		fprintf(f, "strfactory \"%s\"\n", engine->GetTypeDeclaration(typeId));
+		strm << "strfactory \"" << engine->GetTypeDeclaration(typeId) << "\"\n";
 
 	// Write default array type
-	fprintf(f, "\n// Default array type\n");
+	strm << "\n// Default array type\n";
 	typeId = engine->GetDefaultArrayTypeId();
 	if( typeId > 0 )
-		fprintf(f, "defarray \"%s\"\n", engine->GetTypeDeclaration(typeId));
-
-	fclose(f);
+		strm << "defarray \"" << engine->GetTypeDeclaration(typeId) << "\"\n";
 
 	// Restore original settings
 	engine->SetEngineProperty(asEP_EXPAND_DEF_ARRAY_TO_TMPL, expandDefArrayToTempl);
@@ -317,6 +324,128 @@ int WriteConfigToFile(asIScriptEngine *engine, const char *filename)
 	return 0;
 }
 
+// Splits a line of the configuration into words, quoted strings are one word
+static void SplitConfigLine(const string &line, vector<string> &words)
+{
+	words.clear();
+	size_t pos = 0;
+	while( pos < line.size() )
+	{
+		if( line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r' )
+		{
+			pos++;
+			continue;
+		}
+
+		if( line[pos] == '"' )
+		{
+			size_t end = line.find('"', pos + 1);
+			if( end == string::npos ) end = line.size();
+			words.push_back(line.substr(pos + 1, end - pos - 1));
+			pos = end + 1;
+		}
+		else
+		{
+			size_t end = line.find_first_of(" \t\r", pos);
+			if( end == string::npos ) end = line.size();
+			words.push_back(line.substr(pos, end - pos));
+			pos = end;
+		}
+	}
+}
+
+int ConfigEngineFromStream(asIScriptEngine *engine, istream &strm, const char *configFile)
+{
+	vector<string> words;
+	string line;
+	int lineNum = 0;
+	int r = 0;
+	while( getline(strm, line) )
+	{
+		lineNum++;
+		SplitConfigLine(line, words);
+		if( words.empty() || words[0].compare(0, 2, "//") == 0 )
+			continue;
+
+		const string &token = words[0];
+		if( token == "enum" && words.size() >= 2 )
+			r = engine->RegisterEnum(words[1].c_str());
+		else if( token == "enumval" && words.size() >= 4 )
+			r = engine->RegisterEnumValue(words[1].c_str(), words[2].c_str(), atoi(words[3].c_str()));
+		else if( token == "intf" && words.size() >= 2 )
+			r = engine->RegisterInterface(words[1].c_str());
+		else if( token == "objtype" && words.size() >= 3 )
+		{
+			string decl = words[1];
+			asDWORD flags = (asDWORD)strtoul(words[2].c_str(), 0, 10);
+			int size = words.size() >= 4 ? atoi(words[3].c_str()) : 0;
+			if( (flags & asOBJ_VALUE) && size <= 0 )
+				size = 1;
+
+			// Template types are declared with their subtype, e.g. array<class T>
+			if( flags & asOBJ_TEMPLATE )
+			{
+				size_t start = decl.find('<');
+				if( start != string::npos )
+					decl.insert(start + 1, "class ");
+			}
+			r = engine->RegisterObjectType(decl.c_str(), size, flags);
+		}
+		else if( token == "typedef" && words.size() >= 3 )
+			r = engine->RegisterTypedef(words[1].c_str(), words[2].c_str());
+		else if( token == "funcdef" && words.size() >= 2 )
+			r = engine->RegisterFuncdef(words[1].c_str());
+		else if( token == "intfmthd" && words.size() >= 3 )
+			r = engine->RegisterInterfaceMethod(words[1].c_str(), words[2].c_str());
+		else if( token == "objbeh" && words.size() >= 4 )
+			r = engine->RegisterObjectBehaviour(words[1].c_str(), (asEBehaviours)atoi(words[2].c_str()), words[3].c_str(), asFUNCTION(0), asCALL_GENERIC);
+		else if( token == "objmthd" && words.size() >= 3 )
+			r = engine->RegisterObjectMethod(words[1].c_str(), words[2].c_str(), asFUNCTION(0), asCALL_GENERIC);
+		else if( token == "objprop" && words.size() >= 3 )
+			r = engine->RegisterObjectProperty(words[1].c_str(), words[2].c_str(), words.size() >= 4 ? atoi(words[3].c_str()) : 0);
+		else if( token == "func" && words.size() >= 2 )
+			r = engine->RegisterGlobalFunction(words[1].c_str(), asFUNCTION(0), asCALL_GENERIC);
+		else if( token == "prop" && words.size() >= 2 )
+			// The compiler may read the value of constants, so the property needs real memory.
+			// It is never freed, the engine configuration keeps pointing to it.
+			r = engine->RegisterGlobalProperty(words[1].c_str(), new asQWORD[4]());
+		else if( token == "strfactory" && words.size() >= 2 )
+			r = engine->RegisterStringFactory(words[1].c_str(), asFUNCTION(0), asCALL_GENERIC);
+		else if( token == "defarray" && words.size() >= 2 )
+			r = engine->RegisterDefaultArrayType(words[1].c_str());
+		else
+		{
+			engine->WriteMessage(configFile, lineNum, 0, asMSGTYPE_ERROR, ("Unknown or incomplete configuration entry '" + token + "'").c_str());
+			return -1;
+		}
+
+		if( r < 0 )
+		{
+			engine->WriteMessage(configFile, lineNum, 0, asMSGTYPE_ERROR, ("Failed to register '" + line + "'").c_str());
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+asQWORD GetConfigFingerprint(asIScriptEngine *engine)
+{
+	stringstream strm;
+	if( WriteConfigToStream(engine, strm) < 0 )
+		return 0;
+
+	// FNV-1a 64 bit over the textual configuration
+	string config = strm.str();
+	asQWORD hash = 14695981039346656037ULL;
+	for( size_t n = 0; n < config.size(); n++ )
+	{
+		hash ^= (unsigned char)config[n];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
 void PrintException(asIScriptContext *ctx, bool printStack)
 {
 	if( ctx->GetState() != asEXECUTION_EXCEPTION ) return;
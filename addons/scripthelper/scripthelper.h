@@ -2,6 +2,8 @@
 #define SCRIPTHELPER_H
 
 #include <angelscript.h>
+#include <ostream>
+#include <istream>
 
 BEGIN_AS_NAMESPACE
 
@@ -17,8 +19,19 @@ int CompareEquality(asIScriptEngine *engine, void *lobj, void *robj, int typeId,
 int ExecuteString(asIScriptEngine *engine, const char *code, asIScriptModule *mod = 0, asIScriptContext *ctx = 0);
 
 // Write the registered application interface to a file for an offline compiler.
-// The format is compatible with the offline compiler in /sdk/samples/asbuild/.
+// The format is compatible with the offline compiler in /sdk/samples/asbuild/,
+// in addition it holds the size of value types and the offsets of object properties.
 int WriteConfigToFile(asIScriptEngine *engine, const char *filename);
+int WriteConfigToStream(asIScriptEngine *engine, std::ostream &strm);
+
+// Register the application interface written by WriteConfigToStream. All
+// functions are registered without implementation, so the engine can only be
+// used to compile scripts and save their bytecode.
+int ConfigEngineFromStream(asIScriptEngine *engine, std::istream &strm, const char *configFile = "config");
+
+// Returns a hash of the registered application interface. Bytecode saved with
+// one configuration can only be loaded by an engine with the same fingerprint.
+asQWORD GetConfigFingerprint(asIScriptEngine *engine);
 
 // Print details of the script exception to the standard output
 void PrintException(asIScriptContext *ctx, bool printStack = false);
@@ -0,0 +1,487 @@
+#include <assert.h>
+#include <math.h>
+#include <string.h> // strstr, memcpy
+#include "scriptmatharray.h"
+#include "../scriptarray/scriptarray.h"
+
+// The kernels process four elements at once if SSE2 is available
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AS_MATHARRAY_SSE2
+#include <emmintrin.h>
+#endif
+
+BEGIN_AS_NAMESPACE
+
+static void SetException(const char *message)
+{
+	asIScriptContext *ctx = asGetActiveContext();
+	if( ctx )
+		ctx->SetException(message);
+}
+
+// The native functions receive the array handles from the script and must release
+// them, with the generic calling convention the engine releases them itself
+static void ReleaseArrays(CScriptArray *a, CScriptArray *b, CScriptArray *c = 0)
+{
+	if( a ) a->Release();
+	if( b ) b->Release();
+	if( c ) c->Release();
+}
+
+// Gives the output the size of the input, returns the
+// number of elements to process, 0 if there is nothing to do
+static asUINT PrepareOutput(CScriptArray *in, CScriptArray *out)
+{
+	if( in == 0 || out == 0 )
+	{
+		SetException("Null pointer access");
+		return 0;
+	}
+
+	asUINT size = in->GetSize();
+	if( out != in )
+	{
+		// the array sets an exception itself if it can't be resized
+		out->Resize(size);
+		if( out->GetSize() != size )
+			return 0;
+	}
+	return size;
+}
+
+// Same for functions with two input arrays, they must have the same size
+static asUINT PrepareOutput(CScriptArray *a, CScriptArray *b, CScriptArray *out)
+{
+	if( a == 0 || b == 0 )
+	{
+		SetException("Null pointer access");
+		return 0;
+	}
+	if( a->GetSize() != b->GetSize() )
+	{
+		SetException("Array sizes differ");
+		return 0;
+	}
+	return PrepareOutput(a, out);
+}
+
+#ifdef AS_MATHARRAY_SSE2
+static inline __m128 SseAbs(__m128 x)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+
+static inline __m128 SseSelect(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Truncating only works below 2^23, larger floats are integers already.
+// Or'ing in the sign of x keeps the sign of a zero result like floorf and ceilf do.
+static inline __m128 SseRound(__m128 x, __m128 t)
+{
+	t = _mm_or_ps(t, _mm_and_ps(x, _mm_set1_ps(-0.0f)));
+	return SseSelect(_mm_cmpnlt_ps(SseAbs(x), _mm_set1_ps(8388608.0f)), x, t);
+}
+
+static inline __m128 SseFloor(__m128 x)
+{
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	return SseRound(x, _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f))));
+}
+
+static inline __m128 SseCeil(__m128 x)
+{
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	return SseRound(x, _mm_add_ps(t, _mm_and_ps(_mm_cmplt_ps(t, x), _mm_set1_ps(1.0f))));
+}
+
+// Polynomials on [-pi/4, pi/4] from the Cephes library
+static inline __m128 SseSinCos(__m128 x, bool cosine)
+{
+	// x = j * pi/2 + r, pi/2 is split in three parts so that j * part is exact for |j| < 8192
+	__m128i j = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772f)));
+	__m128 fj = _mm_cvtepi32_ps(j);
+	__m128 r  = _mm_sub_ps(x, _mm_mul_ps(fj, _mm_set1_ps(1.5703125f)));
+	r = _mm_sub_ps(r, _mm_mul_ps(fj, _mm_set1_ps(4.837512969970703125e-4f)));
+	r = _mm_sub_ps(r, _mm_mul_ps(fj, _mm_set1_ps(7.54978995489188216e-8f)));
+
+	// cos(x) = sin(x + pi/2) is one quadrant further
+	if( cosine )
+		j = _mm_add_epi32(j, _mm_set1_epi32(1));
+
+	__m128 z = _mm_mul_ps(r, r);
+	__m128 s = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(-1.9515295891e-4f)), _mm_set1_ps(8.3321608736e-3f));
+	s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(-1.6666654611e-1f));
+	s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), r), r);
+	__m128 c = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(2.443315711809948e-5f)), _mm_set1_ps(-1.388731625493765e-3f));
+	c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(4.166664568298827e-2f));
+	c = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(c, z), z), _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+	// odd quadrants use the cosine polynomial, the upper two are negative
+	__m128 useCos = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+	__m128 sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), 30));
+	return _mm_xor_ps(SseSelect(useCos, c, s), sign);
+}
+
+static inline __m128 SseExp(__m128 x)
+{
+	// keep 2^n a normal float, NaN passes through the clamping
+	x = _mm_min_ps(_mm_set1_ps(88.3762626647949f), _mm_max_ps(_mm_set1_ps(-87.3365447505531f), x));
+
+	// x = n * ln(2) + r with ln(2) split in two parts
+	__m128 n = SseFloor(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f)));
+	__m128 r = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+	r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+	__m128 p = _mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(1.9875691500e-4f)), _mm_set1_ps(1.3981999507e-3f));
+	p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+	p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+	p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+	p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+	p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p, _mm_mul_ps(r, r)), r), _mm_set1_ps(1.0f));
+
+	// build 2^n from its exponent bits
+	__m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23);
+	return _mm_mul_ps(p, _mm_castsi128_ps(e));
+}
+
+static inline __m128 SseLog(__m128 x)
+{
+	__m128 invalid  = _mm_or_ps(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_cmpunord_ps(x, x));
+	__m128 zero     = _mm_cmpeq_ps(x, _mm_setzero_ps());
+	__m128 infinity = _mm_cmpeq_ps(x, _mm_set1_ps(HUGE_VALF));
+
+	// x = m * 2^e with m in [0.5, 1), denormals are raised to the smallest normal float
+	__m128i bits = _mm_castps_si128(_mm_max_ps(x, _mm_set1_ps(1.17549435e-38f)));
+	__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000)));
+
+	// move m to [sqrt(0.5), sqrt(2)) and subtract 1 for the polynomial
+	__m128 small = _mm_cmplt_ps(m, _mm_set1_ps(0.707106781186547524f));
+	e = _mm_sub_ps(e, _mm_and_ps(small, _mm_set1_ps(1.0f)));
+	m = _mm_add_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_and_ps(small, m));
+
+	__m128 z = _mm_mul_ps(m, m);
+	__m128 y = _mm_add_ps(_mm_mul_ps(m, _mm_set1_ps(7.0376836292e-2f)), _mm_set1_ps(-1.1514610310e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+	y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+	y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+	y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+	__m128 result = _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+
+	result = SseSelect(zero, _mm_set1_ps(-HUGE_VALF), result);
+	result = SseSelect(infinity, x, result);
+	return _mm_or_ps(result, invalid);
+}
+
+struct SqrtKernel  { __m128 operator()(__m128 x) const { return _mm_sqrt_ps(x); } };
+struct AbsKernel   { __m128 operator()(__m128 x) const { return SseAbs(x); } };
+struct FloorKernel { __m128 operator()(__m128 x) const { return SseFloor(x); } };
+struct CeilKernel  { __m128 operator()(__m128 x) const { return SseCeil(x); } };
+struct SinKernel   { __m128 operator()(__m128 x) const { return SseSinCos(x, false); } };
+struct CosKernel   { __m128 operator()(__m128 x) const { return SseSinCos(x, true); } };
+struct ExpKernel   { __m128 operator()(__m128 x) const { return SseExp(x); } };
+struct LogKernel   { __m128 operator()(__m128 x) const { return SseLog(x); } };
+
+struct PowKernel
+{
+	PowKernel(float exponent) : e(_mm_set1_ps(exponent)) {}
+	__m128 operator()(__m128 x) const { return SseExp(_mm_mul_ps(SseLog(x), e)); }
+	__m128 e;
+};
+
+template<class Kernel>
+static void ApplyKernel(const float *src, float *dst, asUINT n, const Kernel &kernel)
+{
+	asUINT i = 0;
+	for( ; i + 4 <= n; i += 4 )
+		_mm_storeu_ps(dst + i, kernel(_mm_loadu_ps(src + i)));
+
+	if( i < n )
+	{
+		// the last elements go through a padded buffer, so every element gets the same result
+		float tmp[4] = {0, 0, 0, 0};
+		memcpy(tmp, src + i, (n - i) * sizeof(float));
+		_mm_storeu_ps(tmp, kernel(_mm_loadu_ps(tmp)));
+		memcpy(dst + i, tmp, (n - i) * sizeof(float));
+	}
+}
+#endif
+
+// This macro creates the array version of a function of type 'float func(float)'
+#define ARRAYff(name, func) \
+static void name(CScriptArray *in, CScriptArray *out) \
+{ \
+	asUINT n = PrepareOutput(in, out); \
+	if( n ) \
+	{ \
+		const float *src = (const float*)in->At(0); \
+		float *dst = (float*)out->At(0); \
+		for( asUINT i = 0; i < n; i++ ) \
+			dst[i] = func(src[i]); \
+	} \
+}
+
+// This one uses a SSE2 kernel instead, or the function if SSE2 isn't available
+#ifdef AS_MATHARRAY_SSE2
+#define ARRAYKERNEL(name, kernel, func) \
+static void name(CScriptArray *in, CScriptArray *out) \
+{ \
+	asUINT n = PrepareOutput(in, out); \
+	if( n ) \
+		ApplyKernel((const float*)in->At(0), (float*)out->At(0), n, kernel()); \
+}
+#else
+#define ARRAYKERNEL(name, kernel, func) ARRAYff(name, func)
+#endif
+
+ARRAYff(ArraySin, sinf)
+ARRAYff(ArrayCos, cosf)
+ARRAYff(ArrayTan, tanf)
+ARRAYff(ArrayAsin, asinf)
+ARRAYff(ArrayAcos, acosf)
+ARRAYff(ArrayAtan, atanf)
+ARRAYff(ArrayExp, expf)
+ARRAYff(ArrayLog, logf)
+ARRAYff(ArrayLog10, log10f)
+
+// exact, so they are always vectorized
+ARRAYKERNEL(ArraySqrt, SqrtKernel, sqrtf)
+ARRAYKERNEL(ArrayAbs, AbsKernel, fabsf)
+ARRAYKERNEL(ArrayFloor, FloorKernel, floorf)
+ARRAYKERNEL(ArrayCeil, CeilKernel, ceilf)
+
+// the fast approximations
+ARRAYKERNEL(ArraySinFast, SinKernel, sinf)
+ARRAYKERNEL(ArrayCosFast, CosKernel, cosf)
+ARRAYKERNEL(ArrayExpFast, ExpKernel, expf)
+ARRAYKERNEL(ArrayLogFast, LogKernel, logf)
+
+static void ArrayPow(CScriptArray *in, float exponent, CScriptArray *out)
+{
+	asUINT n = PrepareOutput(in, out);
+	if( n )
+	{
+		const float *src = (const float*)in->At(0);
+		float *dst = (float*)out->At(0);
+		for( asUINT i = 0; i < n; i++ )
+			dst[i] = powf(src[i], exponent);
+	}
+}
+
+static void ArrayPowFast(CScriptArray *in, float exponent, CScriptArray *out)
+{
+#ifdef AS_MATHARRAY_SSE2
+	asUINT n = PrepareOutput(in, out);
+	if( n )
+		ApplyKernel((const float*)in->At(0), (float*)out->At(0), n, PowKernel(exponent));
+#else
+	ArrayPow(in, exponent, out);
+#endif
+}
+
+static void ArrayAtan2(CScriptArray *y, CScriptArray *x, CScriptArray *out)
+{
+	asUINT n = PrepareOutput(y, x, out);
+	if( n )
+	{
+		const float *srcY = (const float*)y->At(0);
+		const float *srcX = (const float*)x->At(0);
+		float *dst = (float*)out->At(0);
+		for( asUINT i = 0; i < n; i++ )
+			dst[i] = atan2f(srcY[i], srcX[i]);
+	}
+}
+
+// y = a * x + y
+static void ArrayAxpy(float a, CScriptArray *x, CScriptArray *y)
+{
+	asUINT n = PrepareOutput(x, y, y);
+	if( n )
+	{
+		const float *src = (const float*)x->At(0);
+		float *dst = (float*)y->At(0);
+		asUINT i = 0;
+#ifdef AS_MATHARRAY_SSE2
+		__m128 va = _mm_set1_ps(a);
+		for( ; i + 4 <= n; i += 4 )
+			_mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(va, _mm_loadu_ps(src + i)), _mm_loadu_ps(dst + i)));
+#endif
+		for( ; i < n; i++ )
+			dst[i] = a * src[i] + dst[i];
+	}
+}
+
+// This macro creates the native entry points of the functions of type 'void func(array<float>@, array<float>@)'
+#define NATIVEaa(x) \
+static void x##_Native(CScriptArray *in, CScriptArray *out) \
+{ \
+	x(in, out); \
+	ReleaseArrays(in, out); \
+}
+
+NATIVEaa(ArraySin)
+NATIVEaa(ArrayCos)
+NATIVEaa(ArrayTan)
+NATIVEaa(ArrayAsin)
+NATIVEaa(ArrayAcos)
+NATIVEaa(ArrayAtan)
+NATIVEaa(ArrayExp)
+NATIVEaa(ArrayLog)
+NATIVEaa(ArrayLog10)
+NATIVEaa(ArraySqrt)
+NATIVEaa(ArrayAbs)
+NATIVEaa(ArrayFloor)
+NATIVEaa(ArrayCeil)
+NATIVEaa(ArraySinFast)
+NATIVEaa(ArrayCosFast)
+NATIVEaa(ArrayExpFast)
+NATIVEaa(ArrayLogFast)
+
+static void ArrayPow_Native(CScriptArray *in, float exponent, CScriptArray *out)
+{
+	ArrayPow(in, exponent, out);
+	ReleaseArrays(in, out);
+}
+
+static void ArrayPowFast_Native(CScriptArray *in, float exponent, CScriptArray *out)
+{
+	ArrayPowFast(in, exponent, out);
+	ReleaseArrays(in, out);
+}
+
+static void ArrayAtan2_Native(CScriptArray *y, CScriptArray *x, CScriptArray *out)
+{
+	ArrayAtan2(y, x, out);
+	ReleaseArrays(y, x, out);
+}
+
+static void ArrayAxpy_Native(float a, CScriptArray *x, CScriptArray *y)
+{
+	ArrayAxpy(a, x, y);
+	ReleaseArrays(x, y);
+}
+
+void RegisterScriptMathArray_Native(asIScriptEngine *engine, bool fastApproximations)
+{
+	int r;
+
+	// Trigonometric functions
+	r = engine->RegisterGlobalFunction("void sin(array<float>@, array<float>@)", fastApproximations ? asFUNCTION(ArraySinFast_Native) : asFUNCTION(ArraySin_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void cos(array<float>@, array<float>@)", fastApproximations ? asFUNCTION(ArrayCosFast_Native) : asFUNCTION(ArrayCos_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void tan(array<float>@, array<float>@)", asFUNCTION(ArrayTan_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void asin(array<float>@, array<float>@)", asFUNCTION(ArrayAsin_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void acos(array<float>@, array<float>@)", asFUNCTION(ArrayAcos_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void atan(array<float>@, array<float>@)", asFUNCTION(ArrayAtan_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void atan2(array<float>@, array<float>@, array<float>@)", asFUNCTION(ArrayAtan2_Native), asCALL_CDECL); assert( r >= 0 );
+
+	// Exponential and logarithmic functions
+	r = engine->RegisterGlobalFunction("void exp(array<float>@, array<float>@)", fastApproximations ? asFUNCTION(ArrayExpFast_Native) : asFUNCTION(ArrayExp_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void log(array<float>@, array<float>@)", fastApproximations ? asFUNCTION(ArrayLogFast_Native) : asFUNCTION(ArrayLog_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void log10(array<float>@, array<float>@)", asFUNCTION(ArrayLog10_Native), asCALL_CDECL); assert( r >= 0 );
+
+	// Power functions
+	r = engine->RegisterGlobalFunction("void pow(array<float>@, float, array<float>@)", fastApproximations ? asFUNCTION(ArrayPowFast_Native) : asFUNCTION(ArrayPow_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void sqrt(array<float>@, array<float>@)", asFUNCTION(ArraySqrt_Native), asCALL_CDECL); assert( r >= 0 );
+
+	// Nearest integer and absolute value functions
+	r = engine->RegisterGlobalFunction("void abs(array<float>@, array<float>@)", asFUNCTION(ArrayAbs_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void floor(array<float>@, array<float>@)", asFUNCTION(ArrayFloor_Native), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void ceil(array<float>@, array<float>@)", asFUNCTION(ArrayCeil_Native), asCALL_CDECL); assert( r >= 0 );
+
+	// Linear combination
+	r = engine->RegisterGlobalFunction("void axpy(float, array<float>@, array<float>@)", asFUNCTION(ArrayAxpy_Native), asCALL_CDECL); assert( r >= 0 );
+}
+
+// This macro creates generic wrappers for the functions of type 'void func(array<float>@, array<float>@)'
+#define GENERICaa(x) \
+static void x##_Generic(asIScriptGeneric *gen) \
+{ \
+	x((CScriptArray*)gen->GetArgObject(0), (CScriptArray*)gen->GetArgObject(1)); \
+}
+
+GENERICaa(ArraySin)
+GENERICaa(ArrayCos)
+GENERICaa(ArrayTan)
+GENERICaa(ArrayAsin)
+GENERICaa(ArrayAcos)
+GENERICaa(ArrayAtan)
+GENERICaa(ArrayExp)
+GENERICaa(ArrayLog)
+GENERICaa(ArrayLog10)
+GENERICaa(ArraySqrt)
+GENERICaa(ArrayAbs)
+GENERICaa(ArrayFloor)
+GENERICaa(ArrayCeil)
+GENERICaa(ArraySinFast)
+GENERICaa(ArrayCosFast)
+GENERICaa(ArrayExpFast)
+GENERICaa(ArrayLogFast)
+
+static void ArrayPow_Generic(asIScriptGeneric *gen)
+{
+	ArrayPow((CScriptArray*)gen->GetArgObject(0), gen->GetArgFloat(1), (CScriptArray*)gen->GetArgObject(2));
+}
+
+static void ArrayPowFast_Generic(asIScriptGeneric *gen)
+{
+	ArrayPowFast((CScriptArray*)gen->GetArgObject(0), gen->GetArgFloat(1), (CScriptArray*)gen->GetArgObject(2));
+}
+
+static void ArrayAtan2_Generic(asIScriptGeneric *gen)
+{
+	ArrayAtan2((CScriptArray*)gen->GetArgObject(0), (CScriptArray*)gen->GetArgObject(1), (CScriptArray*)gen->GetArgObject(2));
+}
+
+static void ArrayAxpy_Generic(asIScriptGeneric *gen)
+{
+	ArrayAxpy(gen->GetArgFloat(0), (CScriptArray*)gen->GetArgObject(1), (CScriptArray*)gen->GetArgObject(2));
+}
+
+void RegisterScriptMathArray_Generic(asIScriptEngine *engine, bool fastApproximations)
+{
+	int r;
+
+	// Trigonometric functions
+	r = engine->RegisterGlobalFunction("void sin(array<float>@, array<float>@)", fastApproximations ? asFUNCTION(ArraySinFast_Generic) : asFUNCTION(ArraySin_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void cos(array<float>@, array<float>@)", fastApproximations ? asFUNCTION(ArrayCosFast_Generic) : asFUNCTION(ArrayCos_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void tan(array<float>@, array<float>@)", asFUNCTION(ArrayTan_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void asin(array<float>@, array<float>@)", asFUNCTION(ArrayAsin_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void acos(array<float>@, array<float>@)", asFUNCTION(ArrayAcos_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void atan(array<float>@, array<float>@)", asFUNCTION(ArrayAtan_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void atan2(array<float>@, array<float>@, array<float>@)", asFUNCTION(ArrayAtan2_Generic), asCALL_GENERIC); assert( r >= 0 );
+
+	// Exponential and logarithmic functions
+	r = engine->RegisterGlobalFunction("void exp(array<float>@, array<float>@)", fastApproximations ? asFUNCTION(ArrayExpFast_Generic) : asFUNCTION(ArrayExp_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void log(array<float>@, array<float>@)", fastApproximations ? asFUNCTION(ArrayLogFast_Generic) : asFUNCTION(ArrayLog_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void log10(array<float>@, array<float>@)", asFUNCTION(ArrayLog10_Generic), asCALL_GENERIC); assert( r >= 0 );
+
+	// Power functions
+	r = engine->RegisterGlobalFunction("void pow(array<float>@, float, array<float>@)", fastApproximations ? asFUNCTION(ArrayPowFast_Generic) : asFUNCTION(ArrayPow_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void sqrt(array<float>@, array<float>@)", asFUNCTION(ArraySqrt_Generic), asCALL_GENERIC); assert( r >= 0 );
+
+	// Nearest integer and absolute value functions
+	r = engine->RegisterGlobalFunction("void abs(array<float>@, array<float>@)", asFUNCTION(ArrayAbs_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void floor(array<float>@, array<float>@)", asFUNCTION(ArrayFloor_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void ceil(array<float>@, array<float>@)", asFUNCTION(ArrayCeil_Generic), asCALL_GENERIC); assert( r >= 0 );
+
+	// Linear combination
+	r = engine->RegisterGlobalFunction("void axpy(float, array<float>@, array<float>@)", asFUNCTION(ArrayAxpy_Generic), asCALL_GENERIC); assert( r >= 0 );
+}
+
+void RegisterScriptMathArray(asIScriptEngine *engine, bool fastApproximations)
+{
+	if( strstr(asGetLibraryOptions(), "AS_MAX_PORTABILITY") )
+		RegisterScriptMathArray_Generic(engine, fastApproximations);
+	else
+		RegisterScriptMathArray_Native(engine, fastApproximations);
+}
+
+END_AS_NAMESPACE
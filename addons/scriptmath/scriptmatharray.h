@@ -0,0 +1,49 @@
+#ifndef SCRIPTMATHARRAY_H
+#define SCRIPTMATHARRAY_H
+
+#include <angelscript.h>
+
+BEGIN_AS_NAMESPACE
+
+// Array overloads of the math functions, so a whole signal or curve is
+// processed with one native call instead of one call per element:
+//
+//   void sin(array<float>@ in, array<float>@ out)
+//   void pow(array<float>@ in, float exponent, array<float>@ out)
+//   void atan2(array<float>@ y, array<float>@ x, array<float>@ out)
+//   void axpy(float a, array<float>@ x, array<float>@ y)       y = a * x + y
+//
+// The output array is resized to the size of the input, it may be the
+// input array itself. sin, cos, tan, asin, acos, atan, exp, log, log10,
+// pow, atan2, sqrt, abs, floor, ceil and axpy are registered. sqrt, abs,
+// floor, ceil and axpy use SSE2 where available and are exact.
+//
+// With fastApproximations the application trades precision for speed,
+// sin, cos, exp, log and pow are then computed with SSE2 polynomials
+// (on other platforms they stay precise). The measured error bounds are:
+//
+//   sin, cos  absolute error below 1e-7 for |x| < 8192, range reduction
+//             loses precision beyond that
+//   exp       relative error below 1e-7, the input is clamped to
+//             [-87.33, 88.37], so results saturate at the smallest and
+//             largest normal float instead of reaching zero or infinity
+//   log       error below 1e-7 * max(1, |log(x)|) for positive inputs,
+//             0 gives -inf, negative inputs NaN, denormals are treated
+//             as the smallest normal float
+//   pow       computed as exp(exponent * log(x)), so the base must be
+//             positive, relative error below 2e-7 * (1 + |exponent * log(x)|)
+//
+// The array add-on must be registered before calling this function.
+void RegisterScriptMathArray(asIScriptEngine *engine, bool fastApproximations = false);
+
+// Call this function to register the array functions
+// using native calling conventions
+void RegisterScriptMathArray_Native(asIScriptEngine *engine, bool fastApproximations = false);
+
+// Use this one instead if native calling conventions
+// are not supported on the target platform
+void RegisterScriptMathArray_Generic(asIScriptEngine *engine, bool fastApproximations = false);
+
+END_AS_NAMESPACE
+
+#endif
@@ -0,0 +1,579 @@
+#include <assert.h>
+#include <math.h>
+#include <string.h> // strstr
+#include "scriptnoise.h"
+#include "../scriptarray/scriptarray.h"
+
+// The batch functions evaluate four sample points at once if SSE2 is available
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AS_NOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+BEGIN_AS_NAMESPACE
+
+enum NoiseType
+{
+	NOISE_VALUE,
+	NOISE_PERLIN,
+	NOISE_SIMPLEX
+};
+
+// The noise is written once as templates over the lane type, so that the
+// scalar and the SSE2 versions give exactly the same values. A lane type
+// provides F (float), U (unsigned int), M (comparison mask) and the
+// operations the templates need besides the arithmetic operators.
+struct ScalarLanes
+{
+	typedef float  F;
+	typedef asUINT U;
+	typedef bool   M;
+
+	static F Floor(F x)              { return floorf(x); }
+	static U ToInt(F x)              { return (U)(int)x; }
+	static F ToFloat(U u)            { return (F)(int)u; }
+	static F Max(F a, F b)           { return a > b ? a : b; }
+	static M GreaterEqual(F a, F b)  { return a >= b; }
+	static M Less(U a, U b)          { return (int)a < (int)b; }
+	static M Equal(U a, U b)         { return a == b; }
+	static M Bit(U a, U bit)         { return (a & bit) != 0; }
+	static M And(M a, M b)           { return a && b; }
+	static M Or(M a, M b)            { return a || b; }
+	static M Not(M a)                { return !a; }
+	static F Select(M m, F a, F b)   { return m ? a : b; }
+	static F Negate(M m, F a)        { return m ? -a : a; }
+};
+
+#ifdef AS_NOISE_SSE2
+struct SseFloat
+{
+	SseFloat() {}
+	SseFloat(__m128 _v) : v(_v) {}
+	SseFloat(float f) : v(_mm_set1_ps(f)) {}
+
+	__m128 v;
+};
+
+inline SseFloat operator+(SseFloat a, SseFloat b) { return _mm_add_ps(a.v, b.v); }
+inline SseFloat operator-(SseFloat a, SseFloat b) { return _mm_sub_ps(a.v, b.v); }
+inline SseFloat operator*(SseFloat a, SseFloat b) { return _mm_mul_ps(a.v, b.v); }
+
+struct SseUint
+{
+	SseUint() {}
+	SseUint(__m128i _v) : v(_v) {}
+	SseUint(asUINT u) : v(_mm_set1_epi32((int)u)) {}
+
+	__m128i v;
+};
+
+inline SseUint operator+(SseUint a, SseUint b) { return _mm_add_epi32(a.v, b.v); }
+inline SseUint operator^(SseUint a, SseUint b) { return _mm_xor_si128(a.v, b.v); }
+inline SseUint operator&(SseUint a, SseUint b) { return _mm_and_si128(a.v, b.v); }
+inline SseUint operator>>(SseUint a, int n)    { return _mm_srli_epi32(a.v, n); }
+
+inline SseUint operator*(SseUint a, SseUint b)
+{
+	// SSE2 has no 32 bit multiply, combine the 64 bit products of the even and the odd lanes
+	__m128i even = _mm_mul_epu32(a.v, b.v);
+	__m128i odd  = _mm_mul_epu32(_mm_srli_si128(a.v, 4), _mm_srli_si128(b.v, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+struct SseLanes
+{
+	typedef SseFloat F;
+	typedef SseUint  U;
+	typedef __m128   M;
+
+	static F Floor(F x)
+	{
+		// truncate, then step down where that rounded up
+		__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.v));
+		return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x.v), _mm_set1_ps(1.0f)));
+	}
+	static U ToInt(F x)              { return _mm_cvttps_epi32(x.v); }
+	static F ToFloat(U u)            { return _mm_cvtepi32_ps(u.v); }
+	static F Max(F a, F b)           { return _mm_max_ps(a.v, b.v); }
+	static M GreaterEqual(F a, F b)  { return _mm_cmpge_ps(a.v, b.v); }
+	static M Less(U a, U b)          { return _mm_castsi128_ps(_mm_cmplt_epi32(a.v, b.v)); }
+	static M Equal(U a, U b)         { return _mm_castsi128_ps(_mm_cmpeq_epi32(a.v, b.v)); }
+	static M Bit(U a, U bit)         { return Not(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a.v, bit.v), _mm_setzero_si128()))); }
+	static M And(M a, M b)           { return _mm_and_ps(a, b); }
+	static M Or(M a, M b)            { return _mm_or_ps(a, b); }
+	static M Not(M a)                { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+	static F Select(M m, F a, F b)   { return _mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v)); }
+	static F Negate(M m, F a)        { return _mm_xor_ps(a.v, _mm_and_ps(m, _mm_set1_ps(-0.0f))); }
+};
+#endif
+
+template<class T>
+struct Noise
+{
+	typedef typename T::F F;
+	typedef typename T::U U;
+	typedef typename T::M M;
+
+	// Hash of a lattice point, all bits depend on all coordinates and the seed
+	static inline U Hash(U x, U y, U z, U seed)
+	{
+		U h = seed + x * U(0x27d4eb2dU) + y * U(0x165667b1U) + z * U(0x9e3779b1U);
+		h = (h ^ (h >> 15)) * U(0x85ebca6bU);
+		h = (h ^ (h >> 13)) * U(0xc2b2ae35U);
+		return h ^ (h >> 16);
+	}
+
+	// Random value in [-1, 1] for value noise
+	static inline F Lattice(U h)
+	{
+		return T::ToFloat(h & U(0xffffffU)) * F(2.0f / 16777215.0f) - F(1.0f);
+	}
+
+	// Dot product with one of eight gradients (+-1, +-2) and (+-2, +-1)
+	static inline F Grad2(U h, F x, F y)
+	{
+		M swap = T::Bit(h, U(4U));
+		F u = T::Select(swap, y, x);
+		F v = T::Select(swap, x, y);
+		return T::Negate(T::Bit(h, U(1U)), u) + T::Negate(T::Bit(h, U(2U)), v + v);
+	}
+
+	// Dot product with one of the twelve cube edge gradients of improved Perlin noise
+	static inline F Grad3(U h, F x, F y, F z)
+	{
+		U h15 = h & U(15U);
+		F u = T::Select(T::Less(h15, U(8U)), x, y);
+		F v = T::Select(T::Less(h15, U(4U)), y, T::Select(T::Or(T::Equal(h15, U(12U)), T::Equal(h15, U(14U))), x, z));
+		return T::Negate(T::Bit(h, U(1U)), u) + T::Negate(T::Bit(h, U(2U)), v);
+	}
+
+	static inline F Fade(F t)
+	{
+		return t * t * t * (t * (t * F(6.0f) - F(15.0f)) + F(10.0f));
+	}
+
+	static inline F Lerp(F a, F b, F t)
+	{
+		return a + (b - a) * t;
+	}
+
+	static F Value2(F x, F y, U seed)
+	{
+		F fx = T::Floor(x), fy = T::Floor(y);
+		U ix = T::ToInt(fx), iy = T::ToInt(fy), iz(0U), one(1U);
+		F tx = Fade(x - fx), ty = Fade(y - fy);
+
+		F v00 = Lattice(Hash(ix,       iy,       iz, seed));
+		F v10 = Lattice(Hash(ix + one, iy,       iz, seed));
+		F v01 = Lattice(Hash(ix,       iy + one, iz, seed));
+		F v11 = Lattice(Hash(ix + one, iy + one, iz, seed));
+		return Lerp(Lerp(v00, v10, tx), Lerp(v01, v11, tx), ty);
+	}
+
+	static F Value3(F x, F y, F z, U seed)
+	{
+		F fx = T::Floor(x), fy = T::Floor(y), fz = T::Floor(z);
+		U ix = T::ToInt(fx), iy = T::ToInt(fy), iz = T::ToInt(fz), one(1U);
+		F tx = Fade(x - fx), ty = Fade(y - fy), tz = Fade(z - fz);
+
+		F v000 = Lattice(Hash(ix,       iy,       iz,       seed));
+		F v100 = Lattice(Hash(ix + one, iy,       iz,       seed));
+		F v010 = Lattice(Hash(ix,       iy + one, iz,       seed));
+		F v110 = Lattice(Hash(ix + one, iy + one, iz,       seed));
+		F v001 = Lattice(Hash(ix,       iy,       iz + one, seed));
+		F v101 = Lattice(Hash(ix + one, iy,       iz + one, seed));
+		F v011 = Lattice(Hash(ix,       iy + one, iz + one, seed));
+		F v111 = Lattice(Hash(ix + one, iy + one, iz + one, seed));
+		return Lerp(Lerp(Lerp(v000, v100, tx), Lerp(v010, v110, tx), ty),
+		            Lerp(Lerp(v001, v101, tx), Lerp(v011, v111, tx), ty), tz);
+	}
+
+	static F Perlin2(F x, F y, U seed)
+	{
+		F fx = T::Floor(x), fy = T::Floor(y);
+		U ix = T::ToInt(fx), iy = T::ToInt(fy), iz(0U), one(1U);
+		F dx = x - fx, dy = y - fy;
+		F tx = Fade(dx), ty = Fade(dy);
+
+		F n00 = Grad2(Hash(ix,       iy,       iz, seed), dx,          dy);
+		F n10 = Grad2(Hash(ix + one, iy,       iz, seed), dx - F(1.0f), dy);
+		F n01 = Grad2(Hash(ix,       iy + one, iz, seed), dx,          dy - F(1.0f));
+		F n11 = Grad2(Hash(ix + one, iy + one, iz, seed), dx - F(1.0f), dy - F(1.0f));
+		return Lerp(Lerp(n00, n10, tx), Lerp(n01, n11, tx), ty) * F(0.65f);
+	}
+
+	static F Perlin3(F x, F y, F z, U seed)
+	{
+		F fx = T::Floor(x), fy = T::Floor(y), fz = T::Floor(z);
+		U ix = T::ToInt(fx), iy = T::ToInt(fy), iz = T::ToInt(fz), one(1U);
+		F dx = x - fx, dy = y - fy, dz = z - fz;
+		F ex = dx - F(1.0f), ey = dy - F(1.0f), ez = dz - F(1.0f);
+		F tx = Fade(dx), ty = Fade(dy), tz = Fade(dz);
+
+		F n000 = Grad3(Hash(ix,       iy,       iz,       seed), dx, dy, dz);
+		F n100 = Grad3(Hash(ix + one, iy,       iz,       seed), ex, dy, dz);
+		F n010 = Grad3(Hash(ix,       iy + one, iz,       seed), dx, ey, dz);
+		F n110 = Grad3(Hash(ix + one, iy + one, iz,       seed), ex, ey, dz);
+		F n001 = Grad3(Hash(ix,       iy,       iz + one, seed), dx, dy, ez);
+		F n101 = Grad3(Hash(ix + one, iy,       iz + one, seed), ex, dy, ez);
+		F n011 = Grad3(Hash(ix,       iy + one, iz + one, seed), dx, ey, ez);
+		F n111 = Grad3(Hash(ix + one, iy + one, iz + one, seed), ex, ey, ez);
+		return Lerp(Lerp(Lerp(n000, n100, tx), Lerp(n010, n110, tx), ty),
+		            Lerp(Lerp(n001, n101, tx), Lerp(n011, n111, tx), ty), tz);
+	}
+
+	// Contribution of a simplex corner, zero beyond a radius of sqrt(0.5)
+	static inline F Corner2(U h, F x, F y)
+	{
+		F t = T::Max(F(0.5f) - x * x - y * y, F(0.0f));
+		t = t * t;
+		return t * t * Grad2(h, x, y);
+	}
+
+	static inline F Corner3(U h, F x, F y, F z)
+	{
+		F t = T::Max(F(0.5f) - x * x - y * y - z * z, F(0.0f));
+		t = t * t;
+		return t * t * Grad3(h, x, y, z);
+	}
+
+	static F Simplex2(F x, F y, U seed)
+	{
+		const float F2 = 0.366025403f; // (sqrt(3) - 1) / 2
+		const float G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+
+		// skew to find the simplex cell, then unskew to get the offset from its origin
+		F s = (x + y) * F(F2);
+		F i = T::Floor(x + s), j = T::Floor(y + s);
+		F t = (i + j) * F(G2);
+		F x0 = x - (i - t), y0 = y - (j - t);
+
+		// the middle corner is along x in the lower triangle, along y in the upper one
+		F i1 = T::Select(T::GreaterEqual(x0, y0), F(1.0f), F(0.0f));
+		F j1 = F(1.0f) - i1;
+		F x1 = x0 - i1 + F(G2), y1 = y0 - j1 + F(G2);
+		F x2 = x0 + F(2.0f * G2 - 1.0f), y2 = y0 + F(2.0f * G2 - 1.0f);
+
+		U ii = T::ToInt(i), jj = T::ToInt(j), iz(0U), one(1U);
+		F n = Corner2(Hash(ii, jj, iz, seed), x0, y0)
+		    + Corner2(Hash(ii + T::ToInt(i1), jj + T::ToInt(j1), iz, seed), x1, y1)
+		    + Corner2(Hash(ii + one, jj + one, iz, seed), x2, y2);
+		return n * F(45.0f);
+	}
+
+	static F Simplex3(F x, F y, F z, U seed)
+	{
+		const float F3 = 1.0f / 3.0f;
+		const float G3 = 1.0f / 6.0f;
+
+		F s = (x + y + z) * F(F3);
+		F i = T::Floor(x + s), j = T::Floor(y + s), k = T::Floor(z + s);
+		F t = (i + j + k) * F(G3);
+		F x0 = x - (i - t), y0 = y - (j - t), z0 = z - (k - t);
+
+		// order the offsets to find the two middle corners of the tetrahedron
+		M xy = T::GreaterEqual(x0, y0), yz = T::GreaterEqual(y0, z0), xz = T::GreaterEqual(x0, z0);
+		F one(1.0f), zero(0.0f);
+		F i1 = T::Select(T::And(xy, xz), one, zero);
+		F j1 = T::Select(T::And(T::Not(xy), yz), one, zero);
+		F k1 = T::Select(T::And(T::Not(xz), T::Not(yz)), one, zero);
+		F i2 = T::Select(T::Or(xy, xz), one, zero);
+		F j2 = T::Select(T::Or(T::Not(xy), yz), one, zero);
+		F k2 = T::Select(T::Not(T::And(xz, yz)), one, zero);
+
+		F x1 = x0 - i1 + F(G3),        y1 = y0 - j1 + F(G3),        z1 = z0 - k1 + F(G3);
+		F x2 = x0 - i2 + F(2.0f * G3), y2 = y0 - j2 + F(2.0f * G3), z2 = z0 - k2 + F(2.0f * G3);
+		F x3 = x0 + F(3.0f * G3 - 1.0f), y3 = y0 + F(3.0f * G3 - 1.0f), z3 = z0 + F(3.0f * G3 - 1.0f);
+
+		U ii = T::ToInt(i), jj = T::ToInt(j), kk = T::ToInt(k), uone(1U);
+		F n = Corner3(Hash(ii, jj, kk, seed), x0, y0, z0)
+		    + Corner3(Hash(ii + T::ToInt(i1), jj + T::ToInt(j1), kk + T::ToInt(k1), seed), x1, y1, z1)
+		    + Corner3(Hash(ii + T::ToInt(i2), jj + T::ToInt(j2), kk + T::ToInt(k2), seed), x2, y2, z2)
+		    + Corner3(Hash(ii + uone, jj + uone, kk + uone, seed), x3, y3, z3);
+		return n * F(76.0f);
+	}
+
+	static inline F Sample2(int type, F x, F y, U seed)
+	{
+		switch( type )
+		{
+		case NOISE_VALUE:  return Value2(x, y, seed);
+		case NOISE_PERLIN: return Perlin2(x, y, seed);
+		default:           return Simplex2(x, y, seed);
+		}
+	}
+
+	static inline F Sample3(int type, F x, F y, F z, U seed)
+	{
+		switch( type )
+		{
+		case NOISE_VALUE:  return Value3(x, y, z, seed);
+		case NOISE_PERLIN: return Perlin3(x, y, z, seed);
+		default:           return Simplex3(x, y, z, seed);
+		}
+	}
+
+	// Sum of octaves with rising frequency and falling amplitude, every octave
+	// uses its own seed. The sum is divided by the total amplitude to stay in range.
+	static F Fractal2(int type, F x, F y, asUINT seed, asUINT octaves, float lacunarity, float gain)
+	{
+		F sum(0.0f);
+		float frequency = 1.0f, amplitude = 1.0f, total = 0.0f;
+		for( asUINT n = 0; n < octaves; n++ )
+		{
+			sum = sum + Sample2(type, x * F(frequency), y * F(frequency), U(seed + n * 0x68e31da4U)) * F(amplitude);
+			total     += fabsf(amplitude);
+			frequency *= lacunarity;
+			amplitude *= gain;
+		}
+		return sum * F(1.0f / total);
+	}
+
+	static F Fractal3(int type, F x, F y, F z, asUINT seed, asUINT octaves, float lacunarity, float gain)
+	{
+		F sum(0.0f);
+		float frequency = 1.0f, amplitude = 1.0f, total = 0.0f;
+		for( asUINT n = 0; n < octaves; n++ )
+		{
+			sum = sum + Sample3(type, x * F(frequency), y * F(frequency), z * F(frequency), U(seed + n * 0x68e31da4U)) * F(amplitude);
+			total     += fabsf(amplitude);
+			frequency *= lacunarity;
+			amplitude *= gain;
+		}
+		return sum * F(1.0f / total);
+	}
+};
+
+typedef Noise<ScalarLanes> ScalarNoise;
+#ifdef AS_NOISE_SSE2
+typedef Noise<SseLanes> SseNoise;
+#endif
+
+// Fills a row of width samples starting at x, the x coordinates are
+// computed the same way in both loops so the lanes match the scalar values
+static void FillRow2(float *out, int type, float x, float y, float step, asUINT width, asUINT seed, asUINT octaves, float lacunarity, float gain)
+{
+	asUINT n = 0;
+#ifdef AS_NOISE_SSE2
+	const SseFloat lanes(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+	for( ; n + 4 <= width; n += 4 )
+	{
+		SseFloat sx = (SseFloat((float)n) + lanes) * SseFloat(step) + SseFloat(x);
+		_mm_storeu_ps(out + n, SseNoise::Fractal2(type, sx, SseFloat(y), seed, octaves, lacunarity, gain).v);
+	}
+#endif
+	for( ; n < width; n++ )
+		out[n] = ScalarNoise::Fractal2(type, (float)n * step + x, y, seed, octaves, lacunarity, gain);
+}
+
+static void FillRow3(float *out, int type, float x, float y, float z, float step, asUINT width, asUINT seed, asUINT octaves, float lacunarity, float gain)
+{
+	asUINT n = 0;
+#ifdef AS_NOISE_SSE2
+	const SseFloat lanes(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+	for( ; n + 4 <= width; n += 4 )
+	{
+		SseFloat sx = (SseFloat((float)n) + lanes) * SseFloat(step) + SseFloat(x);
+		_mm_storeu_ps(out + n, SseNoise::Fractal3(type, sx, SseFloat(y), SseFloat(z), seed, octaves, lacunarity, gain).v);
+	}
+#endif
+	for( ; n < width; n++ )
+		out[n] = ScalarNoise::Fractal3(type, (float)n * step + x, y, z, seed, octaves, lacunarity, gain);
+}
+
+// Zero octaves would give no noise at all, treat them as one. The cost grows with every
+// octave, so a huge count from a script is clamped, 16 octaves already span 65536:1 in scale
+static const asUINT MAX_OCTAVES = 16;
+
+static asUINT ValidOctaves(asUINT octaves)
+{
+	if( octaves == 0 ) return 1;
+	return octaves < MAX_OCTAVES ? octaves : MAX_OCTAVES;
+}
+
+// Resizes the array to hold the grid, returns false if there is nothing to fill
+static bool ResizeGrid(CScriptArray *out, asUINT width, asUINT height, asUINT depth)
+{
+	asUINT count = width;
+	if( (height && count > 0xFFFFFFFFU / height) ||
+		(depth && count * height > 0xFFFFFFFFU / depth) )
+	{
+		asIScriptContext *ctx = asGetActiveContext();
+		if( ctx )
+			ctx->SetException("Too large array size");
+		return false;
+	}
+	count *= height * depth;
+
+	// the array sets an exception itself if it can't grow that much
+	out->Resize(count);
+	return count > 0 && out->GetSize() == count;
+}
+
+static float ValueNoise2(float x, float y, asUINT seed)
+{
+	return ScalarNoise::Value2(x, y, seed);
+}
+
+static float ValueNoise3(float x, float y, float z, asUINT seed)
+{
+	return ScalarNoise::Value3(x, y, z, seed);
+}
+
+static float PerlinNoise2(float x, float y, asUINT seed)
+{
+	return ScalarNoise::Perlin2(x, y, seed);
+}
+
+static float PerlinNoise3(float x, float y, float z, asUINT seed)
+{
+	return ScalarNoise::Perlin3(x, y, z, seed);
+}
+
+static float SimplexNoise2(float x, float y, asUINT seed)
+{
+	return ScalarNoise::Simplex2(x, y, seed);
+}
+
+static float SimplexNoise3(float x, float y, float z, asUINT seed)
+{
+	return ScalarNoise::Simplex3(x, y, z, seed);
+}
+
+static float FractalNoise2(int type, float x, float y, asUINT seed, asUINT octaves, float lacunarity, float gain)
+{
+	return ScalarNoise::Fractal2(type, x, y, seed, ValidOctaves(octaves), lacunarity, gain);
+}
+
+static float FractalNoise3(int type, float x, float y, float z, asUINT seed, asUINT octaves, float lacunarity, float gain)
+{
+	return ScalarNoise::Fractal3(type, x, y, z, seed, ValidOctaves(octaves), lacunarity, gain);
+}
+
+// The grid is stored row by row, sample (i, j) is at (x + i * step, y + j * step)
+static void NoiseGrid2(CScriptArray *out, int type, float x, float y, float step, asUINT width, asUINT height, asUINT seed, asUINT octaves, float lacunarity, float gain)
+{
+	if( !ResizeGrid(out, width, height, 1) )
+		return;
+
+	octaves = ValidOctaves(octaves);
+	float *data = (float*)out->At(0);
+	for( asUINT j = 0; j < height; j++ )
+		FillRow2(data + j * width, type, x, y + (float)j * step, step, width, seed, octaves, lacunarity, gain);
+}
+
+// The grid is stored slice by slice, each slice row by row
+static void NoiseGrid3(CScriptArray *out, int type, float x, float y, float z, float step, asUINT width, asUINT height, asUINT depth, asUINT seed, asUINT octaves, float lacunarity, float gain)
+{
+	if( !ResizeGrid(out, width, height, depth) )
+		return;
+
+	octaves = ValidOctaves(octaves);
+	float *data = (float*)out->At(0);
+	for( asUINT k = 0; k < depth; k++ )
+		for( asUINT j = 0; j < height; j++ )
+			FillRow3(data + (k * height + j) * width, type, x, y + (float)j * step, z + (float)k * step, step, width, seed, octaves, lacunarity, gain);
+}
+
+static void RegisterNoiseType(asIScriptEngine *engine)
+{
+	int r;
+	r = engine->RegisterEnum("noise_type"); assert( r >= 0 );
+	r = engine->RegisterEnumValue("noise_type", "NOISE_VALUE", NOISE_VALUE); assert( r >= 0 );
+	r = engine->RegisterEnumValue("noise_type", "NOISE_PERLIN", NOISE_PERLIN); assert( r >= 0 );
+	r = engine->RegisterEnumValue("noise_type", "NOISE_SIMPLEX", NOISE_SIMPLEX); assert( r >= 0 );
+}
+
+void RegisterScriptNoise_Native(asIScriptEngine *engine)
+{
+	int r;
+
+	RegisterNoiseType(engine);
+
+	r = engine->RegisterGlobalFunction("float valueNoise(float, float, uint)", asFUNCTION(ValueNoise2), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float valueNoise(float, float, float, uint)", asFUNCTION(ValueNoise3), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float perlinNoise(float, float, uint)", asFUNCTION(PerlinNoise2), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float perlinNoise(float, float, float, uint)", asFUNCTION(PerlinNoise3), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float simplexNoise(float, float, uint)", asFUNCTION(SimplexNoise2), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float simplexNoise(float, float, float, uint)", asFUNCTION(SimplexNoise3), asCALL_CDECL); assert( r >= 0 );
+
+	// noise type, coordinates, seed, octaves, lacunarity, gain
+	r = engine->RegisterGlobalFunction("float fractalNoise(noise_type, float, float, uint, uint, float, float)", asFUNCTION(FractalNoise2), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float fractalNoise(noise_type, float, float, float, uint, uint, float, float)", asFUNCTION(FractalNoise3), asCALL_CDECL); assert( r >= 0 );
+
+	// output, noise type, grid origin, step, grid size, seed, octaves, lacunarity, gain
+	r = engine->RegisterGlobalFunction("void noiseGrid(array<float> &inout, noise_type, float, float, float, uint, uint, uint, uint, float, float)", asFUNCTION(NoiseGrid2), asCALL_CDECL); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void noiseGrid(array<float> &inout, noise_type, float, float, float, float, uint, uint, uint, uint, uint, float, float)", asFUNCTION(NoiseGrid3), asCALL_CDECL); assert( r >= 0 );
+}
+
+// These macros create generic wrappers for the noise functions of type 'float func(float, float[, float], uint)'
+#define GENERIC2(x) \
+static void x##_Generic(asIScriptGeneric *gen) \
+{ \
+	gen->SetReturnFloat(x(gen->GetArgFloat(0), gen->GetArgFloat(1), gen->GetArgDWord(2))); \
+}
+
+#define GENERIC3(x) \
+static void x##_Generic(asIScriptGeneric *gen) \
+{ \
+	gen->SetReturnFloat(x(gen->GetArgFloat(0), gen->GetArgFloat(1), gen->GetArgFloat(2), gen->GetArgDWord(3))); \
+}
+
+GENERIC2(ValueNoise2)
+GENERIC3(ValueNoise3)
+GENERIC2(PerlinNoise2)
+GENERIC3(PerlinNoise3)
+GENERIC2(SimplexNoise2)
+GENERIC3(SimplexNoise3)
+
+static void FractalNoise2_Generic(asIScriptGeneric *gen)
+{
+	gen->SetReturnFloat(FractalNoise2((int)gen->GetArgDWord(0), gen->GetArgFloat(1), gen->GetArgFloat(2), gen->GetArgDWord(3), gen->GetArgDWord(4), gen->GetArgFloat(5), gen->GetArgFloat(6)));
+}
+
+static void FractalNoise3_Generic(asIScriptGeneric *gen)
+{
+	gen->SetReturnFloat(FractalNoise3((int)gen->GetArgDWord(0), gen->GetArgFloat(1), gen->GetArgFloat(2), gen->GetArgFloat(3), gen->GetArgDWord(4), gen->GetArgDWord(5), gen->GetArgFloat(6), gen->GetArgFloat(7)));
+}
+
+static void NoiseGrid2_Generic(asIScriptGeneric *gen)
+{
+	NoiseGrid2((CScriptArray*)gen->GetArgAddress(0), (int)gen->GetArgDWord(1), gen->GetArgFloat(2), gen->GetArgFloat(3), gen->GetArgFloat(4),
+	           gen->GetArgDWord(5), gen->GetArgDWord(6), gen->GetArgDWord(7), gen->GetArgDWord(8), gen->GetArgFloat(9), gen->GetArgFloat(10));
+}
+
+static void NoiseGrid3_Generic(asIScriptGeneric *gen)
+{
+	NoiseGrid3((CScriptArray*)gen->GetArgAddress(0), (int)gen->GetArgDWord(1), gen->GetArgFloat(2), gen->GetArgFloat(3), gen->GetArgFloat(4), gen->GetArgFloat(5),
+	           gen->GetArgDWord(6), gen->GetArgDWord(7), gen->GetArgDWord(8), gen->GetArgDWord(9), gen->GetArgDWord(10), gen->GetArgFloat(11), gen->GetArgFloat(12));
+}
+
+void RegisterScriptNoise_Generic(asIScriptEngine *engine)
+{
+	int r;
+
+	RegisterNoiseType(engine);
+
+	r = engine->RegisterGlobalFunction("float valueNoise(float, float, uint)", asFUNCTION(ValueNoise2_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float valueNoise(float, float, float, uint)", asFUNCTION(ValueNoise3_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float perlinNoise(float, float, uint)", asFUNCTION(PerlinNoise2_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float perlinNoise(float, float, float, uint)", asFUNCTION(PerlinNoise3_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float simplexNoise(float, float, uint)", asFUNCTION(SimplexNoise2_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float simplexNoise(float, float, float, uint)", asFUNCTION(SimplexNoise3_Generic), asCALL_GENERIC); assert( r >= 0 );
+
+	r = engine->RegisterGlobalFunction("float fractalNoise(noise_type, float, float, uint, uint, float, float)", asFUNCTION(FractalNoise2_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("float fractalNoise(noise_type, float, float, float, uint, uint, float, float)", asFUNCTION(FractalNoise3_Generic), asCALL_GENERIC); assert( r >= 0 );
+
+	r = engine->RegisterGlobalFunction("void noiseGrid(array<float> &inout, noise_type, float, float, float, uint, uint, uint, uint, float, float)", asFUNCTION(NoiseGrid2_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterGlobalFunction("void noiseGrid(array<float> &inout, noise_type, float, float, float, float, uint, uint, uint, uint, uint, float, float)", asFUNCTION(NoiseGrid3_Generic), asCALL_GENERIC); assert( r >= 0 );
+}
+
+void RegisterScriptNoise(asIScriptEngine *engine)
+{
+	if( strstr(asGetLibraryOptions(), "AS_MAX_PORTABILITY") )
+		RegisterScriptNoise_Generic(engine);
+	else
+		RegisterScriptNoise_Native(engine);
+}
+
+END_AS_NAMESPACE
@@ -0,0 +1,30 @@
+#ifndef SCRIPTNOISE_H
+#define SCRIPTNOISE_H
+
+#include <angelscript.h>
+
+BEGIN_AS_NAMESPACE
+
+// Procedural noise for scripts: value, Perlin and simplex noise in 2D
+// and 3D, fractal sums of them, and batch functions that fill an array
+// with the noise of a whole grid of sample points in one call.
+//
+// The noise is roughly in the range [-1, 1], the same coordinates and
+// seed always give the same value, also between the single and batch
+// functions.
+//
+// The batch functions take array<float>, so the array add-on must be
+// registered before calling this function.
+void RegisterScriptNoise(asIScriptEngine *engine);
+
+// Call this function to register the noise functions
+// using native calling conventions
+void RegisterScriptNoise_Native(asIScriptEngine *engine);
+
+// Use this one instead if native calling conventions
+// are not supported on the target platform
+void RegisterScriptNoise_Generic(asIScriptEngine *engine);
+
+END_AS_NAMESPACE
+
+#endif
@@ -0,0 +1,121 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "BatchIntersection.h"
+#include "Vector3Array.h"
+#include "SimdMath.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace Ogre;
+
+// narrows the ray interval [tnear, tfar] to the slab of one axis, a ray parallel to the axis
+// has no interval there, it only misses the boxes whose slab does not contain the origin
+static inline void clipSlab(vfloat lo, vfloat hi, vfloat origin, vfloat inverse, bool parallel, vfloat &tnear, vfloat &tfar, int &mask)
+{
+	if(parallel)
+	{
+		mask &= vmaskge(origin, lo) & vmaskge(hi, origin);
+		return;
+	}
+	vfloat t1 = vmul(vsub(lo, origin), inverse), t2 = vmul(vsub(hi, origin), inverse);
+	tnear = vmax(tnear, vmin(t1, t2));
+	tfar  = vmin(tfar, vmax(t1, t2));
+}
+
+unsigned int intersectRayBoxes(const Ray &ray, const Vector3Array &mins, const Vector3Array &maxs, std::vector<unsigned int> &boxes, std::vector<float> &distances)
+{
+	boxes.clear();
+	distances.clear();
+
+	const Vector3 &origin = ray.getOrigin(), &direction = ray.getDirection();
+	bool px = (direction.x == 0.0f), py = (direction.y == 0.0f), pz = (direction.z == 0.0f);
+	vfloat ox = vset(origin.x), oy = vset(origin.y), oz = vset(origin.z);
+	vfloat ix = vset(px ? 0.0f : 1.0f / direction.x), iy = vset(py ? 0.0f : 1.0f / direction.y), iz = vset(pz ? 0.0f : 1.0f / direction.z);
+	vfloat zero = vset(0.0f), infinity = vset(std::numeric_limits<float>::max());
+	const int allLanes = (1 << SIMD_WIDTH) - 1;
+
+	const float *minx = mins.getX(), *miny = mins.getY(), *minz = mins.getZ();
+	const float *maxx = maxs.getX(), *maxy = maxs.getY(), *maxz = maxs.getZ();
+	unsigned int count = std::min(mins.size(), maxs.size());
+
+	// slab test, the padding behind the last box is tested as well but never reported
+	float near[SIMD_WIDTH];
+	for(unsigned int i = 0; i < count; i += SIMD_WIDTH)
+	{
+		// starting at 0 misses the boxes behind the origin, starting inside a box is a hit at distance 0 like Ray::intersects
+		vfloat tnear = zero, tfar = infinity;
+		int mask = allLanes;
+		clipSlab(vload(minx + i), vload(maxx + i), ox, ix, px, tnear, tfar, mask);
+		clipSlab(vload(miny + i), vload(maxy + i), oy, iy, py, tnear, tfar, mask);
+		clipSlab(vload(minz + i), vload(maxz + i), oz, iz, pz, tnear, tfar, mask);
+		mask &= vmaskge(tfar, tnear);
+		if(!mask) continue;
+
+		vstoreu(near, tnear);
+		for(unsigned int l = 0; l < SIMD_WIDTH && i + l < count; l++)
+		{
+			if(!(mask & (1 << l))) continue;
+			boxes.push_back(i + l);
+			distances.push_back(near[l]);
+		}
+	}
+	return (unsigned int)boxes.size();
+}
+
+unsigned int findPointsInBoxes(const Vector3Array &positions, const Vector3Array &mins, const Vector3Array &maxs, std::vector<unsigned int> &points, std::vector<unsigned int> &boxes)
+{
+	points.clear();
+	boxes.clear();
+
+	const float *px = positions.getX(), *py = positions.getY(), *pz = positions.getZ();
+	unsigned int pointCount = positions.size();
+	unsigned int boxCount = std::min(mins.size(), maxs.size());
+
+	for(unsigned int b = 0; b < boxCount; b++)
+	{
+		Vector3 boxMin = mins.get(b), boxMax = maxs.get(b);
+		vfloat minx = vset(boxMin.x), miny = vset(boxMin.y), minz = vset(boxMin.z);
+		vfloat maxx = vset(boxMax.x), maxy = vset(boxMax.y), maxz = vset(boxMax.z);
+
+		for(unsigned int i = 0; i < pointCount; i += SIMD_WIDTH)
+		{
+			vfloat x = vload(px + i), y = vload(py + i), z = vload(pz + i);
+			int mask = vmaskge(x, minx) & vmaskge(maxx, x) & vmaskge(y, miny) & vmaskge(maxy, y) & vmaskge(z, minz) & vmaskge(maxz, z);
+			if(!mask) continue;
+
+			for(unsigned int l = 0; l < SIMD_WIDTH && i + l < pointCount; l++)
+			{
+				if(!(mask & (1 << l))) continue;
+				points.push_back(i + l);
+				boxes.push_back(b);
+			}
+		}
+	}
+	return (unsigned int)points.size();
+}
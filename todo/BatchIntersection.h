@@ -0,0 +1,60 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef BATCHINTERSECTION_H__
+#define BATCHINTERSECTION_H__
+
+#include "RoRPrerequisites.h"
+
+#include <vector>
+#include <Ogre.h>
+
+class Vector3Array;
+
+/**
+ *  Intersection tests against many boxes in one call. The boxes are packed as two
+ *  Vector3Array with the minimum and maximum corners, so all boxes are tested with
+ *  SIMD kernels, see SimdMath.h. If the two arrays differ in size, the extra elements are ignored.
+ */
+
+/**
+ * intersects a ray with boxes
+ * @param boxes receives the indices of the hit boxes, in ascending order
+ * @param distances receives the distance along the ray to each hit box, 0 if the ray starts inside
+ * @return number of hit boxes
+ */
+unsigned int intersectRayBoxes(const Ogre::Ray &ray, const Vector3Array &mins, const Vector3Array &maxs, std::vector<unsigned int> &boxes, std::vector<float> &distances);
+
+/**
+ * finds the points inside boxes, points on the surface are inside
+ * @param points receives the index of the point of each hit, ordered by box and point
+ * @param boxes receives the index of the box of each hit
+ * @return number of hits, a point inside several boxes is reported for each of them
+ */
+unsigned int findPointsInBoxes(const Vector3Array &positions, const Vector3Array &mins, const Vector3Array &maxs, std::vector<unsigned int> &points, std::vector<unsigned int> &boxes);
+
+#endif //BATCHINTERSECTION_H__
@@ -0,0 +1,268 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "CBytecodeBundle.h"
+#include "LZCompression.h"
+
+#include <string.h>
+#include <algorithm>
+#include <set>
+
+static const char bundleMagic[4] = { 'R', 'S', 'B', 'B' };
+static const unsigned int bundleVersion = 2;
+
+CBytecodeBundle::CBytecodeBundle() : filename(), file(), entries(), lookup()
+{
+}
+
+int CBytecodeBundle::open(const std::string &_filename)
+{
+	close();
+	filename = _filename;
+
+	// no bundle yet, the first append creates it
+	if(file.open(filename)) return 0;
+
+	bundleHeader_t header;
+	bool ok = file.getSize() >= sizeof(header);
+	if(ok)
+	{
+		// copy it out, the mapping gives no alignment guarantee for the 64 bit members
+		memcpy(&header, file.getData(), sizeof(header));
+		ok = !memcmp(header.magic, bundleMagic, 4)
+			&& header.version == bundleVersion
+			&& header.indexOffset >= sizeof(header)
+			&& header.indexOffset <= file.getSize()
+			&& header.count <= (file.getSize() - header.indexOffset) / sizeof(bundleEntry_t);
+	}
+
+	if(ok)
+	{
+		entries.resize((size_t)header.count);
+		if(!entries.empty())
+			memcpy(&entries[0], file.getData() + header.indexOffset, entries.size() * sizeof(bundleEntry_t));
+
+		for(size_t i = 0; i < entries.size() && ok; i++)
+		{
+			const bundleEntry_t &e = entries[i];
+			ok = e.offset >= sizeof(header) && e.length > 0 && e.rawLength > 0
+				&& e.offset <= header.indexOffset && e.length <= header.indexOffset - e.offset;
+			// later entries win
+			lookup[std::make_pair(e.sectionsHash, e.fingerprint)] = i;
+		}
+	}
+
+	if(!ok)
+	{
+		close();
+		return 1;
+	}
+	return 0;
+}
+
+void CBytecodeBundle::close()
+{
+	file.close();
+	entries.clear();
+	lookup.clear();
+}
+
+const bundleEntry_t *CBytecodeBundle::find(AngelScript::asQWORD sectionsHash, AngelScript::asQWORD fingerprint)
+{
+	std::map<std::pair<AngelScript::asQWORD, AngelScript::asQWORD>, size_t>::iterator it = lookup.find(std::make_pair(sectionsHash, fingerprint));
+	if(it == lookup.end()) return 0;
+	return &entries[it->second];
+}
+
+const char *CBytecodeBundle::getBytecode(const bundleEntry_t *entry, std::vector<char> &buffer)
+{
+	if(!entry || !file.getData()) return 0;
+	const char *stored = file.getData() + entry->offset;
+	if(entry->rawLength == entry->length) return stored;
+
+	// the size comes from the file, check it before allocating
+	if(entry->rawLength > (AngelScript::asQWORD)lzMaxDecompressedSize((size_t)entry->length)) return 0;
+	buffer.resize((size_t)entry->rawLength);
+	if(lzDecompress(stored, (size_t)entry->length, &buffer[0], buffer.size())) return 0;
+	return &buffer[0];
+}
+
+int CBytecodeBundle::append(const std::string &name, AngelScript::asQWORD sectionsHash, AngelScript::asQWORD fingerprint, const std::vector<char> &bytecode, bool compress)
+{
+	if(filename.empty() || bytecode.empty()) return 1;
+
+	std::vector<char> packed;
+	if(compress) lzCompress(&bytecode[0], bytecode.size(), packed);
+	const std::vector<char> &data = (compress && packed.size() < bytecode.size()) ? packed : bytecode;
+
+	bundleEntry_t e;
+	e.nameHash     = hashBytecode(name.c_str(), name.size());
+	e.sectionsHash = sectionsHash;
+	e.fingerprint  = fingerprint;
+	e.checksum     = hashBytecode(&bytecode[0], bytecode.size());
+	e.length       = data.size();
+	e.rawLength    = bytecode.size();
+
+	std::vector<bundleEntry_t> index = entries;
+	bool fresh = !file.getData();
+
+	// the mapping must be gone before the file is written
+	size_t end = file.getSize();
+	close();
+
+	if(fresh)
+	{
+		// start a new bundle with an empty index
+		bundleHeader_t header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, bundleMagic, 4);
+		header.version     = bundleVersion;
+		header.indexOffset = sizeof(header);
+		FILE *f = fopen(filename.c_str(), "wb");
+		if(!f) return 1;
+		bool ok = (fwrite(&header, sizeof(header), 1, f) == 1);
+		ok = !fclose(f) && ok;
+		if(!ok) return 1;
+		end = sizeof(header);
+		index.clear();
+	}
+
+	FILE *f = fopen(filename.c_str(), "r+b");
+	if(!f)
+	{
+		open(filename);
+		return 1;
+	}
+
+	// bytecode and the new index go behind everything that exists, the header is switched last
+	e.offset = end;
+	index.push_back(e);
+
+	bundleHeader_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, bundleMagic, 4);
+	header.version     = bundleVersion;
+	header.indexOffset = end + data.size();
+	header.count       = index.size();
+
+	bool ok = !fseek(f, (long)end, SEEK_SET)
+		&& fwrite(&data[0], data.size(), 1, f) == 1
+		&& fwrite(&index[0], index.size() * sizeof(bundleEntry_t), 1, f) == 1
+		&& !fflush(f)
+		&& !fseek(f, 0, SEEK_SET)
+		&& fwrite(&header, sizeof(header), 1, f) == 1;
+	ok = !fclose(f) && ok;
+
+	open(filename);
+	return ok ? 0 : 1;
+}
+
+void CBytecodeBundle::getSectionsHashes(AngelScript::asQWORD fingerprint, std::set<AngelScript::asQWORD> &result)
+{
+	for(size_t i = 0; i < entries.size(); i++)
+		if(entries[i].fingerprint == fingerprint)
+			result.insert(entries[i].sectionsHash);
+}
+
+void CBytecodeBundle::liveEntries(AngelScript::asQWORD fingerprint, std::vector<bundleEntry_t> &result)
+{
+	result.clear();
+	std::set<AngelScript::asQWORD> names;
+	for(size_t i = entries.size(); i > 0; i--)
+	{
+		const bundleEntry_t &e = entries[i - 1];
+		if(fingerprint && e.fingerprint != fingerprint) continue;
+		if(!names.insert(e.nameHash).second) continue;
+		result.push_back(e);
+	}
+	// keep the original order
+	std::reverse(result.begin(), result.end());
+}
+
+size_t CBytecodeBundle::getUnusedSize(AngelScript::asQWORD fingerprint)
+{
+	if(!file.getData()) return 0;
+
+	std::vector<bundleEntry_t> keep;
+	liveEntries(fingerprint, keep);
+
+	size_t used = sizeof(bundleHeader_t) + keep.size() * sizeof(bundleEntry_t);
+	for(size_t i = 0; i < keep.size(); i++)
+		used += (size_t)keep[i].length;
+	return file.getSize() - used;
+}
+
+int CBytecodeBundle::writeBundle(const std::string &fn, const std::vector<bundleEntry_t> &keep)
+{
+	FILE *f = fopen(fn.c_str(), "wb");
+	if(!f) return 1;
+
+	std::vector<bundleEntry_t> index = keep;
+
+	bundleHeader_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, bundleMagic, 4);
+	header.version = bundleVersion;
+	header.count   = index.size();
+
+	bool ok = (fwrite(&header, sizeof(header), 1, f) == 1);
+	AngelScript::asQWORD offset = sizeof(header);
+	for(size_t i = 0; i < index.size() && ok; i++)
+	{
+		ok = (fwrite(file.getData() + index[i].offset, (size_t)index[i].length, 1, f) == 1);
+		index[i].offset = offset;
+		offset += index[i].length;
+	}
+	header.indexOffset = offset;
+
+	if(ok && !index.empty())
+		ok = (fwrite(&index[0], index.size() * sizeof(bundleEntry_t), 1, f) == 1);
+	if(ok)
+		ok = !fseek(f, 0, SEEK_SET) && fwrite(&header, sizeof(header), 1, f) == 1;
+	ok = !fclose(f) && ok;
+
+	if(!ok) remove(fn.c_str());
+	return ok ? 0 : 1;
+}
+
+int CBytecodeBundle::compact(AngelScript::asQWORD fingerprint)
+{
+	if(!file.getData()) return 0;
+
+	std::vector<bundleEntry_t> keep;
+	liveEntries(fingerprint, keep);
+
+	std::string tmp = filename + ".tmp";
+	if(writeBundle(tmp, keep)) return 1;
+
+	// replace the old bundle, it must not be mapped anymore at this point
+	close();
+	remove(filename.c_str());
+	int result = rename(tmp.c_str(), filename.c_str()) ? 1 : 0;
+	open(filename);
+	return result;
+}
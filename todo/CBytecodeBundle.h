@@ -0,0 +1,132 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef CBYTECODEBUNDLE_H__
+#define CBYTECODEBUNDLE_H__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <angelscript.h>
+
+#include "CBytecodeStream.h"
+
+// start of a bundle file, the index is located at the end so modules can be appended
+struct bundleHeader_t
+{
+	char magic[4];                          //!< "RSBB"
+	unsigned int version;                   //!< layout version of the bundle
+	AngelScript::asQWORD indexOffset;       //!< file offset of the index
+	AngelScript::asQWORD count;             //!< number of index entries
+};
+
+// one module in the bundle
+struct bundleEntry_t
+{
+	AngelScript::asQWORD nameHash;          //!< hash of the script name, newer entries replace older ones
+	AngelScript::asQWORD sectionsHash;      //!< hash of the preprocessed script sections
+	AngelScript::asQWORD fingerprint;       //!< hash of the registered application interface
+	AngelScript::asQWORD checksum;          //!< hash of the uncompressed bytecode
+	AngelScript::asQWORD offset;            //!< file offset of the stored data
+	AngelScript::asQWORD length;            //!< size of the stored data
+	AngelScript::asQWORD rawLength;         //!< size of the bytecode, differs from length if the data is compressed
+};
+
+/**
+ *  @brief Many precompiled modules in a single file.
+ *
+ *  The file is mapped once and modules are handed to the engine straight from the mapping.
+ *  Appending writes the bytecode and a new index behind the existing data and only then
+ *  switches the header over, so an interrupted append leaves the old bundle intact.
+ *  Replaced modules and old indices stay in the file until compact() is called.
+ */
+class CBytecodeBundle
+{
+public:
+	CBytecodeBundle();
+
+	/**
+	 * maps a bundle file, a missing file results in an empty bundle
+	 * @return 0 on success, 1 if the file exists but is not a valid bundle
+	 */
+	int open(const std::string &filename);
+	void close();
+
+	/**
+	 * looks up a module
+	 * @return entry of the module or 0 if it is not in the bundle
+	 */
+	const bundleEntry_t *find(AngelScript::asQWORD sectionsHash, AngelScript::asQWORD fingerprint);
+
+	/**
+	 * returns the bytecode of an entry returned by find(), compressed modules are unpacked into the buffer
+	 * @param buffer receives the bytecode of a compressed module
+	 * @return the bytecode, rawLength bytes, valid until the bundle or the buffer is changed, 0 if it is damaged
+	 */
+	const char *getBytecode(const bundleEntry_t *entry, std::vector<char> &buffer);
+
+	/**
+	 * adds a module to the bundle file, the bundle is mapped again afterwards
+	 * @param name script name, an older module of the same name is replaced
+	 * @param compress store the bytecode compressed if that saves space
+	 * @return 0 on success
+	 */
+	int append(const std::string &name, AngelScript::asQWORD sectionsHash, AngelScript::asQWORD fingerprint, const std::vector<char> &bytecode, bool compress = false);
+
+	/**
+	 * rewrites the bundle with only the newest module per script name
+	 * @param fingerprint modules built against another interface are dropped, 0 keeps them
+	 * @return 0 on success
+	 */
+	int compact(AngelScript::asQWORD fingerprint);
+
+	/**
+	 * @return bytes of the file that compact() would free
+	 */
+	size_t getUnusedSize(AngelScript::asQWORD fingerprint);
+
+	size_t getFileSize() { return file.getSize(); };
+	unsigned int getModuleCount() { return (unsigned int)entries.size(); };
+	const bundleEntry_t *getEntry(unsigned int i) { return i < entries.size() ? &entries[i] : 0; };
+
+	/**
+	 * collects the sections hashes of all modules built against an interface
+	 */
+	void getSectionsHashes(AngelScript::asQWORD fingerprint, std::set<AngelScript::asQWORD> &result);
+
+protected:
+	std::string filename;
+	CMappedFile file;
+	std::vector<bundleEntry_t> entries;     //!< index of the mapped file
+	std::map<std::pair<AngelScript::asQWORD, AngelScript::asQWORD>, size_t> lookup; //!< sections hash and fingerprint -> newest entry
+
+	int writeBundle(const std::string &fn, const std::vector<bundleEntry_t> &keep);
+	void liveEntries(AngelScript::asQWORD fingerprint, std::vector<bundleEntry_t> &result);
+};
+
+#endif //CBYTECODEBUNDLE_H__
@@ -26,31 +26,237 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "CBytecodeStream.h"
+#include "LZCompression.h"
 
-CBytecodeStream::CBytecodeStream(std::string filename) : f(0)
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif //_WIN32
+
+static const char bytecodeMagic[4] = { 'R', 'S', 'B', 'C' };
+static const unsigned int bytecodeVersion = 2;
+
+AngelScript::asQWORD hashBytecode(const void *data, size_t size, AngelScript::asQWORD hash)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	for(size_t i = 0; i < size; i++)
+	{
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+CMappedFile::CMappedFile() : data(0), size(0)
+#ifdef _WIN32
+	, file(INVALID_HANDLE_VALUE), mapping(0)
+#endif //_WIN32
+{
+}
+
+CMappedFile::~CMappedFile()
+{
+	close();
+}
+
+int CMappedFile::open(const std::string &filename)
 {
-	f = fopen(filename.c_str(), "wb");
+	close();
+#ifdef _WIN32
+	file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(file == INVALID_HANDLE_VALUE) return 1;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return 1;
+	}
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(!mapping)
+	{
+		close();
+		return 1;
+	}
+
+	data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(!data)
+	{
+		close();
+		return 1;
+	}
+	size = (size_t)fileSize.QuadPart;
+#else
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd < 0) return 1;
+
+	struct stat st;
+	if(fstat(fd, &st) || st.st_size == 0)
+	{
+		::close(fd);
+		return 1;
+	}
+
+	void *p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+	if(p == MAP_FAILED) return 1;
+
+	data = (const char *)p;
+	size = (size_t)st.st_size;
+#endif //_WIN32
+	return 0;
 }
 
-CBytecodeStream::~CBytecodeStream()
+void CMappedFile::close()
 {
-	if(f)
-		fclose(f);
+#ifdef _WIN32
+	if(data) UnmapViewOfFile(data);
+	if(mapping) CloseHandle(mapping);
+	if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	mapping = 0;
+	file    = INVALID_HANDLE_VALUE;
+#else
+	if(data) munmap((void *)data, size);
+#endif //_WIN32
+	data = 0;
+	size = 0;
+}
+
+CBytecodeStream::CBytecodeStream(std::string _filename, AngelScript::asQWORD sectionsHash, AngelScript::asQWORD fingerprint, bool _compress) : filename(_filename), buffer(), compress(_compress)
+{
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, bytecodeMagic, 4);
+	header.version      = bytecodeVersion;
+	header.sectionsHash = sectionsHash;
+	header.fingerprint  = fingerprint;
+
+	// most modules fit without growing the buffer
+	buffer.reserve(64 * 1024);
 }
 
 void CBytecodeStream::Write(const void *ptr, AngelScript::asUINT size)
 {
-	if(!f) return;
-	fwrite(ptr, size, 1, f);
+	if(!size) return;
+	const char *p = (const char *)ptr;
+	buffer.insert(buffer.end(), p, p + size);
 }
 
 void CBytecodeStream::Read(void *ptr, AngelScript::asUINT size)
 {
-	if(!f) return;
-	fread(ptr, size, 1, f);
+	// write only
+}
+
+int CBytecodeStream::Finish()
+{
+	if(buffer.empty()) return 1;
+
+	header.rawSize  = (unsigned int)buffer.size();
+	header.checksum = hashBytecode(&buffer[0], buffer.size());
+
+	std::vector<char> packed;
+	if(compress) lzCompress(&buffer[0], buffer.size(), packed);
+	const std::vector<char> &out = (compress && packed.size() < buffer.size()) ? packed : buffer;
+	header.size = (unsigned int)out.size();
+
+	FILE *f = fopen(filename.c_str(), "wb");
+	if(!f) return 1;
+
+	bool ok = (fwrite(&header, sizeof(header), 1, f) == 1) && (fwrite(&out[0], out.size(), 1, f) == 1);
+	ok = !fclose(f) && ok;
+	if(!ok)
+	{
+		remove(filename.c_str());
+		return 1;
+	}
+	return 0;
+}
+
+CBytecodeReadStream::CBytecodeReadStream(std::string filename, AngelScript::asQWORD sectionsHash, AngelScript::asQWORD fingerprint) : file(), unpacked(), data(0), size(0), pos(0), valid(false), failed(false)
+{
+	if(file.open(filename)) return;
+	if(file.getSize() < sizeof(bytecodeHeader_t)) return;
+
+	// copy it out, the mapping gives no alignment guarantee for the 64 bit members
+	bytecodeHeader_t header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	bool ok = !memcmp(header.magic, bytecodeMagic, 4)
+		&& header.version == bytecodeVersion
+		&& header.sectionsHash == sectionsHash
+		&& header.fingerprint == fingerprint
+		&& header.size > 0
+		&& header.size == file.getSize() - sizeof(header);
+
+	if(ok)
+	{
+		data = file.getData() + sizeof(header);
+		size = header.size;
+		if(header.rawSize != header.size)
+		{
+			// the size comes from the file, check it before allocating
+			ok = header.rawSize > 0 && header.rawSize <= lzMaxDecompressedSize(size);
+			if(ok)
+			{
+				unpacked.resize(header.rawSize);
+				ok = !lzDecompress(data, size, &unpacked[0], unpacked.size());
+			}
+			data = unpacked.empty() ? 0 : &unpacked[0];
+			size = unpacked.size();
+		}
+	}
+
+	// a truncated or modified file must never reach the engine
+	ok = ok && hashBytecode(data, size) == header.checksum;
+	if(!ok)
+	{
+		file.close();
+		unpacked.clear();
+		data = 0;
+		size = 0;
+		return;
+	}
+	valid = true;
+}
+
+CBytecodeReadStream::CBytecodeReadStream(const char *_data, size_t _size, AngelScript::asQWORD checksum) : file(), unpacked(), data(0), size(0), pos(0), valid(false), failed(false)
+{
+	if(!_data || !_size || hashBytecode(_data, _size) != checksum) return;
+	data  = _data;
+	size  = _size;
+	valid = true;
+}
+
+void CBytecodeReadStream::Read(void *ptr, AngelScript::asUINT len)
+{
+	if(len > size - pos)
+	{
+		memset(ptr, 0, len);
+		failed = true;
+		return;
+	}
+	memcpy(ptr, data + pos, len);
+	pos += len;
+}
+
+void CBytecodeReadStream::Write(const void *ptr, AngelScript::asUINT size)
+{
+	// read only
+}
+
+bool CBytecodeReadStream::IsValid()
+{
+	return valid;
 }
 
-bool CBytecodeStream::Existing()
+bool CBytecodeReadStream::Failed()
 {
-	return (f != 0);
+	return failed;
 }
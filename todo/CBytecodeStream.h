@@ -28,22 +28,115 @@ THE SOFTWARE.
 #ifndef CBYTECODEESTREAM_H__
 #define CBYTECODEESTREAM_H__
 
-#include "RoRPrerequisites.h"
-
+// no game or Ogre dependencies, the offline script compiler uses these streams as well
 #include <string>
+#include <vector>
+#include <stdio.h>
 #include <angelscript.h>
-#include <Ogre.h>
 
+// header in front of every cached module, it is checked before the bytecode is handed to the engine
+struct bytecodeHeader_t
+{
+	char magic[4];                          //!< "RSBC"
+	unsigned int version;                   //!< layout version of the header
+	AngelScript::asQWORD sectionsHash;      //!< hash of the preprocessed script sections
+	AngelScript::asQWORD fingerprint;       //!< hash of the registered application interface
+	unsigned int size;                      //!< size of the data following the header
+	unsigned int rawSize;                   //!< size of the bytecode, differs from size if the data is compressed
+	AngelScript::asQWORD checksum;          //!< hash of the uncompressed bytecode
+};
+
+// read only view of a whole file mapped into memory
+class CMappedFile
+{
+public:
+	CMappedFile();
+	~CMappedFile();
+
+	/**
+	 * maps the file, a previously mapped file is closed
+	 * @return 0 on success
+	 */
+	int open(const std::string &filename);
+	void close();
+
+	const char *getData() { return data; };
+	size_t getSize() { return size; };
+private:
+	const char *data;
+	size_t size;
+#ifdef _WIN32
+	void *file;
+	void *mapping;
+#endif //_WIN32
+
+	// not copyable, the mapping is owned
+	CMappedFile(const CMappedFile &);
+	CMappedFile &operator=(const CMappedFile &);
+};
+
+// collects the bytecode of a module in memory and writes it together with a header in one go
 class CBytecodeStream : public AngelScript::asIBinaryStream
 {
 public:
-	CBytecodeStream(std::string filename);
-	~CBytecodeStream();
+	/**
+	 * @param compress compress the bytecode when it is written, it is only stored compressed if that saves space
+	 */
+	CBytecodeStream(std::string filename, AngelScript::asQWORD sectionsHash, AngelScript::asQWORD fingerprint, bool compress = false);
 	void Read(void *ptr, AngelScript::asUINT size);
 	void Write(const void *ptr, AngelScript::asUINT size);
-	bool Existing();
+
+	/**
+	 * writes the header and the collected bytecode to the file, needs to be called after the module was saved
+	 * @return 0 on success, on failure no partial file is left behind
+	 */
+	int Finish();
+
+	/**
+	 * @return the bytecode collected so far, used to add the module to a bundle instead of a file
+	 */
+	const std::vector<char> &getBytecode() { return buffer; };
+private:
+	std::string filename;
+	std::vector<char> buffer;
+	bytecodeHeader_t header;
+	bool compress;
+};
+
+// reads and validates a file written by CBytecodeStream, the bytecode is served from the mapped file
+class CBytecodeReadStream : public AngelScript::asIBinaryStream
+{
+public:
+	CBytecodeReadStream(std::string filename, AngelScript::asQWORD sectionsHash, AngelScript::asQWORD fingerprint);
+
+	/**
+	 * reads bytecode that is already in memory, for example a module of a mapped bundle
+	 * @param checksum expected hash of the bytecode, the stream is invalid if it does not match
+	 */
+	CBytecodeReadStream(const char *data, size_t size, AngelScript::asQWORD checksum);
+	void Read(void *ptr, AngelScript::asUINT size);
+	void Write(const void *ptr, AngelScript::asUINT size);
+
+	/**
+	 * @return true if the file exists and its header and checksum match
+	 */
+	bool IsValid();
+
+	/**
+	 * @return true if the engine tried to read past the end of the bytecode
+	 */
+	bool Failed();
 private:
-	FILE *f;
+	CMappedFile file;
+	std::vector<char> unpacked;             //!< decompressed bytecode of a compressed file
+	const char *data;                       //!< bytecode, points into the mapping or to the decompressed data
+	size_t size;
+	size_t pos;
+	bool valid;
+	bool failed;
 };
 
-#endif //CBYTECODEESTREAM_H__
\ No newline at end of file
+// hash used for the sections and the bytecode checksum (FNV-1a 64 bit)
+AngelScript::asQWORD hashBytecode(const void *data, size_t size, AngelScript::asQWORD hash = 14695981039346656037ULL);
+
+#endif //CBYTECODEESTREAM_H__
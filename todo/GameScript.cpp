@@ -63,6 +63,7 @@ THE SOFTWARE.
 #include "collisions.h"
 #include "RoRVersion.h"
 #include "engine.h"
+#include "ScriptComponents.h"
 
 /* class that implements the interface for the scripts */
 GameScript::GameScript(ScriptEngine *se, RoRFrameListener *efl) : mse(se), mefl(efl)
@@ -265,6 +266,7 @@ void GameScript::removeVehicle(string &instance, string &box)
 
 void GameScript::destroyObject(const std::string &instanceName)
 {
+	if(mse && mse->getComponents()) mse->getComponents()->removeInstance(instanceName);
 	mefl->unloadObject(const_cast<char*>(instanceName.c_str()));
 }
 
@@ -285,6 +287,94 @@ void GameScript::spawnObject(const std::string &objectName, const std::string &i
 	// trying to create the new object
 	SceneNode *bakeNode=mefl->getSceneMgr()->getRootSceneNode()->createChildSceneNode();
 	mefl->loadObject(const_cast<char*>(objectName.c_str()), pos.x, pos.y, pos.z, rot.x, rot.y, rot.z, bakeNode, const_cast<char*>(instanceName.c_str()), true, functionPtr, const_cast<char*>(objectName.c_str()), uniquifyMaterials);
+
+	// remember where it is, so its components can be updated by distance
+	if(mse && mse->getComponents()) mse->getComponents()->setInstancePosition(instanceName, pos);
+}
+
+int GameScript::attachComponent(const std::string &instanceName, const std::string &functionName)
+{
+	if(!mse || !mse->getComponents()) return -1;
+	AngelScript::asIScriptModule *mod = mse->getEngine()->GetModule(mse->moduleName, AngelScript::asGM_ONLY_IF_EXISTS);
+	if(!mod) return -1;
+
+	// look it up by its full declaration, so a function with the wrong signature is rejected right away
+	String decl = "void " + functionName + "(const string &in, float)";
+	int functionPtr = mod->GetFunctionIdByDecl(decl.c_str());
+	if(functionPtr < 0)
+	{
+		SLOG("attachComponent(): function '" + decl + "' not found");
+		return functionPtr;
+	}
+	return mse->getComponents()->attach(functionPtr, instanceName);
+}
+
+void GameScript::detachComponent(int componentId)
+{
+	if(mse && mse->getComponents()) mse->getComponents()->detach(componentId);
+}
+
+void GameScript::detachComponents(const std::string &instanceName)
+{
+	if(mse && mse->getComponents()) mse->getComponents()->detachAll(instanceName);
+}
+
+void GameScript::logComponentStatistics()
+{
+	if(mse && mse->getComponents()) mse->getComponents()->logStatistics();
+}
+
+int GameScript::saveScriptState(const std::string &name)
+{
+	if(!mse) return 1;
+	return mse->saveState(name);
+}
+
+int GameScript::loadScriptState(const std::string &name)
+{
+	if(!mse) return 1;
+	return mse->loadState(name);
+}
+
+int GameScript::resetScriptState()
+{
+	if(!mse) return 1;
+	return mse->resetScript();
+}
+
+void GameScript::reloadChangedScripts()
+{
+	if(mse) mse->requestScriptReload();
+}
+
+Ogre::String GameScript::getCallingModuleName()
+{
+	// the module of the script function that called us
+	AngelScript::asIScriptContext *ctx = AngelScript::asGetActiveContext();
+	if(ctx && ctx->GetFunction(0) && ctx->GetFunction(0)->GetModuleName())
+		return String(ctx->GetFunction(0)->GetModuleName());
+	return String(mse->moduleName);
+}
+
+void GameScript::setScriptTickRate(float hz)
+{
+	if(mse) mse->setTickRate(getCallingModuleName(), hz);
+}
+
+float GameScript::getScriptTickRate()
+{
+	if(mse) return mse->getTickRate(getCallingModuleName());
+	return 0;
+}
+
+void GameScript::setComponentPosition(const std::string &instanceName, Ogre::Vector3 pos)
+{
+	if(mse && mse->getComponents()) mse->getComponents()->setInstancePosition(instanceName, pos);
+}
+
+void GameScript::setComponentLod(float nearDistance, float farDistance, int midInterval)
+{
+	if(mse && mse->getComponents()) mse->getComponents()->setLodDistances(nearDistance, farDistance, midInterval);
 }
 
 void GameScript::hideDirectionArrow()
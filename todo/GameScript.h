@@ -272,6 +272,87 @@ public:
 	Ogre::Vector3 getPersonPosition();
 
 	void clearEventCache();
+
+	/**
+	 * attaches an update behaviour to an object. All objects sharing the same
+	 * update function are updated in one batch after frameStep.
+	 * @param instanceName name of the object instance, passed to the update function
+	 * @param functionName name of the update function, signature: void f(const string &in instanceName, float dt)
+	 * @return component id (>0) on success, negative value on error
+	 */
+	int attachComponent(const std::string &instanceName, const std::string &functionName);
+
+	/**
+	 * removes a single component
+	 * @param componentId id returned by attachComponent
+	 */
+	void detachComponent(int componentId);
+
+	/**
+	 * removes all components of an object instance
+	 * @param instanceName name of the object instance
+	 */
+	void detachComponents(const std::string &instanceName);
+
+	/**
+	 * writes the per-component update costs to the script log
+	 */
+	void logComponentStatistics();
+
+	/**
+	 * updates the position of an object instance, components far away from the camera are updated less often
+	 * @param instanceName name of the object instance
+	 * @param pos world position of the object
+	 */
+	void setComponentPosition(const std::string &instanceName, Ogre::Vector3 pos);
+
+	/**
+	 * sets the distance bands for the component updates
+	 * @param nearDistance up to this distance components are updated every frame, 0 disables the level of detail
+	 * @param farDistance beyond this distance components are suspended, 0 to never suspend them
+	 * @param midInterval components in between are updated every midInterval frames
+	 */
+	void setComponentLod(float nearDistance, float farDistance, int midInterval);
+
+	/**
+	 * stores all global script variables in a binary snapshot
+	 * @param name name of the snapshot
+	 * @return 0 on success
+	 */
+	int saveScriptState(const std::string &name);
+
+	/**
+	 * restores all global script variables from a snapshot
+	 * @param name name of the snapshot
+	 * @return 0 on success
+	 */
+	int loadScriptState(const std::string &name);
+
+	/**
+	 * puts all global script variables back into the state they had after main() finished
+	 * @return 0 on success
+	 */
+	int resetScriptState();
+
+	/**
+	 * rebuilds the script modules whose files changed at the start of the next frame
+	 */
+	void reloadChangedScripts();
+
+	/**
+	 * sets the fixed update rate of the calling script module
+	 * @param hz frameStep calls per second, 0 to call it once per rendered frame
+	 */
+	void setScriptTickRate(float hz);
+
+	/**
+	 * returns the update rate of the calling script module
+	 * @return frameStep calls per second, 0 if it is called once per rendered frame
+	 */
+	float getScriptTickRate();
+
+protected:
+	Ogre::String getCallingModuleName();
 };
 
 #endif // GAMESCRIPT_H__
@@ -0,0 +1,321 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "KeyframeTrack.h"
+#include "Vector3Array.h"
+#include "SimdMath.h"
+
+#include <algorithm>
+
+using namespace Ogre;
+
+// arc cosine for -1 <= x <= 1, Abramowitz and Stegun 4.4.46
+// the series is good to 2e-8, evaluated in float the measured error is below 5e-7 radians
+static inline vfloat vacos(vfloat x)
+{
+	vfloat zero = vset(0.0f), one = vset(1.0f);
+	vfloat ax = vmin(vmax(x, vsub(zero, x)), one);
+	vfloat p = vset(-0.0012624911f);
+	p = vadd(vmul(p, ax), vset(0.0066700901f));
+	p = vadd(vmul(p, ax), vset(-0.0170881256f));
+	p = vadd(vmul(p, ax), vset(0.0308918810f));
+	p = vadd(vmul(p, ax), vset(-0.0501743046f));
+	p = vadd(vmul(p, ax), vset(0.0889789874f));
+	p = vadd(vmul(p, ax), vset(-0.2145988016f));
+	p = vadd(vmul(p, ax), vset(1.5707963050f));
+	vfloat r = vmul(vsqrt(vsub(one, ax)), p);
+	return vselectgt(zero, x, vsub(vset(Math::PI), r), r);
+}
+
+// sine for 0 <= x <= pi
+static inline vfloat vsin(vfloat x)
+{
+	// fold into [0, pi/2], where the series is accurate enough
+	x = vmin(x, vsub(vset(Math::PI), x));
+	vfloat x2 = vmul(x, x);
+	vfloat p = vset(-2.5052108e-8f);
+	p = vadd(vmul(p, x2), vset(2.7557319e-6f));
+	p = vadd(vmul(p, x2), vset(-1.9841270e-4f));
+	p = vadd(vmul(p, x2), vset(8.3333333e-3f));
+	p = vadd(vmul(p, x2), vset(-1.6666667e-1f));
+	p = vadd(vmul(p, x2), vset(1.0f));
+	return vmul(p, x);
+}
+
+// KeyframeTrack
+KeyframeTrack::KeyframeTrack() : times(), rotations(), positions(), tangents(), lastKey(0)
+{
+}
+
+void KeyframeTrack::addKey(float time, const Quaternion &rotation, const Vector3 &position)
+{
+	std::vector<float>::iterator it = std::lower_bound(times.begin(), times.end(), time);
+	size_t i = it - times.begin();
+	if(it != times.end() && *it == time)
+	{
+		rotations[i] = rotation;
+		positions[i] = position;
+	} else
+	{
+		times.insert(it, time);
+		rotations.insert(rotations.begin() + i, rotation);
+		positions.insert(positions.begin() + i, position);
+	}
+	tangents.clear();
+	lastKey = 0;
+}
+
+void KeyframeTrack::clear()
+{
+	times.clear();
+	rotations.clear();
+	positions.clear();
+	tangents.clear();
+	lastKey = 0;
+}
+
+float KeyframeTrack::findKeys(float time, unsigned int &key, unsigned int &next) const
+{
+	unsigned int count = (unsigned int)times.size();
+	// NaN fails every comparison below and would read past the last key, infinite times are treated the same
+	bool finite = (time - time == 0.0f);
+	if(count < 2 || !finite || time <= times[0])
+	{
+		key = next = 0;
+		return 0.0f;
+	}
+	if(time >= times[count - 1])
+	{
+		key = next = count - 1;
+		return 0.0f;
+	}
+
+	// check the keys found last time and the ones after them before searching
+	unsigned int k = lastKey;
+	if(!(k + 1 < count && times[k] <= time && time < times[k + 1]))
+	{
+		if(k + 2 < count && times[k + 1] <= time && time < times[k + 2])
+			k++;
+		else
+			k = (unsigned int)(std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+	}
+	lastKey = k;
+
+	key  = k;
+	next = k + 1;
+	return (time - times[k]) / (times[k + 1] - times[k]);
+}
+
+const Quaternion &KeyframeTrack::getTangent(unsigned int key) const
+{
+	if(tangents.size() != rotations.size())
+	{
+		// same control points as Ogre::RotationalSpline, the first and last key use themselves as missing neighbour
+		unsigned int count = (unsigned int)rotations.size();
+		tangents.resize(count);
+		for(unsigned int i = 0; i < count; i++)
+		{
+			const Quaternion &p = rotations[i];
+			Quaternion invp = p.Inverse();
+			Quaternion part1 = (invp * rotations[std::min(i + 1, count - 1)]).Log();
+			Quaternion part2 = (invp * rotations[i > 0 ? i - 1 : 0]).Log();
+			Quaternion preExp = (part1 + part2) * -0.25f;
+			tangents[i] = p * preExp.Exp();
+		}
+	}
+	return tangents[key];
+}
+
+void KeyframeTrack::sample(float time, InterpolationMode mode, Quaternion &rotation, Vector3 &position) const
+{
+	if(times.empty())
+	{
+		rotation = Quaternion::IDENTITY;
+		position = Vector3::ZERO;
+		return;
+	}
+
+	unsigned int key, next;
+	float t = findKeys(time, key, next);
+	position = positions[key] + (positions[next] - positions[key]) * t;
+	if(mode == INTERPOLATE_NLERP)
+		rotation = Quaternion::nlerp(t, rotations[key], rotations[next], true);
+	else if(mode == INTERPOLATE_SLERP)
+		rotation = Quaternion::Slerp(t, rotations[key], rotations[next], true);
+	else
+		rotation = Quaternion::Squad(t, rotations[key], getTangent(key), getTangent(next), rotations[next], true);
+}
+
+// AnimationSampler
+AnimationSampler::AnimationSampler() : tracks()
+{
+}
+
+unsigned int AnimationSampler::addTrack(const KeyframeTrack &track)
+{
+	tracks.push_back(track);
+	return (unsigned int)tracks.size() - 1;
+}
+
+void AnimationSampler::sample(float time, InterpolationMode mode, Quaternion *rotations, Vector3Array &positions)
+{
+	unsigned int count = (unsigned int)tracks.size();
+	positions.resize(count);
+	if(!count || positions.size() != count) return;
+
+	// the batches are padded to full vectors, the padding interpolates identities
+	unsigned int n = (count + SIMD_WIDTH - 1) & ~(SIMD_WIDTH - 1);
+	bool squad = (mode == INTERPOLATE_SQUAD);
+	weights.resize(n);
+	p.resize(n);
+	q.resize(n);
+	result.resize(n);
+	if(squad)
+	{
+		squadWeights.resize(n);
+		a.resize(n);
+		b.resize(n);
+		tmp0.resize(n);
+		tmp1.resize(n);
+	}
+
+	// gather the keys around the time from all tracks, the positions are interpolated right away
+	for(unsigned int i = 0; i < n; i++)
+	{
+		if(i >= count || !tracks[i].getKeyCount())
+		{
+			weights[i] = 0.0f;
+			p.set(i, Quaternion::IDENTITY);
+			q.set(i, Quaternion::IDENTITY);
+			if(squad)
+			{
+				a.set(i, Quaternion::IDENTITY);
+				b.set(i, Quaternion::IDENTITY);
+			}
+			if(i < count) positions.set(i, Vector3::ZERO);
+			continue;
+		}
+
+		const KeyframeTrack &track = tracks[i];
+		unsigned int key, next;
+		float t = track.findKeys(time, key, next);
+		weights[i] = t;
+		p.set(i, track.getRotation(key));
+		q.set(i, track.getRotation(next));
+		if(squad)
+		{
+			a.set(i, track.getTangent(key));
+			b.set(i, track.getTangent(next));
+		}
+		const Vector3 &p0 = track.getPosition(key);
+		positions.set(i, p0 + (track.getPosition(next) - p0) * t);
+	}
+
+	if(mode == INTERPOLATE_NLERP)
+		nlerp(n, &weights[0], p, q, result);
+	else if(mode == INTERPOLATE_SLERP)
+		slerp(n, &weights[0], p, q, result, true);
+	else
+	{
+		// same as Quaternion::Squad
+		slerp(n, &weights[0], p, q, tmp0, true);
+		slerp(n, &weights[0], a, b, tmp1, false);
+		for(unsigned int i = 0; i < n; i++)
+			squadWeights[i] = 2.0f * weights[i] * (1.0f - weights[i]);
+		slerp(n, &squadWeights[0], tmp0, tmp1, result, false);
+	}
+
+	for(unsigned int i = 0; i < count; i++)
+		rotations[i] = Quaternion(result.w[i], result.x[i], result.y[i], result.z[i]);
+}
+
+// same as Quaternion::nlerp with the shortest path
+void AnimationSampler::nlerp(unsigned int n, const float *t, const QuaternionBatch &p, const QuaternionBatch &q, QuaternionBatch &out)
+{
+	vfloat zero = vset(0.0f), one = vset(1.0f), minusOne = vset(-1.0f);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vfloat vt = vloadu(t + i);
+		vfloat pw = vloadu(&p.w[i]), px = vloadu(&p.x[i]), py = vloadu(&p.y[i]), pz = vloadu(&p.z[i]);
+		vfloat qw = vloadu(&q.w[i]), qx = vloadu(&q.x[i]), qy = vloadu(&q.y[i]), qz = vloadu(&q.z[i]);
+
+		vfloat cos = vadd(vadd(vmul(pw, qw), vmul(px, qx)), vadd(vmul(py, qy), vmul(pz, qz)));
+		vfloat sign = vselectgt(zero, cos, minusOne, one);
+		vfloat rw = vadd(pw, vmul(vt, vsub(vmul(qw, sign), pw)));
+		vfloat rx = vadd(px, vmul(vt, vsub(vmul(qx, sign), px)));
+		vfloat ry = vadd(py, vmul(vt, vsub(vmul(qy, sign), py)));
+		vfloat rz = vadd(pz, vmul(vt, vsub(vmul(qz, sign), pz)));
+
+		vfloat inv = vdiv(one, vsqrt(vadd(vadd(vmul(rw, rw), vmul(rx, rx)), vadd(vmul(ry, ry), vmul(rz, rz)))));
+		vstoreu(&out.w[i], vmul(rw, inv));
+		vstoreu(&out.x[i], vmul(rx, inv));
+		vstoreu(&out.y[i], vmul(ry, inv));
+		vstoreu(&out.z[i], vmul(rz, inv));
+	}
+}
+
+// same as Quaternion::Slerp
+void AnimationSampler::slerp(unsigned int n, const float *t, const QuaternionBatch &p, const QuaternionBatch &q, QuaternionBatch &out, bool shortestPath)
+{
+	vfloat zero = vset(0.0f), one = vset(1.0f), minusOne = vset(-1.0f);
+	vfloat linear = vset(1.0f - 1e-03f);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vfloat vt = vloadu(t + i);
+		vfloat pw = vloadu(&p.w[i]), px = vloadu(&p.x[i]), py = vloadu(&p.y[i]), pz = vloadu(&p.z[i]);
+		vfloat qw = vloadu(&q.w[i]), qx = vloadu(&q.x[i]), qy = vloadu(&q.y[i]), qz = vloadu(&q.z[i]);
+
+		vfloat cos = vadd(vadd(vmul(pw, qw), vmul(px, qx)), vadd(vmul(py, qy), vmul(pz, qz)));
+		if(shortestPath)
+		{
+			vfloat sign = vselectgt(zero, cos, minusOne, one);
+			qw = vmul(qw, sign); qx = vmul(qx, sign); qy = vmul(qy, sign); qz = vmul(qz, sign);
+			cos = vmul(cos, sign);
+		}
+
+		vfloat angle = vacos(cos);
+		vfloat invSin = vdiv(one, vsqrt(vsub(one, vmul(cos, cos))));
+		vfloat c0 = vmul(vsin(vmul(vsub(one, vt), angle)), invSin);
+		vfloat c1 = vmul(vsin(vmul(vt, angle)), invSin);
+
+		// nearly parallel rotations are interpolated linearly and normalised, the other lanes are already normalised
+		vfloat spherical = vselectgt(linear, vmax(cos, vsub(zero, cos)), one, zero);
+		c0 = vselectgt(spherical, zero, c0, vsub(one, vt));
+		c1 = vselectgt(spherical, zero, c1, vt);
+		vfloat rw = vadd(vmul(pw, c0), vmul(qw, c1));
+		vfloat rx = vadd(vmul(px, c0), vmul(qx, c1));
+		vfloat ry = vadd(vmul(py, c0), vmul(qy, c1));
+		vfloat rz = vadd(vmul(pz, c0), vmul(qz, c1));
+		vfloat inv = vdiv(one, vsqrt(vadd(vadd(vmul(rw, rw), vmul(rx, rx)), vadd(vmul(ry, ry), vmul(rz, rz)))));
+		inv = vselectgt(spherical, zero, one, inv);
+
+		vstoreu(&out.w[i], vmul(rw, inv));
+		vstoreu(&out.x[i], vmul(rx, inv));
+		vstoreu(&out.y[i], vmul(ry, inv));
+		vstoreu(&out.z[i], vmul(rz, inv));
+	}
+}
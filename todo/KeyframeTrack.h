@@ -0,0 +1,144 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef KEYFRAMETRACK_H__
+#define KEYFRAMETRACK_H__
+
+#include "RoRPrerequisites.h"
+
+#include <vector>
+#include <Ogre.h>
+
+class Vector3Array;
+
+enum InterpolationMode
+{
+	INTERPOLATE_NLERP,  //!< normalised linear interpolation, fastest
+	INTERPOLATE_SLERP,  //!< spherical linear interpolation, constant angular velocity
+	INTERPOLATE_SQUAD   //!< spherical cubic interpolation, smooth over the keys
+};
+
+/**
+ *  @brief Time sorted rotation and position keys of one animated object.
+ *
+ *  Rotations are interpolated with the chosen mode and always take the shortest path,
+ *  positions are interpolated linearly. Sampling before the first or after the last key
+ *  returns that key.
+ */
+class KeyframeTrack
+{
+public:
+	KeyframeTrack();
+
+	/**
+	 * adds a key, keys can be added in any order. A key at the time of an existing key replaces it.
+	 */
+	void addKey(float time, const Ogre::Quaternion &rotation, const Ogre::Vector3 &position);
+	void clear();
+
+	unsigned int getKeyCount() const { return (unsigned int)times.size(); };
+
+	/**
+	 * @return the time of the last key
+	 */
+	float getLength() const { return times.empty() ? 0.0f : times.back(); };
+
+	/**
+	 * samples the track at a single time
+	 */
+	void sample(float time, InterpolationMode mode, Ogre::Quaternion &rotation, Ogre::Vector3 &position) const;
+
+	/**
+	 * finds the keys around a time
+	 * @param key receives the index of the key before the time
+	 * @param next receives the index of the key after the time
+	 * @return position of the time between both keys, 0 to 1
+	 */
+	float findKeys(float time, unsigned int &key, unsigned int &next) const;
+
+	const Ogre::Quaternion &getRotation(unsigned int key) const { return rotations[key]; };
+	const Ogre::Vector3 &getPosition(unsigned int key) const { return positions[key]; };
+
+	/**
+	 * @return the squad control point of a key, see Quaternion::Squad
+	 */
+	const Ogre::Quaternion &getTangent(unsigned int key) const;
+
+protected:
+	std::vector<float> times;
+	std::vector<Ogre::Quaternion> rotations;
+	std::vector<Ogre::Vector3> positions;
+	mutable std::vector<Ogre::Quaternion> tangents;  //!< calculated when needed, empty if the keys changed
+	mutable unsigned int lastKey;                     //!< key found by the last search, playback is usually sequential
+};
+
+/**
+ *  @brief Samples many keyframe tracks at the same time.
+ *
+ *  The keys around the sample time are gathered from all tracks into packed arrays and the
+ *  rotations of all tracks are then interpolated together with SIMD kernels, see SimdMath.h
+ */
+class AnimationSampler
+{
+public:
+	AnimationSampler();
+
+	/**
+	 * @return index of the added track
+	 */
+	unsigned int addTrack(const KeyframeTrack &track);
+	void setTrack(unsigned int index, const KeyframeTrack &track) { tracks[index] = track; };
+	unsigned int getTrackCount() const { return (unsigned int)tracks.size(); };
+	void clear() { tracks.clear(); };
+
+	/**
+	 * samples all tracks at the same time
+	 * @param rotations receives getTrackCount() rotations, packed as w, x, y, z
+	 * @param positions receives getTrackCount() positions
+	 */
+	void sample(float time, InterpolationMode mode, Ogre::Quaternion *rotations, Vector3Array &positions);
+
+protected:
+	// packed components of one quaternion per track, padded to the vector width
+	struct QuaternionBatch
+	{
+		std::vector<float> w, x, y, z;
+		void resize(unsigned int n) { w.resize(n); x.resize(n); y.resize(n); z.resize(n); };
+		void set(unsigned int i, const Ogre::Quaternion &q) { w[i] = q.w; x[i] = q.x; y[i] = q.y; z[i] = q.z; };
+	};
+
+	std::vector<KeyframeTrack> tracks;
+
+	// gather buffers, kept to avoid allocations every frame
+	std::vector<float> weights, squadWeights;
+	QuaternionBatch p, q, a, b, tmp0, tmp1, result;
+
+	static void nlerp(unsigned int n, const float *t, const QuaternionBatch &p, const QuaternionBatch &q, QuaternionBatch &out);
+	static void slerp(unsigned int n, const float *t, const QuaternionBatch &p, const QuaternionBatch &q, QuaternionBatch &out, bool shortestPath);
+};
+
+#endif //KEYFRAMETRACK_H__
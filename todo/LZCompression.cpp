@@ -0,0 +1,176 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "LZCompression.h"
+
+#include <string.h>
+
+static const int lzHashBits       = 14;
+static const size_t lzMinMatch    = 4;
+static const size_t lzMaxOffset   = 65535;
+// every input byte yields at most 255 output bytes, the length bytes are the worst case
+static const size_t lzMaxRatio    = 255;
+
+static inline unsigned int lzHash(const unsigned char *p)
+{
+	unsigned int v = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+	return (v * 2654435761U) >> (32 - lzHashBits);
+}
+
+static inline void lzWriteLength(std::vector<char> &dst, size_t len)
+{
+	while(len >= 255)
+	{
+		dst.push_back((char)255);
+		len -= 255;
+	}
+	dst.push_back((char)len);
+}
+
+static void lzWriteSequence(std::vector<char> &dst, const unsigned char *literals, size_t literalLen, size_t offset, size_t matchLen)
+{
+	// token: literal length in the high nibble, match length in the low nibble, 15 means more bytes follow
+	size_t matchCode = matchLen ? matchLen - lzMinMatch : 0;
+	unsigned char token = (unsigned char)(((literalLen < 15 ? literalLen : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+	dst.push_back((char)token);
+	if(literalLen >= 15) lzWriteLength(dst, literalLen - 15);
+
+	dst.insert(dst.end(), literals, literals + literalLen);
+
+	// the last sequence has no match
+	if(!matchLen) return;
+
+	dst.push_back((char)(offset & 0xFF));
+	dst.push_back((char)(offset >> 8));
+	if(matchCode >= 15) lzWriteLength(dst, matchCode - 15);
+}
+
+void lzCompress(const char *src, size_t size, std::vector<char> &dst)
+{
+	dst.clear();
+	dst.reserve(size + size / 255 + 16);
+
+	const unsigned char *in = (const unsigned char *)src;
+
+	// last position + 1 of each hashed 4 byte sequence, 0 for none
+	std::vector<size_t> table(1 << lzHashBits, 0);
+
+	size_t anchor = 0, pos = 0;
+	while(pos + lzMinMatch <= size)
+	{
+		unsigned int h = lzHash(in + pos);
+		size_t candidate = table[h];
+		table[h] = pos + 1;
+
+		if(!candidate || pos - (candidate - 1) > lzMaxOffset || memcmp(in + candidate - 1, in + pos, lzMinMatch))
+		{
+			pos++;
+			continue;
+		}
+
+		size_t match = candidate - 1;
+		size_t len = lzMinMatch;
+		while(pos + len < size && in[match + len] == in[pos + len])
+			len++;
+
+		lzWriteSequence(dst, in + anchor, pos - anchor, pos - match, len);
+
+		// remember a position inside the match as well, repeated structures are common in bytecode
+		if(pos + len + lzMinMatch <= size && len > 2)
+			table[lzHash(in + pos + len - 2)] = pos + len - 2 + 1;
+
+		pos += len;
+		anchor = pos;
+	}
+
+	lzWriteSequence(dst, in + anchor, size - anchor, 0, 0);
+}
+
+static inline int lzReadLength(const unsigned char *&ip, const unsigned char *end, size_t &len)
+{
+	unsigned char b;
+	do
+	{
+		if(ip >= end) return 1;
+		b = *ip++;
+		len += b;
+	} while(b == 255);
+	return 0;
+}
+
+int lzDecompress(const char *src, size_t srcSize, char *dst, size_t dstSize)
+{
+	const unsigned char *ip  = (const unsigned char *)src;
+	const unsigned char *end = ip + srcSize;
+	unsigned char *op    = (unsigned char *)dst;
+	unsigned char *opEnd = op + dstSize;
+
+	while(ip < end)
+	{
+		unsigned char token = *ip++;
+
+		size_t literalLen = token >> 4;
+		if(literalLen == 15 && lzReadLength(ip, end, literalLen)) return 1;
+		if(literalLen > (size_t)(end - ip) || literalLen > (size_t)(opEnd - op)) return 1;
+		memcpy(op, ip, literalLen);
+		ip += literalLen;
+		op += literalLen;
+
+		// the last sequence ends after its literals
+		if(ip == end) break;
+
+		if(end - ip < 2) return 1;
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+
+		size_t matchLen = token & 0x0F;
+		if(matchLen == 15 && lzReadLength(ip, end, matchLen)) return 1;
+		matchLen += lzMinMatch;
+
+		if(!offset || offset > (size_t)(op - (unsigned char *)dst) || matchLen > (size_t)(opEnd - op)) return 1;
+
+		const unsigned char *match = op - offset;
+		if(offset >= matchLen)
+		{
+			memcpy(op, match, matchLen);
+			op += matchLen;
+		} else
+		{
+			// overlapping copy, repeats the last offset bytes
+			for(size_t i = 0; i < matchLen; i++)
+				*op++ = *match++;
+		}
+	}
+
+	return (op == opEnd) ? 0 : 1;
+}
+
+size_t lzMaxDecompressedSize(size_t srcSize)
+{
+	if(srcSize > (size_t)-1 / lzMaxRatio) return (size_t)-1;
+	return srcSize * lzMaxRatio;
+}
@@ -0,0 +1,68 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef LZCOMPRESSION_H__
+#define LZCOMPRESSION_H__
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ * @file LZCompression.h
+ * @brief small LZ77 codec for cached bytecode
+ *
+ * The format is a sequence of literal runs and back references with 16 bit offsets
+ * (the LZ4 block layout). Compression is a single greedy pass with a hash table, decompression
+ * is a plain copy loop, so unpacking is cheaper than reading the saved bytes from a cold disk.
+ */
+
+/**
+ * compresses a buffer
+ * @param src data to compress
+ * @param size size of the data
+ * @param dst receives the compressed data, it is only smaller than the input if the data compresses
+ */
+void lzCompress(const char *src, size_t size, std::vector<char> &dst);
+
+/**
+ * decompresses a buffer written by lzCompress, damaged input never writes outside of dst
+ * @param src compressed data
+ * @param srcSize size of the compressed data
+ * @param dst receives the decompressed data
+ * @param dstSize exact size of the decompressed data
+ * @return 0 on success, 1 if the data is damaged
+ */
+int lzDecompress(const char *src, size_t srcSize, char *dst, size_t dstSize);
+
+/**
+ * upper bound of the decompressed size, a stored size above it is damaged and must not be allocated
+ * @param srcSize size of the compressed data
+ * @return largest size srcSize bytes of compressed data can decompress to
+ */
+size_t lzMaxDecompressedSize(size_t srcSize);
+
+#endif //LZCOMPRESSION_H__
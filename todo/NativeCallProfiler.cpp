@@ -0,0 +1,103 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "NativeCallProfiler.h"
+#include "ScriptEngine.h"
+
+#include <algorithm>
+#include <vector>
+
+unsigned long NativeCallProfiler::frames = 0;
+
+std::map<AngelScript::asGENFUNC_t, NativeCallProfiler::nativeCall_t> &NativeCallProfiler::getCalls()
+{
+	// function local, so the shims can be registered from static initializers as well
+	static std::map<AngelScript::asGENFUNC_t, nativeCall_t> calls;
+	return calls;
+}
+
+Ogre::Timer &NativeCallProfiler::getTimer()
+{
+	static Ogre::Timer timer;
+	return timer;
+}
+
+AngelScript::asGENFUNC_t NativeCallProfiler::add(AngelScript::asGENFUNC_t shim, const char *name)
+{
+	nativeCall_t &c = getCalls()[shim];
+	c.name  = name;
+	c.calls = 0;
+	c.time  = 0;
+	return shim;
+}
+
+NativeCallProfiler::nativeCall_t *NativeCallProfiler::get(AngelScript::asGENFUNC_t shim)
+{
+	// a shim that was not added gets an empty name, the map keeps the entry alive
+	return &getCalls()[shim];
+}
+
+void NativeCallProfiler::frameStep()
+{
+	frames++;
+}
+
+static bool sortByTime(const NativeCallProfiler::nativeCall_t *a, const NativeCallProfiler::nativeCall_t *b)
+{
+	return a->time > b->time;
+}
+
+void NativeCallProfiler::logStatistics()
+{
+	std::map<AngelScript::asGENFUNC_t, nativeCall_t> &calls = getCalls();
+	if(calls.empty())
+	{
+		SLOG("native call profiling is disabled, build with AS_PROFILE_NATIVE_CALLS to enable it");
+		return;
+	}
+
+	std::vector<nativeCall_t *> sorted;
+	for(std::map<AngelScript::asGENFUNC_t, nativeCall_t>::iterator it = calls.begin(); it != calls.end(); it++)
+		if(it->second.calls) sorted.push_back(&it->second);
+	std::sort(sorted.begin(), sorted.end(), sortByTime);
+
+	SLOG("--- native call statistics (" + TOSTRING(frames) + " frames) ---");
+	for(unsigned int i = 0; i < sorted.size(); i++)
+	{
+		nativeCall_t *c = sorted[i];
+		float perFrame = frames ? (float)c->calls / (float)frames : 0.0f;
+		float avgCall  = (float)c->time / (float)c->calls;
+		SLOG(c->name + ": " + TOSTRING(c->calls) + " calls, " + TOSTRING(perFrame) + " per frame, " + TOSTRING(c->time) + " us total, " + TOSTRING(avgCall) + " us per call");
+	}
+
+	for(std::map<AngelScript::asGENFUNC_t, nativeCall_t>::iterator it = calls.begin(); it != calls.end(); it++)
+	{
+		it->second.calls = 0;
+		it->second.time  = 0;
+	}
+	frames = 0;
+}
@@ -0,0 +1,161 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef NATIVECALLPROFILER_H__
+#define NATIVECALLPROFILER_H__
+
+#include "RoRPrerequisites.h"
+
+#include <string>
+#include <map>
+#include <angelscript.h>
+#include <Ogre.h>
+
+// enable this to count and time every call from the scripts into the application.
+// All bindings are then registered through generic wrappers, which is slower, so only use it for profiling.
+// The bound functions are passed as template arguments, some of them are static, so this needs a compiler
+// that accepts functions with internal linkage there (C++11 or MSVC).
+//#define AS_PROFILE_NATIVE_CALLS
+
+/**
+ *  @brief Call counters and timing of the registered application functions.
+ *
+ *  The registrations in ScriptEngine::init and registerOgreObjects use the asPROFILED_* macros below
+ *  instead of asMETHOD/asFUNCTION and the calling convention. In a normal build they expand to exactly
+ *  that, with AS_PROFILE_NATIVE_CALLS every binding is registered through a generic shim that counts
+ *  and times the calls before forwarding them to the real function.
+ */
+class NativeCallProfiler
+{
+public:
+	struct nativeCall_t
+	{
+		std::string name;                 //!< C++ name of the bound function
+		unsigned long calls;              //!< number of calls since the last reset
+		unsigned long time;               //!< accumulated time in microseconds, including nested calls
+	};
+
+	/**
+	 * remembers the name of a shim, called when the binding is registered
+	 * @return the shim, so it can be used inside the registration call
+	 */
+	static AngelScript::asGENFUNC_t add(AngelScript::asGENFUNC_t shim, const char *name);
+
+	/**
+	 * @return the counters of a shim
+	 */
+	static nativeCall_t *get(AngelScript::asGENFUNC_t shim);
+
+	/**
+	 * counts the rendered frames, so the calls per frame can be reported
+	 */
+	static void frameStep();
+
+	/**
+	 * writes the calls per frame and time per function to the script log, most expensive first, and resets the counters
+	 */
+	static void logStatistics();
+
+	static Ogre::Timer &getTimer();
+
+protected:
+	static std::map<AngelScript::asGENFUNC_t, nativeCall_t> &getCalls();
+	static unsigned long frames;
+};
+
+#ifdef AS_PROFILE_NATIVE_CALLS
+
+// the wrapper generator uses the AngelScript types unqualified
+#include <new>
+namespace AngelScript
+{
+#include "autowrapper/aswrappedcall.h"
+}
+
+// counting shim for functions and methods, one instantiation per bound function
+template<typename F, F fn>
+struct ProfiledNativeCall
+{
+	static void call(AngelScript::asIScriptGeneric *gen)
+	{
+		static NativeCallProfiler::nativeCall_t *stats = NativeCallProfiler::get(&call);
+		unsigned long start = NativeCallProfiler::getTimer().getMicroseconds();
+		AngelScript::asCallWrappedFunc(fn, gen);
+		stats->time += NativeCallProfiler::getTimer().getMicroseconds() - start;
+		stats->calls++;
+	}
+};
+
+// counting shim for functions that take the object as last parameter
+template<typename F, F fn>
+struct ProfiledNativeCallObjLast
+{
+	static void call(AngelScript::asIScriptGeneric *gen)
+	{
+		static NativeCallProfiler::nativeCall_t *stats = NativeCallProfiler::get(&call);
+		unsigned long start = NativeCallProfiler::getTimer().getMicroseconds();
+		AngelScript::asCallWrappedFuncObj<false>::Call(fn, gen);
+		stats->time += NativeCallProfiler::getTimer().getMicroseconds() - start;
+		stats->calls++;
+	}
+};
+
+// deduces the function pointer type, so the pointer itself can be passed as template argument
+template<typename F>
+struct ProfiledNativeCallFactory
+{
+	template<F fn> AngelScript::asGENFUNC_t shim(const char *name)        { return NativeCallProfiler::add(&ProfiledNativeCall<F, fn>::call, name); }
+	template<F fn> AngelScript::asGENFUNC_t shimObjLast(const char *name) { return NativeCallProfiler::add(&ProfiledNativeCallObjLast<F, fn>::call, name); }
+};
+
+template<typename F>
+ProfiledNativeCallFactory<F> profiledNativeCall(F) { return ProfiledNativeCallFactory<F>(); }
+
+#define asPROFILED_METHOD(c,m)                   AngelScript::asFUNCTION(profiledNativeCall(&c::m).shim<&c::m>(#c "::" #m)), AngelScript::asCALL_GENERIC
+#define asPROFILED_METHODPR(c,m,p,r)             AngelScript::asFUNCTION(profiledNativeCall((r (c::*)p)0).shim<&c::m>(#c "::" #m #p)), AngelScript::asCALL_GENERIC
+#define asPROFILED_FUNCTION(f)                   AngelScript::asFUNCTION(profiledNativeCall(&f).shim<&f>(#f)), AngelScript::asCALL_GENERIC
+#define asPROFILED_FUNCTIONPR(f,p,r)             AngelScript::asFUNCTION(profiledNativeCall((r (*)p)0).shim<&f>(#f #p)), AngelScript::asCALL_GENERIC
+// the wrapper generator only supports the object as pointer, so these stay native and are not counted
+#define asPROFILED_FUNCTION_OBJFIRST(f)          AngelScript::asFUNCTION(f), AngelScript::asCALL_CDECL_OBJFIRST
+#define asPROFILED_FUNCTIONPR_OBJFIRST(f,p,r)    AngelScript::asFUNCTIONPR(f,p,r), AngelScript::asCALL_CDECL_OBJFIRST
+#define asPROFILED_FUNCTION_OBJLAST(f)           AngelScript::asFUNCTION(profiledNativeCall(&f).shimObjLast<&f>(#f)), AngelScript::asCALL_GENERIC
+#define asPROFILED_FUNCTIONPR_OBJLAST(f,p,r)     AngelScript::asFUNCTION(profiledNativeCall((r (*)p)0).shimObjLast<&f>(#f #p)), AngelScript::asCALL_GENERIC
+
+#else //AS_PROFILE_NATIVE_CALLS
+
+#define asPROFILED_METHOD(c,m)                   AngelScript::asMETHOD(c,m), AngelScript::asCALL_THISCALL
+#define asPROFILED_METHODPR(c,m,p,r)             AngelScript::asMETHODPR(c,m,p,r), AngelScript::asCALL_THISCALL
+#define asPROFILED_FUNCTION(f)                   AngelScript::asFUNCTION(f), AngelScript::asCALL_CDECL
+#define asPROFILED_FUNCTIONPR(f,p,r)             AngelScript::asFUNCTIONPR(f,p,r), AngelScript::asCALL_CDECL
+#define asPROFILED_FUNCTION_OBJFIRST(f)          AngelScript::asFUNCTION(f), AngelScript::asCALL_CDECL_OBJFIRST
+#define asPROFILED_FUNCTIONPR_OBJFIRST(f,p,r)    AngelScript::asFUNCTIONPR(f,p,r), AngelScript::asCALL_CDECL_OBJFIRST
+#define asPROFILED_FUNCTION_OBJLAST(f)           AngelScript::asFUNCTION(f), AngelScript::asCALL_CDECL_OBJLAST
+#define asPROFILED_FUNCTIONPR_OBJLAST(f,p,r)     AngelScript::asFUNCTIONPR(f,p,r), AngelScript::asCALL_CDECL_OBJLAST
+
+#endif //AS_PROFILE_NATIVE_CALLS
+
+#endif //NATIVECALLPROFILER_H__
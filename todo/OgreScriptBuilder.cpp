@@ -26,6 +26,7 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "OgreScriptBuilder.h"
+#include "CBytecodeStream.h"
 
 #include <string>
 #include <Ogre.h>
@@ -33,9 +34,14 @@ THE SOFTWARE.
 using namespace std;
 using namespace Ogre;
 
+// the resource system is not thread safe, the loader threads look up and open the files one at a time
+static AngelScript::CScriptBuilder::CLock resourceLock;
+
 // OgreScriptBuilder
-int OgreScriptBuilder::LoadScriptSection(const char *filename)
+int OgreScriptBuilder::ReadScriptSection(const char *filename, std::string &code)
 {
+	resourceLock.Lock();
+
 	// Open the script file
 	string scriptFile = filename;
 
@@ -43,30 +49,62 @@ int OgreScriptBuilder::LoadScriptSection(const char *filename)
 	try
 	{
 		ds = ResourceGroupManager::getSingleton().openResource(scriptFile, ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME);
-
-	} catch(Ogre::Exception e)
+	} catch(Ogre::Exception &e)
 	{
+		resourceLock.Unlock();
 		LOG("exception upon loading script file: " + e.getFullDescription());
 		return -1;
 	}
 
+	// plain files have a handle of their own and are read in parallel. The streams of
+	// zip archives share the archive handle, they are read while holding the lock
+	bool ownHandle = dynamic_cast<FileStreamDataStream *>(ds.getPointer()) != 0;
+	if(ownHandle) resourceLock.Unlock();
+
 	// Read the entire file
-	string code;
 	code.resize(ds->size());
-	ds->read(&code[0], ds->size());
-
-	// TODO: fix the script hashes
-	/*
-	// using SHA1 here is stupid, we need to replace it with something better
-	// then hash it
-	char hash_result[250];
-	memset(hash_result, 0, 249);
-	RoR::CSHA1 sha1;
-	sha1.UpdateHash((uint8_t *)script.c_str(), script.size());
-	sha1.Final();
-	sha1.ReportHash(hash_result, RoR::CSHA1::REPORT_HEX_SHORT);
-	hash = string(hash_result);
-	*/
-
-	return ProcessScriptSection(code.c_str(), filename);
+	if(!code.empty())
+		ds->read(&code[0], code.size());
+	ds.setNull();
+
+	if(!ownHandle) resourceLock.Unlock();
+	return 0;
+}
+
+int OgreScriptBuilder::MapScriptSection(const char *filename, const char *&data, size_t &length, void *&handle)
+{
+	// find the file on disk, only plain directories can be mapped. Scripts in zip archives are read as usual
+	String path;
+	resourceLock.Lock();
+	try
+	{
+		ResourceGroupManager &rgm = ResourceGroupManager::getSingleton();
+		String group = rgm.findGroupContainingResource(filename);
+		FileInfoListPtr files = rgm.findResourceFileInfo(group, filename);
+		if(!files.isNull() && !files->empty() && files->front().archive && files->front().archive->getType() == "FileSystem")
+			path = files->front().archive->getName() + "/" + files->front().filename;
+	} catch(Ogre::Exception &e)
+	{
+		// not found, the read will report it
+	}
+	resourceLock.Unlock();
+
+	if(path.empty()) return -1;
+
+	CMappedFile *file = new CMappedFile();
+	if(file->open(path) || !file->getSize())
+	{
+		delete file;
+		return -1;
+	}
+
+	data   = file->getData();
+	length = file->getSize();
+	handle = file;
+	return 0;
+}
+
+void OgreScriptBuilder::UnmapScriptSection(void *handle)
+{
+	delete (CMappedFile *)handle;
 }
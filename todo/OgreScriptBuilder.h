@@ -40,7 +40,11 @@ THE SOFTWARE.
 // to use the ogre resource system
 class OgreScriptBuilder : public AngelScript::CScriptBuilder
 {
-	int LoadScriptSection(const char *filename);
+	int ReadScriptSection(const char *filename, std::string &code);
+
+	// scripts in plain directories are mapped instead of read, see MapScriptSection
+	int MapScriptSection(const char *filename, const char *&data, size_t &length, void *&handle);
+	void UnmapScriptSection(void *handle);
 };
 
 #endif //OGRESCRIPTBUILDER_H__
@@ -0,0 +1,200 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ScriptCacheWarmup.h"
+#include "ScriptEngine.h"
+#include "CBytecodeStream.h"
+
+#include "scripthelper/scripthelper.h"
+
+#include <sstream>
+
+ScriptCacheWarmup::ScriptCacheWarmup(const std::string &interfaceConfig, const std::set<AngelScript::asQWORD> &_known) : engine(0), sources(), scripts(), known(_known), results(), thread(0), mutex(), running(false), cancel(false), done(false), processed(0), compiled(0), upToDate(0), failed(0), compileTime(0), startTime(0), totalTime(0), timer()
+{
+	// the engine is set up here, the worker only compiles with it
+	engine = AngelScript::asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	if(!engine) return;
+
+	std::istringstream config(interfaceConfig);
+	if(AngelScript::ConfigEngineFromStream(engine, config, "script interface") < 0)
+	{
+		SLOG("could not set up the engine for the script cache warm-up");
+		engine->Release();
+		engine = 0;
+	}
+}
+
+ScriptCacheWarmup::~ScriptCacheWarmup()
+{
+	if(running)
+	{
+		mutex.Lock();
+		cancel = true;
+		mutex.Unlock();
+		AngelScript::CScriptBuilder::JoinThread(thread);
+	}
+	if(engine) engine->Release();
+}
+
+void ScriptCacheWarmup::addSource(const std::string &name, const std::string &code, bool compile)
+{
+	if(running) return;
+	sources[name] = code;
+	if(compile) scripts.push_back(name);
+}
+
+int ScriptCacheWarmup::start()
+{
+	if(running || !engine) return 1;
+
+	startTime = timer.getMilliseconds();
+	running = true;
+	// the game must not stutter because of the warm-up, the worker runs at the lowest priority
+	thread = AngelScript::CScriptBuilder::StartThread(threadMain, this, true);
+	if(!thread)
+	{
+		running = false;
+		return 1;
+	}
+	return 0;
+}
+
+void ScriptCacheWarmup::threadMain(void *param)
+{
+	((ScriptCacheWarmup *)param)->run();
+
+	// the engine keeps per thread data
+	AngelScript::asThreadCleanup();
+}
+
+void ScriptCacheWarmup::run()
+{
+	for(unsigned int i = 0; i < scripts.size(); i++)
+	{
+		mutex.Lock();
+		bool stop = cancel;
+		mutex.Unlock();
+		if(stop) break;
+
+		unsigned long start = timer.getMilliseconds();
+
+		// the module name does not end up in the bytecode
+		MemoryScriptBuilder builder(sources);
+		int r = builder.StartNewModule(engine, "warmup");
+		if(r >= 0) r = builder.AddSectionFromFile(scripts[i].c_str());
+
+		result_t result;
+		result.name         = scripts[i];
+		result.sectionsHash = builder.GetSectionsHash();
+		result.time         = 0;
+
+		bool cached = (r >= 0 && known.find(result.sectionsHash) != known.end());
+		if(r >= 0 && !cached)
+		{
+			r = builder.BuildModule();
+			if(r >= 0)
+			{
+				CBytecodeStream bstream("", result.sectionsHash, 0);
+				AngelScript::asIScriptModule *mod = engine->GetModule("warmup", AngelScript::asGM_ONLY_IF_EXISTS);
+				if(mod->SaveByteCode(&bstream) >= 0)
+					result.bytecode = bstream.getBytecode();
+			}
+			result.time = timer.getMilliseconds() - start;
+		}
+		engine->DiscardModule("warmup");
+
+		mutex.Lock();
+		processed++;
+		if(cached)
+		{
+			upToDate++;
+		} else if(result.bytecode.empty())
+		{
+			// most of these are include files that do not compile on their own
+			failed++;
+		} else
+		{
+			compiled++;
+			compileTime += result.time;
+			results.push_back(result);
+		}
+		mutex.Unlock();
+	}
+
+	mutex.Lock();
+	totalTime = timer.getMilliseconds() - startTime;
+	done = true;
+	mutex.Unlock();
+}
+
+bool ScriptCacheWarmup::popResult(result_t &result)
+{
+	mutex.Lock();
+	bool found = !results.empty();
+	if(found)
+	{
+		result = results.front();
+		results.pop_front();
+	}
+	mutex.Unlock();
+	return found;
+}
+
+bool ScriptCacheWarmup::isFinished()
+{
+	if(!running) return true;
+	mutex.Lock();
+	bool finished = done && results.empty();
+	mutex.Unlock();
+	return finished;
+}
+
+void ScriptCacheWarmup::getProgress(unsigned int &_done, unsigned int &total)
+{
+	mutex.Lock();
+	_done = processed;
+	total = (unsigned int)scripts.size();
+	mutex.Unlock();
+}
+
+void ScriptCacheWarmup::logStatistics()
+{
+	mutex.Lock();
+	float avg = compiled ? (float)compileTime / (float)compiled : 0.0f;
+	SLOG("script cache warm-up: " + TOSTRING(processed) + " of " + TOSTRING(scripts.size()) + " scripts processed in " + TOSTRING(totalTime) + " ms, "
+		+ TOSTRING(compiled) + " compiled (" + TOSTRING(compileTime) + " ms, " + TOSTRING(avg) + " ms per script), "
+		+ TOSTRING(upToDate) + " up to date, " + TOSTRING(failed) + " not compilable on their own");
+	mutex.Unlock();
+}
+
+int ScriptCacheWarmup::MemoryScriptBuilder::ReadScriptSection(const char *filename, std::string &code)
+{
+	std::map<std::string, std::string>::const_iterator it = sources.find(filename);
+	if(it == sources.end()) return -1;
+	code = it->second;
+	return 0;
+}
@@ -0,0 +1,139 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef SCRIPTCACHEWARMUP_H__
+#define SCRIPTCACHEWARMUP_H__
+
+#include "RoRPrerequisites.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <deque>
+#include <angelscript.h>
+#include <Ogre.h>
+
+#include "scriptbuilder/scriptbuilder.h"
+
+/**
+ *  @brief Precompiles scripts into the bytecode cache in a background thread.
+ *
+ *  The worker has its own engine that only knows the registered interface, so it never
+ *  touches the game engine or the Ogre resource system. The script sources are read up front,
+ *  the compiled bytecode is handed back through popResult() and written to the bundle by the
+ *  main thread.
+ */
+class ScriptCacheWarmup
+{
+public:
+	struct result_t
+	{
+		std::string name;                       //!< script file name
+		AngelScript::asQWORD sectionsHash;      //!< hash of the preprocessed sections
+		std::vector<char> bytecode;             //!< saved module, empty if the script failed to compile
+		unsigned long time;                     //!< compile time in milliseconds
+	};
+
+	/**
+	 * @param interfaceConfig registered application interface, as written by WriteConfigToStream
+	 * @param known sections hashes that are already in the cache, these scripts are skipped
+	 */
+	ScriptCacheWarmup(const std::string &interfaceConfig, const std::set<AngelScript::asQWORD> &known);
+
+	/**
+	 * cancels the worker and waits for it to finish the current script
+	 */
+	~ScriptCacheWarmup();
+
+	/**
+	 * adds a script file, also used to resolve includes
+	 * @param compile false for files that are only included
+	 */
+	void addSource(const std::string &name, const std::string &code, bool compile = true);
+
+	/**
+	 * starts the worker thread
+	 * @return 0 on success
+	 */
+	int start();
+
+	/**
+	 * takes a compiled module, call it regularly from the main thread
+	 * @return false if no module is waiting
+	 */
+	bool popResult(result_t &result);
+
+	/**
+	 * @return true once all scripts are processed and all results were taken
+	 */
+	bool isFinished();
+
+	void getProgress(unsigned int &done, unsigned int &total);
+
+	/**
+	 * writes the number of compiled, up to date and failed scripts and the compile time to the script log
+	 */
+	void logStatistics();
+
+protected:
+	// resolves the scripts and their includes from the sources handed over by the main thread
+	class MemoryScriptBuilder : public AngelScript::CScriptBuilder
+	{
+	public:
+		MemoryScriptBuilder(const std::map<std::string, std::string> &_sources) : sources(_sources) {};
+	protected:
+		const std::map<std::string, std::string> &sources;
+		int ReadScriptSection(const char *filename, std::string &code);
+	};
+
+	AngelScript::asIScriptEngine *engine;   //!< compile only engine, only used by the worker
+	std::map<std::string, std::string> sources;
+	std::vector<std::string> scripts;        //!< scripts to compile
+	std::set<AngelScript::asQWORD> known;
+	std::deque<result_t> results;            //!< compiled modules waiting for the main thread
+
+	void *thread;                            //!< see CScriptBuilder::StartThread
+	AngelScript::CScriptBuilder::CLock mutex;
+	bool running;
+	bool cancel;
+	bool done;
+
+	unsigned int processed;
+	unsigned int compiled;
+	unsigned int upToDate;
+	unsigned int failed;
+	unsigned long compileTime;               //!< milliseconds spent compiling
+	unsigned long startTime;
+	unsigned long totalTime;                 //!< milliseconds from start() until the last script was processed
+	Ogre::Timer timer;
+
+	static void threadMain(void *param);
+	void run();
+};
+
+#endif //SCRIPTCACHEWARMUP_H__
@@ -0,0 +1,307 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ScriptComponents.h"
+#include "ScriptEngine.h"
+
+#include <algorithm>
+
+ScriptComponentManager::ScriptComponentManager(AngelScript::asIScriptEngine *_engine) : engine(_engine), groups(), componentGroups(), pending(), instances(), lodNearSq(0), lodFarSq(0), lodMidInterval(1), freeComponentId(1), updating(false), dirty(false), timer()
+{
+}
+
+ScriptComponentManager::~ScriptComponentManager()
+{
+	clear();
+}
+
+int ScriptComponentManager::attach(int functionPtr, const Ogre::String &instanceName)
+{
+	if(functionPtr <= 0) return -1;
+
+	component_t c;
+	c.id           = freeComponentId++;
+	c.instanceName = instanceName;
+	c.active       = true;
+	c.calls        = 0;
+	c.time         = 0;
+	c.skippedTime  = 0;
+	c.skippedFrames = 0;
+
+	// the components share the instance entry, so moving the instance touches only that entry
+	std::map<Ogre::String, instance_t>::iterator iit = instances.find(instanceName);
+	if(iit == instances.end())
+	{
+		instance_t inst;
+		inst.hasPosition = false;
+		inst.position    = Ogre::Vector3::ZERO;
+		iit = instances.insert(std::map<Ogre::String, instance_t>::value_type(instanceName, inst)).first;
+	}
+	c.instance = &iit->second;
+	c.instance->components.push_back(c.id);
+
+	componentGroups[c.id] = functionPtr;
+
+	if(updating)
+	{
+		// the component vectors must not grow while they are iterated, add it after the update
+		pending.push_back(std::pair<int, component_t>(functionPtr, c));
+		return c.id;
+	}
+
+	addToGroup(functionPtr, c);
+	return c.id;
+}
+
+void ScriptComponentManager::addToGroup(int functionPtr, const component_t &c)
+{
+	std::map<int, group_t>::iterator it = groups.find(functionPtr);
+	if(it == groups.end())
+	{
+		group_t g;
+		g.functionPtr = functionPtr;
+		g.calls       = 0;
+		g.time        = 0;
+		g.frames      = 0;
+		g.skipped     = 0;
+		it = groups.insert(std::map<int, group_t>::value_type(functionPtr, g)).first;
+	}
+	it->second.components.push_back(c);
+}
+
+void ScriptComponentManager::unlinkInstance(const component_t &c)
+{
+	std::vector<int> &ids = c.instance->components;
+	std::vector<int>::iterator it = std::find(ids.begin(), ids.end(), c.id);
+	if(it != ids.end()) ids.erase(it);
+}
+
+int ScriptComponentManager::detach(int componentId)
+{
+	std::map<int, int>::iterator cit = componentGroups.find(componentId);
+	if(cit == componentGroups.end()) return 1;
+
+	int functionPtr = cit->second;
+	componentGroups.erase(cit);
+
+	// it might still be waiting to be added
+	for(std::vector<std::pair<int, component_t> >::iterator pit = pending.begin(); pit != pending.end(); pit++)
+	{
+		if(pit->second.id != componentId) continue;
+		unlinkInstance(pit->second);
+		pending.erase(pit);
+		return 0;
+	}
+
+	std::map<int, group_t>::iterator it = groups.find(functionPtr);
+	if(it == groups.end()) return 1;
+
+	for(std::vector<component_t>::iterator it2 = it->second.components.begin(); it2 != it->second.components.end(); it2++)
+	{
+		if(it2->id != componentId) continue;
+		// only flag it, the removal happens after the update so no iterator is invalidated
+		unlinkInstance(*it2);
+		it2->active = false;
+		dirty = true;
+		break;
+	}
+	if(!updating) compact();
+	return 0;
+}
+
+void ScriptComponentManager::detachAll(const Ogre::String &instanceName)
+{
+	std::map<Ogre::String, instance_t>::iterator iit = instances.find(instanceName);
+	if(iit == instances.end()) return;
+
+	// detach() removes the ids from the instance, so work on a copy
+	std::vector<int> ids = iit->second.components;
+	for(unsigned int i = 0; i < ids.size(); i++)
+		detach(ids[i]);
+}
+
+void ScriptComponentManager::removeInstance(const Ogre::String &instanceName)
+{
+	detachAll(instanceName);
+	instances.erase(instanceName);
+}
+
+void ScriptComponentManager::setInstancePosition(const Ogre::String &instanceName, const Ogre::Vector3 &pos)
+{
+	instance_t &inst = instances[instanceName];
+	inst.hasPosition = true;
+	inst.position    = pos;
+}
+
+void ScriptComponentManager::setLodDistances(Ogre::Real nearDistance, Ogre::Real farDistance, int midInterval)
+{
+	lodNearSq      = nearDistance * nearDistance;
+	lodFarSq       = farDistance * farDistance;
+	lodMidInterval = std::max(midInterval, 1);
+}
+
+void ScriptComponentManager::clear()
+{
+	groups.clear();
+	componentGroups.clear();
+	pending.clear();
+	instances.clear();
+	dirty = false;
+}
+
+void ScriptComponentManager::compact()
+{
+	if(dirty)
+	{
+		std::map<int, group_t>::iterator it = groups.begin();
+		while(it != groups.end())
+		{
+			std::vector<component_t> &comps = it->second.components;
+			unsigned int j = 0;
+			for(unsigned int i = 0; i < comps.size(); i++)
+			{
+				if(!comps[i].active) continue;
+				if(i != j) comps[j] = comps[i];
+				j++;
+			}
+			comps.resize(j);
+
+			if(comps.empty())
+				groups.erase(it++);
+			else
+				it++;
+		}
+		dirty = false;
+	}
+
+	if(!pending.empty())
+	{
+		std::vector<std::pair<int, component_t> > added;
+		added.swap(pending);
+		for(unsigned int i = 0; i < added.size(); i++)
+			addToGroup(added[i].first, added[i].second);
+	}
+}
+
+int ScriptComponentManager::update(AngelScript::asIScriptContext *context, Ogre::Real dt, const Ogre::Vector3 &cameraPos)
+{
+	if(!context || groups.empty()) return 0;
+
+	// level of detail is disabled as long as no near distance is set
+	bool lod = (lodNearSq > 0);
+
+	int executed = 0;
+	updating = true;
+	for(std::map<int, group_t>::iterator it = groups.begin(); it != groups.end(); it++)
+	{
+		group_t &g = it->second;
+		unsigned long groupStart = timer.getMicroseconds();
+		unsigned long groupCalls = 0;
+		for(unsigned int i = 0; i < g.components.size(); i++)
+		{
+			component_t &c = g.components[i];
+			if(!c.active) continue;
+
+			c.skippedTime += dt;
+			c.skippedFrames++;
+			if(lod && c.instance->hasPosition)
+			{
+				Ogre::Real distSq = c.instance->position.squaredDistance(cameraPos);
+				bool suspended = (lodFarSq > 0 && distSq > lodFarSq);
+				bool midRange  = (distSq > lodNearSq && c.skippedFrames < lodMidInterval);
+				if(suspended || midRange)
+				{
+					// a suspended component does not catch up with the time it was away
+					if(suspended) c.skippedTime = 0;
+					g.skipped++;
+					continue;
+				}
+			}
+			Ogre::Real componentDt = c.skippedTime;
+			c.skippedTime   = 0;
+			c.skippedFrames = 0;
+
+			unsigned long start = timer.getMicroseconds();
+
+			// preparing the same function again is cheap, the context keeps the function set up
+			context->Prepare(g.functionPtr);
+			context->SetArgObject(0, &c.instanceName);
+			context->SetArgFloat(1, componentDt);
+			int r = context->Execute();
+
+			c.time += timer.getMicroseconds() - start;
+			c.calls++;
+			groupCalls++;
+
+			if(r == AngelScript::asEXECUTION_EXCEPTION)
+			{
+				// disable the broken component, otherwise we would spam the log every frame
+				AngelScript::asIScriptFunction *func = engine->GetFunctionDescriptorById(g.functionPtr);
+				SLOG("An exception '" + String(context->GetExceptionString()) + "' occurred in component " + TOSTRING(c.id) + " (" + String(func ? func->GetDeclaration() : "unknown") + ") of instance '" + c.instanceName + "', component disabled.");
+				// the update function might have detached its own component already
+				if(c.active) unlinkInstance(c);
+				c.active = false;
+				componentGroups.erase(c.id);
+				dirty = true;
+			}
+		}
+		g.time += timer.getMicroseconds() - groupStart;
+		g.calls += groupCalls;
+		g.frames++;
+		executed += groupCalls;
+	}
+	updating = false;
+
+	compact();
+	return executed;
+}
+
+void ScriptComponentManager::logStatistics()
+{
+	SLOG("--- script component statistics ---");
+	for(std::map<int, group_t>::iterator it = groups.begin(); it != groups.end(); it++)
+	{
+		group_t &g = it->second;
+		AngelScript::asIScriptFunction *func = engine->GetFunctionDescriptorById(g.functionPtr);
+		String decl = func ? String(func->GetDeclaration()) : "unknown";
+		float avgFrame = g.frames ? (float)g.time / (float)g.frames : 0.0f;
+		float avgCall  = g.calls  ? (float)g.time / (float)g.calls  : 0.0f;
+		SLOG(decl + ": " + TOSTRING(g.components.size()) + " components, " + TOSTRING(g.calls) + " calls, " + TOSTRING(g.skipped) + " skipped, " + TOSTRING(avgFrame) + " us per pass, " + TOSTRING(avgCall) + " us per call");
+
+		for(std::vector<component_t>::iterator it2 = g.components.begin(); it2 != g.components.end(); it2++)
+		{
+			float avg = it2->calls ? (float)it2->time / (float)it2->calls : 0.0f;
+			SLOG("  #" + TOSTRING(it2->id) + " " + it2->instanceName + ": " + TOSTRING(it2->time) + " us total, " + TOSTRING(avg) + " us per call");
+			it2->calls = 0;
+			it2->time  = 0;
+		}
+		g.calls  = 0;
+		g.time   = 0;
+		g.frames = 0;
+		g.skipped = 0;
+	}
+}
@@ -0,0 +1,168 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef SCRIPTCOMPONENTS_H__
+#define SCRIPTCOMPONENTS_H__
+
+#include "RoRPrerequisites.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <angelscript.h>
+#include <Ogre.h>
+
+/**
+ *  @brief Registry of per-object script behaviours.
+ *
+ *  Scripts attach an update function to an object instance, the components
+ *  are then updated grouped by their script function, so all objects using
+ *  the same behaviour run back to back on the same bytecode.
+ *  The update function must have the signature void f(const string &in instanceName, float dt)
+ *
+ *  Components with a known position are updated less often the further they are away
+ *  from the camera: every frame when near, every few frames at mid range and not at all
+ *  when far away. Skipped time is handed to the next update, so dt stays correct.
+ */
+class ScriptComponentManager
+{
+public:
+	ScriptComponentManager(AngelScript::asIScriptEngine *engine);
+	~ScriptComponentManager();
+
+	/**
+	 * attaches an update behaviour to an object instance
+	 * @param functionPtr script function id of the update function
+	 * @param instanceName name of the object instance the behaviour belongs to
+	 * @return component id (>0) on success, negative value on error
+	 */
+	int attach(int functionPtr, const Ogre::String &instanceName);
+
+	/**
+	 * removes a single component
+	 * @param componentId id returned by attach()
+	 * @return 0 on success, 1 if the component was not found
+	 */
+	int detach(int componentId);
+
+	/**
+	 * removes all components of an object instance, its position is kept
+	 * @param instanceName name of the object instance
+	 */
+	void detachAll(const Ogre::String &instanceName);
+
+	/**
+	 * removes all components and the position of an object instance, needs to be called when the instance is destroyed
+	 * @param instanceName name of the object instance
+	 */
+	void removeInstance(const Ogre::String &instanceName);
+
+	/**
+	 * sets the position of an object instance, used to pick the update interval of its components
+	 * @param instanceName name of the object instance
+	 * @param pos world position of the object
+	 */
+	void setInstancePosition(const Ogre::String &instanceName, const Ogre::Vector3 &pos);
+
+	/**
+	 * sets the distance bands of the update level of detail
+	 * @param nearDistance up to this distance components are updated every frame
+	 * @param farDistance beyond this distance components are suspended, 0 to never suspend them
+	 * @param midInterval components between both distances are updated every midInterval frames
+	 */
+	void setLodDistances(Ogre::Real nearDistance, Ogre::Real farDistance, int midInterval);
+
+	/**
+	 * removes all components, needs to be called when the module is rebuilt
+	 */
+	void clear();
+
+	/**
+	 * updates all active components, grouped by their update function
+	 * @param context script context to execute the update functions in
+	 * @param dt time passed since the last call in seconds
+	 * @param cameraPos camera position, used to pick the update interval of positioned components
+	 * @return number of component updates executed
+	 */
+	int update(AngelScript::asIScriptContext *context, Ogre::Real dt, const Ogre::Vector3 &cameraPos);
+
+	/**
+	 * writes the collected per function and per component costs to the script log and resets them
+	 */
+	void logStatistics();
+
+	int getComponentCount() { return (int)componentGroups.size(); };
+
+protected:
+	struct instance_t
+	{
+		bool hasPosition;                 //!< false if the components of this instance are always updated
+		Ogre::Vector3 position;           //!< last known position of the object instance
+		std::vector<int> components;      //!< ids of the components attached to this instance
+	};
+
+	struct component_t
+	{
+		int id;                           //!< unique component id
+		std::string instanceName;         //!< object instance, passed as first argument to the update function
+		instance_t *instance;             //!< entry in instances, only valid while the component is active
+		bool active;                      //!< false if the component was detached or failed
+		Ogre::Real skippedTime;           //!< time that passed since the last update of this component
+		unsigned int skippedFrames;       //!< frames since the last update of this component
+		unsigned long calls;              //!< number of updates since the last statistics reset
+		unsigned long time;               //!< accumulated update time in microseconds
+	};
+
+	struct group_t
+	{
+		int functionPtr;                  //!< script update function shared by all components of this group
+		std::vector<component_t> components;
+		unsigned long calls;              //!< number of updates since the last statistics reset
+		unsigned long time;               //!< accumulated update time in microseconds
+		unsigned long frames;             //!< number of batched passes since the last statistics reset
+		unsigned long skipped;            //!< number of updates skipped by the level of detail
+	};
+
+	AngelScript::asIScriptEngine *engine;
+	std::map<int, group_t> groups;        //!< function id -> components using that function
+	std::map<int, int> componentGroups;   //!< component id -> function id
+	std::vector<std::pair<int, component_t> > pending; //!< components attached while updating
+	std::map<Ogre::String, instance_t> instances; //!< position and components per object instance
+	Ogre::Real lodNearSq;                 //!< squared distance up to which components are updated every frame
+	Ogre::Real lodFarSq;                  //!< squared distance beyond which components are suspended, 0 for never
+	unsigned int lodMidInterval;          //!< frames between updates in the mid range
+	int freeComponentId;
+	bool updating;
+	bool dirty;                           //!< true if inactive components need to be removed
+	Ogre::Timer timer;
+
+	void addToGroup(int functionPtr, const component_t &c);
+	void unlinkInstance(const component_t &c);
+	void compact();
+};
+
+#endif //SCRIPTCOMPONENTS_H__
@@ -0,0 +1,139 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ScriptDependencies.h"
+#include "ScriptEngine.h"
+#include "CBytecodeStream.h"
+
+#include <string.h>
+
+void ScriptDependencies::setModule(const Ogre::String &module, const Ogre::String &scriptname, const std::vector<AngelScript::CScriptBuilder::SSectionDependency> &sectionList)
+{
+	removeModule(module);
+
+	module_t &m = modules[module];
+	m.scriptname = scriptname;
+	for(unsigned int i = 0; i < sectionList.size(); i++)
+	{
+		const AngelScript::CScriptBuilder::SSectionDependency &dep = sectionList[i];
+		m.sectionHashes[dep.name] = dep.sourceHash;
+
+		section_t &s = sections[dep.name];
+		s.includes.assign(dep.includes.begin(), dep.includes.end());
+		s.modules.insert(module);
+	}
+}
+
+void ScriptDependencies::removeModule(const Ogre::String &module)
+{
+	std::map<Ogre::String, module_t>::iterator it = modules.find(module);
+	if(it == modules.end()) return;
+
+	for(std::map<Ogre::String, AngelScript::asQWORD>::iterator it2 = it->second.sectionHashes.begin(); it2 != it->second.sectionHashes.end(); it2++)
+	{
+		std::map<Ogre::String, section_t>::iterator sit = sections.find(it2->first);
+		if(sit == sections.end()) continue;
+		sit->second.modules.erase(module);
+
+		// sections no module uses anymore are not worth watching
+		if(sit->second.modules.empty()) sections.erase(sit);
+	}
+	modules.erase(it);
+}
+
+void ScriptDependencies::getDependentModules(const Ogre::String &section, std::set<Ogre::String> &result)
+{
+	// every module keeps the complete list of its sections, so this includes indirect dependencies
+	std::map<Ogre::String, section_t>::iterator it = sections.find(section);
+	if(it == sections.end()) return;
+	result.insert(it->second.modules.begin(), it->second.modules.end());
+}
+
+int ScriptDependencies::findOutdatedModules(std::map<Ogre::String, Ogre::String> &outdated)
+{
+	// read every section only once, no matter how many modules include it
+	std::map<Ogre::String, AngelScript::asQWORD> current;
+	for(std::map<Ogre::String, section_t>::iterator it = sections.begin(); it != sections.end(); it++)
+	{
+		AngelScript::asQWORD hash = 0;
+		if(hashSection(it->first, hash)) continue;
+		current[it->first] = hash;
+	}
+
+	std::set<Ogre::String> changed;
+	for(std::map<Ogre::String, module_t>::iterator it = modules.begin(); it != modules.end(); it++)
+	{
+		for(std::map<Ogre::String, AngelScript::asQWORD>::iterator it2 = it->second.sectionHashes.begin(); it2 != it->second.sectionHashes.end(); it2++)
+		{
+			// sections that can not be read anymore or changed since the module was built
+			std::map<Ogre::String, AngelScript::asQWORD>::iterator cit = current.find(it2->first);
+			if(cit != current.end() && cit->second == it2->second) continue;
+
+			changed.insert(it2->first);
+			outdated[it->first] = it->second.scriptname;
+		}
+	}
+	return (int)changed.size();
+}
+
+void ScriptDependencies::logGraph()
+{
+	SLOG("--- script dependencies: " + TOSTRING(modules.size()) + " modules, " + TOSTRING(sections.size()) + " sections ---");
+	for(std::map<Ogre::String, module_t>::iterator it = modules.begin(); it != modules.end(); it++)
+	{
+		SLOG(it->first + " (" + it->second.scriptname + "): " + TOSTRING(it->second.sectionHashes.size()) + " sections");
+		for(std::map<Ogre::String, AngelScript::asQWORD>::iterator it2 = it->second.sectionHashes.begin(); it2 != it->second.sectionHashes.end(); it2++)
+		{
+			String line = "  " + it2->first;
+			std::map<Ogre::String, section_t>::iterator sit = sections.find(it2->first);
+			if(sit != sections.end())
+				for(unsigned int i = 0; i < sit->second.includes.size(); i++)
+					line += (i ? ", " : " includes ") + sit->second.includes[i];
+			SLOG(line);
+		}
+	}
+}
+
+int ScriptDependencies::hashSection(const Ogre::String &name, AngelScript::asQWORD &hash)
+{
+	Ogre::DataStreamPtr ds;
+	try
+	{
+		ds = Ogre::ResourceGroupManager::getSingleton().openResource(name, Ogre::ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME);
+	} catch(Ogre::Exception& e)
+	{
+		return 1;
+	}
+
+	std::string code;
+	code.resize(ds->size());
+	if(!code.empty()) ds->read(&code[0], ds->size());
+
+	// the builder hashes the code up to the first null character
+	hash = hashBytecode(code.c_str(), strlen(code.c_str()));
+	return 0;
+}
@@ -0,0 +1,111 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef SCRIPTDEPENDENCIES_H__
+#define SCRIPTDEPENDENCIES_H__
+
+#include "RoRPrerequisites.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <angelscript.h>
+#include <Ogre.h>
+#include "scriptbuilder/scriptbuilder.h"
+
+/**
+ *  @brief Remembers which script sections every module was built from.
+ *
+ *  For every module the sections are kept with the hash of the code they had when the
+ *  module was built, for every section the sections it includes and the modules using it.
+ *  When script files change, only the modules that contain one of them have to be rebuilt,
+ *  all other modules keep running untouched.
+ */
+class ScriptDependencies
+{
+public:
+	/**
+	 * records the sections a module was built from, replaces what was known about the module
+	 * @param module name of the module
+	 * @param scriptname script file the module was built from
+	 * @param sections sections of the module as reported by the builder
+	 */
+	void setModule(const Ogre::String &module, const Ogre::String &scriptname, const std::vector<AngelScript::CScriptBuilder::SSectionDependency> &sections);
+
+	/**
+	 * forgets a module, e.g. when it was discarded
+	 * @param module name of the module
+	 */
+	void removeModule(const Ogre::String &module);
+
+	/**
+	 * collects the modules that contain a section, directly or through includes
+	 * @param section name of the section
+	 * @param modules receives the module names
+	 */
+	void getDependentModules(const Ogre::String &section, std::set<Ogre::String> &modules);
+
+	/**
+	 * reads every known section once and compares it to the code the modules were built from
+	 * @param outdated receives module name -> script file for every module that needs to be rebuilt
+	 * @return number of sections that changed
+	 */
+	int findOutdatedModules(std::map<Ogre::String, Ogre::String> &outdated);
+
+	/**
+	 * writes the include graph of all modules to the script log
+	 */
+	void logGraph();
+
+	int getModuleCount() { return (int)modules.size(); };
+	int getSectionCount() { return (int)sections.size(); };
+
+protected:
+	struct module_t
+	{
+		Ogre::String scriptname;                                      //!< script file the module was built from
+		std::map<Ogre::String, AngelScript::asQWORD> sectionHashes;  //!< section -> hash of its code at build time
+	};
+
+	struct section_t
+	{
+		std::vector<Ogre::String> includes;                           //!< sections this one includes
+		std::set<Ogre::String> modules;                               //!< modules containing this section
+	};
+
+	std::map<Ogre::String, module_t> modules;
+	std::map<Ogre::String, section_t> sections;
+
+	/**
+	 * reads a section through the resource system and hashes it like the script builder does
+	 * @return 0 on success, 1 if the section could not be read
+	 */
+	int hashSection(const Ogre::String &name, AngelScript::asQWORD &hash);
+};
+
+#endif //SCRIPTDEPENDENCIES_H__
@@ -34,6 +34,8 @@ THE SOFTWARE.
 // AS addons start
 #include "scriptstdstring/scriptstdstring.h"
 #include "scriptmath/scriptmath.h"
+#include "scriptnoise/scriptnoise.h"
+#include "scriptmath/scriptmatharray.h"
 #include "contextmgr/contextmgr.h"
 #include "scriptany/scriptany.h"
 #include "scriptarray/scriptarray.h"
@@ -44,6 +46,8 @@ THE SOFTWARE.
 #ifdef USE_CURL
 #define CURL_STATICLIB
 #include <stdio.h>
+#include <sstream>
+#include <set>
 #include <curl/curl.h>
 #include <curl/types.h>
 #include <curl/easy.h>
@@ -65,8 +69,14 @@ THE SOFTWARE.
 
 #include "GameScript.h"
 #include "OgreScriptBuilder.h"
+#include "ScriptDependencies.h"
 #include "CBytecodeStream.h"
+#include "CBytecodeBundle.h"
+#include "ScriptCacheWarmup.h"
 #include "ScriptEvents.h"
+#include "ScriptComponents.h"
+#include "ScriptSnapshot.h"
+#include "NativeCallProfiler.h"
 
 //using namespace Ogre;
 //using namespace std;
@@ -76,6 +86,38 @@ template<> ScriptEngine *Ogre::Singleton<ScriptEngine>::ms_Singleton=0;
 
 char *ScriptEngine::moduleName = "RoRScript";
 
+// names of the script events, used for the script enum and the script manifest
+static const struct { const char *name; int value; } scriptEventNames[] = {
+	{"SE_COLLISION_BOX_ENTER", SE_COLLISION_BOX_ENTER},
+	{"SE_COLLISION_BOX_LEAVE", SE_COLLISION_BOX_LEAVE},
+	{"SE_TRUCK_ENTER", SE_TRUCK_ENTER},
+	{"SE_TRUCK_EXIT", SE_TRUCK_EXIT},
+	{"SE_TRUCK_ENGINE_DIED", SE_TRUCK_ENGINE_DIED},
+	{"SE_TRUCK_ENGINE_FIRE", SE_TRUCK_ENGINE_FIRE},
+	{"SE_TRUCK_TOUCHED_WATER", SE_TRUCK_TOUCHED_WATER},
+	{"SE_TRUCK_BEAM_BROKE", SE_TRUCK_BEAM_BROKE},
+	{"SE_TRUCK_LOCKED", SE_TRUCK_LOCKED},
+	{"SE_TRUCK_UNLOCKED", SE_TRUCK_UNLOCKED},
+	{"SE_TRUCK_LIGHT_TOGGLE", SE_TRUCK_LIGHT_TOGGLE},
+	{"SE_TRUCK_SKELETON_TOGGLE", SE_TRUCK_SKELETON_TOGGLE},
+	{"SE_TRUCK_TIE_TOGGLE", SE_TRUCK_TIE_TOGGLE},
+	{"SE_TRUCK_PARKINGBREAK_TOGGLE", SE_TRUCK_PARKINGBREAK_TOGGLE},
+	{"SE_TRUCK_TRACTIONCONTROL_TOGGLE", SE_TRUCK_TRACTIONCONTROL_TOGGLE},
+	{"SE_TRUCK_ANTILOCKBRAKE_TOGGLE", SE_TRUCK_ANTILOCKBRAKE_TOGGLE},
+	{"SE_TRUCK_BEACONS_TOGGLE", SE_TRUCK_BEACONS_TOGGLE},
+	{"SE_TRUCK_CPARTICLES_TOGGLE", SE_TRUCK_CPARTICLES_TOGGLE},
+	{"SE_TRUCK_GROUND_CONTACT_CHANGED", SE_TRUCK_GROUND_CONTACT_CHANGED},
+	{"SE_GENERIC_NEW_TRUCK", SE_GENERIC_NEW_TRUCK},
+	{"SE_GENERIC_DELETED_TRUCK", SE_GENERIC_DELETED_TRUCK},
+	{"SE_GENERIC_INPUT_EVENT", SE_GENERIC_INPUT_EVENT},
+	{"SE_GENERIC_MOUSE_BEAM_INTERACTION", SE_GENERIC_MOUSE_BEAM_INTERACTION},
+	{"SE_ALL_EVENTS", SE_ALL_EVENTS},
+	{0, 0}
+};
+
+// upper limit of fixed script updates per rendered frame, the remaining time gets dropped after a hitch
+#define MAX_SCRIPT_TICKS_PER_FRAME 5
+
 
 // some hacky functions
 
@@ -84,9 +126,31 @@ void logString(const std::string &str)
 	SLOG(str);
 }
 
+// script functions the engine calls and the parameters they need to have
+static const struct
+{
+	const char *event;
+	const char *params;
+} scriptHandlers[] =
+{
+	{ "main",                 "()" },
+	{ "frameStep",            "(float)" },
+	{ "frameInterpolate",     "(float)" },
+	{ "wheelEvents",          "(int, string, string, string)" },
+	{ "eventCallback",        "(int, int)" },
+	{ "defaultEventCallback", "(int, string, string, int)" },
+	{ "on_terrain_loading",   "(string)" },
+};
+
+static int getHandler(const std::map<Ogre::String, int> &handlers, const char *event)
+{
+	std::map<Ogre::String, int>::const_iterator it = handlers.find(event);
+	return it == handlers.end() ? -1 : it->second;
+}
+
 // the class implementation
 
-ScriptEngine::ScriptEngine(RoRFrameListener *efl, Collisions *_coll) : mefl(efl), coll(_coll), engine(0), context(0), frameStepFunctionPtr(-1), wheelEventFunctionPtr(-1), eventCallbackFunctionPtr(-1), defaultEventCallbackFunctionPtr(-1), eventMask(0), terrainScriptName(), terrainScriptHash(), scriptLog(0)
+ScriptEngine::ScriptEngine(RoRFrameListener *efl, Collisions *_coll) : mefl(efl), coll(_coll), engine(0), context(0), components(0), bytecodeBundle(0), precompiledBundle(0), warmup(0), dependencies(0), frameStepFunctionPtr(-1), frameInterpolateFunctionPtr(-1), wheelEventFunctionPtr(-1), eventCallbackFunctionPtr(-1), defaultEventCallbackFunctionPtr(-1), eventMask(0), terrainScriptName(), terrainScriptHash(), ticks(), lazyScripts(), lazyEventMask(0), defaultTickRate(0), interfaceFingerprint(0), reloadInterval(0), reloadTimer(0), reloadRequested(false), scriptLog(0)
 {
 	callbacks["on_terrain_loading"] = std::vector<int>();
 	callbacks["frameStep"] = std::vector<int>();
@@ -95,6 +159,19 @@ ScriptEngine::ScriptEngine(RoRFrameListener *efl, Collisions *_coll) : mefl(efl)
 
 	enable_ingame_console = BSETTING("Enable Ingame Console");
 
+	// fixed script update rate in Hz, 0 or unset updates the scripts once per rendered frame
+	defaultTickRate = StringConverter::parseReal(SSETTING("Script Tick Rate"));
+
+	// smaller cache entries load faster from slow disks
+	compress_bytecode = BSETTING("Script Cache Compression");
+
+	// deep include trees load faster when the files are read and preprocessed in parallel
+	loaderThreads = StringConverter::parseInt(SSETTING("Script Loader Threads"));
+	if(loaderThreads <= 0) loaderThreads = 4;
+
+	// script authors can have changed files rebuilt while the game runs, 0 or unset disables the polling
+	reloadInterval = StringConverter::parseReal(SSETTING("Script Reload Interval"));
+
 	// create our own log
 	scriptLog = LogManager::getSingleton().createLog(SSETTING("Log Path")+"/Angelscript.log", false);
 	
@@ -110,6 +187,11 @@ ScriptEngine::ScriptEngine(RoRFrameListener *efl, Collisions *_coll) : mefl(efl)
 ScriptEngine::~ScriptEngine()
 {
 	// Clean up
+	if(warmup) delete warmup;
+	if(dependencies) delete dependencies;
+	if(components) delete components;
+	if(bytecodeBundle) delete bytecodeBundle;
+	if(precompiledBundle) delete precompiledBundle;
 	if(engine)  engine->Release();
 	if(context) context->Release();
 }
@@ -150,15 +232,136 @@ void ScriptEngine::ExceptionCallback(AngelScript::asIScriptContext *ctx, void *p
 
 void ScriptEngine::exploreScripts()
 {
-	// this shouldnt be used atm
-	return;
-#if USE_ANGELSCRIPT
-	FileInfoListPtr files= ResourceGroupManager::getSingleton().findResourceFileInfo("Scripts", "*.rs", false);
-	for (FileInfoList::iterator iterFiles = files->begin(); iterFiles!= files->end(); ++iterFiles)
+	// loading every script right away is too expensive, only remember what the scripts listen to.
+	// Scripts that are loaded already keep their module and handlers
+	std::vector<lazyScript_t> previous;
+	previous.swap(lazyScripts);
+	for(unsigned int i = 0; i < previous.size(); i++)
+		if(previous[i].loaded) lazyScripts.push_back(previous[i]);
+	lazyEventMask = 0;
+	if(!ResourceGroupManager::getSingleton().resourceExists("Scripts", "scripts.manifest")) return;
+
+	ConfigFile cfg;
+	try
+	{
+		DataStreamPtr ds = ResourceGroupManager::getSingleton().openResource("scripts.manifest", "Scripts");
+		cfg.load(ds, "=", true);
+	} catch(Ogre::Exception& e)
+	{
+		SLOG("Error while reading the script manifest: " + e.getFullDescription());
+		return;
+	}
+
+	ConfigFile::SectionIterator secIt = cfg.getSectionIterator();
+	while(secIt.hasMoreElements())
+	{
+		String filename = secIt.peekNextKey();
+		ConfigFile::SettingsMultiMap *settings = secIt.getNext();
+		if(filename.empty()) continue;
+
+		bool known = false;
+		for(unsigned int i = 0; i < lazyScripts.size() && !known; i++)
+			known = (lazyScripts[i].filename == filename);
+		if(known) continue;
+
+		lazyScript_t script;
+		script.filename = filename;
+		script.eventMask = 0;
+		script.loaded = false;
+		script.eventCallbackFunctionPtr = -1;
+		script.frameStepFunctionPtr = -1;
+
+		for(ConfigFile::SettingsMultiMap::iterator it = settings->begin(); it != settings->end(); it++)
+		{
+			if(it->first == "terrain")
+			{
+				script.terrain = it->second;
+			} else if(it->first == "events")
+			{
+				StringVector names = StringUtil::split(it->second, " ,\t");
+				for(unsigned int i = 0; i < names.size(); i++)
+				{
+					bool found = false;
+					for(int j = 0; scriptEventNames[j].name; j++)
+					{
+						if(names[i] != scriptEventNames[j].name) continue;
+						script.eventMask |= scriptEventNames[j].value;
+						found = true;
+						break;
+					}
+					if(!found) SLOG("unknown event '" + names[i] + "' in the manifest entry of " + filename);
+				}
+			}
+		}
+
+		lazyEventMask |= script.eventMask;
+		lazyScripts.push_back(script);
+	}
+	SLOG(TOSTRING(lazyScripts.size()) + " scripts found in the script manifest");
+}
+
+void ScriptEngine::activateTerrain(const Ogre::String &terrainScript)
+{
+	for(unsigned int i = 0; i < lazyScripts.size(); i++)
+		if(!lazyScripts[i].loaded && !lazyScripts[i].terrain.empty() && lazyScripts[i].terrain == terrainScript)
+			loadLazyScript(lazyScripts[i]);
+}
+
+int ScriptEngine::loadLazyScript(lazyScript_t &script)
+{
+	// only try once, a broken script should not be compiled again on every event
+	script.loaded = true;
+	lazyEventMask = 0;
+	for(unsigned int i = 0; i < lazyScripts.size(); i++)
+		if(!lazyScripts[i].loaded) lazyEventMask |= lazyScripts[i].eventMask;
+
+	if(!engine) return 1;
+	unsigned long start = OgreFramework::getSingleton().getTimeSinceStartup();
+
+	// every script gets its own module, so it can not break the others
+	OgreScriptBuilder builder;
+	builder.SetLoaderThreads(loaderThreads);
+	builder.SetSectionCache(&sectionCache);
+	int result = builder.StartNewModule(engine, script.filename.c_str());
+	if(result >= 0) result = builder.AddSectionFromFile(script.filename.c_str());
+	float saveTime = 0;
+	if(result >= 0) result = buildModule(builder, script.filename.c_str(), script.filename, saveTime);
+	if(result < 0)
 	{
-		loadScript(iterFiles->filename);
+		SLOG("Failed to build the script " + script.filename);
+		// the handlers of a module that was rebuilt before belong to the discarded module
+		script.eventCallbackFunctionPtr = -1;
+		script.frameStepFunctionPtr     = -1;
+		engine->DiscardModule(script.filename.c_str());
+		return 1;
 	}
-#endif //USE_ANGELSCRIPT
+	dependencies->setModule(script.filename, script.filename, builder.GetDependencies());
+
+	AngelScript::asIScriptModule *mod = engine->GetModule(script.filename.c_str(), AngelScript::asGM_ONLY_IF_EXISTS);
+	std::map<Ogre::String, int> handlers;
+	Ogre::Real hz = findHandlers(builder, mod, handlers);
+	if(hz > 0) setTickRate(script.filename, hz);
+	script.eventCallbackFunctionPtr = getHandler(handlers, "eventCallback");
+	script.frameStepFunctionPtr     = getHandler(handlers, "frameStep");
+
+	int funcId = getHandler(handlers, "main");
+	float mainTime = 0;
+	if(funcId > 0)
+	{
+		// the script might get loaded while another script is running, so use a fresh context
+		AngelScript::asIScriptContext *ctx = engine->CreateContext();
+		ctx->Prepare(funcId);
+		Ogre::Timer timer;
+		result = ctx->Execute();
+		mainTime = timer.getMicroseconds() / 1000.0f;
+		if(result == AngelScript::asEXECUTION_EXCEPTION)
+			SLOG("An exception '" + String(ctx->GetExceptionString()) + "' occurred in main() of " + script.filename);
+		ctx->Release();
+	}
+	logBuildStatistics(script.filename, builder.GetStatistics(), saveTime, mainTime);
+
+	SLOG("loaded script " + script.filename + " on demand in " + TOSTRING(OgreFramework::getSingleton().getTimeSinceStartup() - start) + " ms");
+	return 0;
 }
 
 void ScriptEngine::LineCallback(AngelScript::asIScriptContext *ctx, unsigned long *timeOut)
@@ -243,6 +446,11 @@ void ScriptEngine::init()
 		return;
 	}
 
+	components = new ScriptComponentManager(engine);
+	dependencies = new ScriptDependencies();
+	// update level of detail of the components, disabled unless a near distance is configured
+	components->setLodDistances(StringConverter::parseReal(SSETTING("Script LOD Near Distance")), StringConverter::parseReal(SSETTING("Script LOD Far Distance")), StringConverter::parseInt(SSETTING("Script LOD Interval")));
+
 	// AngelScript doesn't have a built-in string type, as there is no definite standard
 	// string type for C++ applications. Every developer is free to register it's own string type.
 	// The SDK do however provide a standard add-on for registering a string type, so it's not
@@ -250,6 +458,9 @@ void ScriptEngine::init()
 	AngelScript::RegisterScriptArray(engine, true);
 	AngelScript::RegisterStdString(engine);
 	AngelScript::RegisterScriptMath(engine);
+	AngelScript::RegisterScriptNoise(engine);
+	// the array overloads can trade precision for speed, see scriptmatharray.h for the error bounds
+	AngelScript::RegisterScriptMathArray(engine, BSETTING("Script Fast Math"));
 	AngelScript::RegisterScriptAny(engine);
 	AngelScript::RegisterScriptDictionary(engine);
 	//AngelScript::RegisterScriptString(engine);
@@ -263,44 +474,45 @@ void ScriptEngine::init()
 	registerLocalStorage(engine);
 
 	// some useful global functions
-	result = engine->RegisterGlobalFunction("void log(const string &in)", AngelScript::asFUNCTION(logString), AngelScript::asCALL_CDECL); MYASSERT( result >= 0 );
-	result = engine->RegisterGlobalFunction("void print(const string &in)", AngelScript::asFUNCTION(logString), AngelScript::asCALL_CDECL); MYASSERT( result >= 0 );
+	result = engine->RegisterGlobalFunction("void log(const string &in)", asPROFILED_FUNCTION(logString)); MYASSERT( result >= 0 );
+	result = engine->RegisterGlobalFunction("void print(const string &in)", asPROFILED_FUNCTION(logString)); MYASSERT( result >= 0 );
+	result = engine->RegisterGlobalFunction("void logNativeCallStatistics()", AngelScript::asFUNCTION(NativeCallProfiler::logStatistics), AngelScript::asCALL_CDECL); MYASSERT( result >= 0 );
 
 	// Register everything
 	// class Beam
 	result = engine->RegisterObjectType("BeamClass", sizeof(Beam), AngelScript::asOBJ_REF); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void scaleTruck(float)", AngelScript::asMETHOD(Beam,scaleTruck), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "string getTruckName()", AngelScript::asMETHOD(Beam,getTruckName), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void reset(bool)", AngelScript::asMETHOD(Beam,reset), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void setDetailLevel(int)", AngelScript::asMETHOD(Beam,setDetailLevel), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void showSkeleton(bool, bool)", AngelScript::asMETHOD(Beam,showSkeleton), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void hideSkeleton(bool)", AngelScript::asMETHOD(Beam,hideSkeleton), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void parkingbrakeToggle()", AngelScript::asMETHOD(Beam,parkingbrakeToggle), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void tractioncontrolToggle()", AngelScript::asMETHOD(Beam,tractioncontrolToggle), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void antilockbrakeToggle()", AngelScript::asMETHOD(Beam,antilockbrakeToggle), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void beaconsToggle()", AngelScript::asMETHOD(Beam,beaconsToggle), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void setReplayMode(bool)", AngelScript::asMETHOD(Beam,setReplayMode), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void resetAutopilot()", AngelScript::asMETHOD(Beam,resetAutopilot), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void toggleCustomParticles()", AngelScript::asMETHOD(Beam,toggleCustomParticles), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "float getDefaultDeformation()", AngelScript::asMETHOD(Beam,getDefaultDeformation), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "int getNodeCount()", AngelScript::asMETHOD(Beam,getNodeCount), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "float getTotalMass(bool)", AngelScript::asMETHOD(Beam,getTotalMass), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "int getWheelNodeCount()", AngelScript::asMETHOD(Beam,getWheelNodeCount), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void recalc_masses()", AngelScript::asMETHOD(Beam,recalc_masses), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void setMass(float)", AngelScript::asMETHOD(Beam,setMass), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "bool getBrakeLightVisible()", AngelScript::asMETHOD(Beam,getBrakeLightVisible), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "bool getCustomLightVisible(int)", AngelScript::asMETHOD(Beam,getCustomLightVisible), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void setCustomLightVisible(int, bool)", AngelScript::asMETHOD(Beam,setCustomLightVisible), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "bool getBeaconMode()", AngelScript::asMETHOD(Beam,getBeaconMode), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "void setBlinkType(int)", AngelScript::asMETHOD(Beam,setBlinkType), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "int getBlinkType()", AngelScript::asMETHOD(Beam,getBlinkType), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "bool getCustomParticleMode()", AngelScript::asMETHOD(Beam,getCustomParticleMode), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "int getLowestNode()", AngelScript::asMETHOD(Beam,getLowestNode), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "bool setMeshVisibility(bool)", AngelScript::asMETHOD(Beam,setMeshVisibility), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "bool getReverseLightVisible()", AngelScript::asMETHOD(Beam,getCustomParticleMode), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "float getHeadingDirectionAngle()", AngelScript::asMETHOD(Beam,getHeadingDirectionAngle), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "bool isLocked()", AngelScript::asMETHOD(Beam,isLocked), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("BeamClass", "float getWheelSpeed()", AngelScript::asMETHOD(Beam,getWheelSpeed), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void scaleTruck(float)", asPROFILED_METHOD(Beam,scaleTruck)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "string getTruckName()", asPROFILED_METHOD(Beam,getTruckName)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void reset(bool)", asPROFILED_METHOD(Beam,reset)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void setDetailLevel(int)", asPROFILED_METHOD(Beam,setDetailLevel)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void showSkeleton(bool, bool)", asPROFILED_METHOD(Beam,showSkeleton)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void hideSkeleton(bool)", asPROFILED_METHOD(Beam,hideSkeleton)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void parkingbrakeToggle()", asPROFILED_METHOD(Beam,parkingbrakeToggle)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void tractioncontrolToggle()", asPROFILED_METHOD(Beam,tractioncontrolToggle)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void antilockbrakeToggle()", asPROFILED_METHOD(Beam,antilockbrakeToggle)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void beaconsToggle()", asPROFILED_METHOD(Beam,beaconsToggle)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void setReplayMode(bool)", asPROFILED_METHOD(Beam,setReplayMode)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void resetAutopilot()", asPROFILED_METHOD(Beam,resetAutopilot)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void toggleCustomParticles()", asPROFILED_METHOD(Beam,toggleCustomParticles)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "float getDefaultDeformation()", asPROFILED_METHOD(Beam,getDefaultDeformation)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "int getNodeCount()", asPROFILED_METHOD(Beam,getNodeCount)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "float getTotalMass(bool)", asPROFILED_METHOD(Beam,getTotalMass)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "int getWheelNodeCount()", asPROFILED_METHOD(Beam,getWheelNodeCount)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void recalc_masses()", asPROFILED_METHOD(Beam,recalc_masses)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void setMass(float)", asPROFILED_METHOD(Beam,setMass)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "bool getBrakeLightVisible()", asPROFILED_METHOD(Beam,getBrakeLightVisible)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "bool getCustomLightVisible(int)", asPROFILED_METHOD(Beam,getCustomLightVisible)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void setCustomLightVisible(int, bool)", asPROFILED_METHOD(Beam,setCustomLightVisible)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "bool getBeaconMode()", asPROFILED_METHOD(Beam,getBeaconMode)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "void setBlinkType(int)", asPROFILED_METHOD(Beam,setBlinkType)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "int getBlinkType()", asPROFILED_METHOD(Beam,getBlinkType)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "bool getCustomParticleMode()", asPROFILED_METHOD(Beam,getCustomParticleMode)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "int getLowestNode()", asPROFILED_METHOD(Beam,getLowestNode)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "bool setMeshVisibility(bool)", asPROFILED_METHOD(Beam,setMeshVisibility)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "bool getReverseLightVisible()", asPROFILED_METHOD(Beam,getCustomParticleMode)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "float getHeadingDirectionAngle()", asPROFILED_METHOD(Beam,getHeadingDirectionAngle)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "bool isLocked()", asPROFILED_METHOD(Beam,isLocked)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("BeamClass", "float getWheelSpeed()", asPROFILED_METHOD(Beam,getWheelSpeed)); MYASSERT(result>=0);
 
 	
 	/*
@@ -381,97 +593,90 @@ void ScriptEngine::init()
 	result = engine->RegisterObjectProperty("BeamClass", "bool meshesVisible", offsetof(Beam, meshesVisible)); MYASSERT(result>=0);
 	*/
 
-	result = engine->RegisterObjectBehaviour("BeamClass", AngelScript::asBEHAVE_ADDREF, "void f()", AngelScript::asMETHOD(Beam,addRef), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectBehaviour("BeamClass", AngelScript::asBEHAVE_RELEASE, "void f()", AngelScript::asMETHOD(Beam,release), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
+	result = engine->RegisterObjectBehaviour("BeamClass", AngelScript::asBEHAVE_ADDREF, "void f()", asPROFILED_METHOD(Beam,addRef)); MYASSERT(result>=0);
+	result = engine->RegisterObjectBehaviour("BeamClass", AngelScript::asBEHAVE_RELEASE, "void f()", asPROFILED_METHOD(Beam,release)); MYASSERT(result>=0);
 
 	// class Settings
 	result = engine->RegisterObjectType("SettingsClass", sizeof(Settings), AngelScript::asOBJ_REF); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("SettingsClass", "string getSetting(const string &in)", AngelScript::asMETHOD(Settings,getSettingScriptSafe), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("SettingsClass", "void setSetting(const string &in, const string &in)", AngelScript::asMETHOD(Settings,setSettingScriptSafe), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectBehaviour("SettingsClass", AngelScript::asBEHAVE_ADDREF, "void f()", AngelScript::asMETHOD(Settings,addRef), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectBehaviour("SettingsClass", AngelScript::asBEHAVE_RELEASE, "void f()", AngelScript::asMETHOD(Settings,release), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("SettingsClass", "string getSetting(const string &in)", asPROFILED_METHOD(Settings,getSettingScriptSafe)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("SettingsClass", "void setSetting(const string &in, const string &in)", asPROFILED_METHOD(Settings,setSettingScriptSafe)); MYASSERT(result>=0);
+	result = engine->RegisterObjectBehaviour("SettingsClass", AngelScript::asBEHAVE_ADDREF, "void f()", asPROFILED_METHOD(Settings,addRef)); MYASSERT(result>=0);
+	result = engine->RegisterObjectBehaviour("SettingsClass", AngelScript::asBEHAVE_RELEASE, "void f()", asPROFILED_METHOD(Settings,release)); MYASSERT(result>=0);
 
 	// TODO: add Vector3 classes and other utility classes!
 
 	// class GameScript
 	result = engine->RegisterObjectType("GameScriptClass", sizeof(GameScript), AngelScript::asOBJ_VALUE | AngelScript::asOBJ_POD | AngelScript::asOBJ_APP_CLASS); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void log(const string &in)", AngelScript::asMETHOD(GameScript,log), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "double getTime()", AngelScript::asMETHOD(GameScript,getTime), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setPersonPosition(vector3)", AngelScript::asMETHOD(GameScript,setPersonPosition), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void loadTerrain(const string &in)", AngelScript::asMETHOD(GameScript,loadTerrain), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "vector3 getPersonPosition()", AngelScript::asMETHOD(GameScript,getPersonPosition), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void movePerson(float, float, float)", AngelScript::asMETHOD(GameScript,movePerson), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "string getCaelumTime()", AngelScript::asMETHOD(GameScript,getCaelumTime), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setCaelumTime(float)", AngelScript::asMETHOD(GameScript,setCaelumTime), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setWaterHeight(float)", AngelScript::asMETHOD(GameScript,setWaterHeight), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "float getWaterHeight()", AngelScript::asMETHOD(GameScript,getWaterHeight), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "float getGroundHeight(vector3)", AngelScript::asMETHOD(GameScript,getGroundHeight), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int getCurrentTruckNumber()", AngelScript::asMETHOD(GameScript,getCurrentTruckNumber), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void boostCurrentTruck(float)", AngelScript::asMETHOD(GameScript, boostCurrentTruck), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int getNumTrucks()", AngelScript::asMETHOD(GameScript,getNumTrucks), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "float getGravity()", AngelScript::asMETHOD(GameScript,getGravity), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setGravity(float)", AngelScript::asMETHOD(GameScript,setGravity), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void flashMessage(const string &in, float, float)", AngelScript::asMETHOD(GameScript,flashMessage), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setDirectionArrow(const string &in, vector3)", AngelScript::asMETHOD(GameScript,setDirectionArrow), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void hideDirectionArrow()", AngelScript::asMETHOD(GameScript,hideDirectionArrow), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void registerForEvent(int)", AngelScript::asMETHOD(GameScript,registerForEvent), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "BeamClass @getCurrentTruck()", AngelScript::asMETHOD(GameScript,getCurrentTruck), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "BeamClass @getTruckByNum(int)", AngelScript::asMETHOD(GameScript,getTruckByNum), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int getChatFontSize()", AngelScript::asMETHOD(GameScript,getChatFontSize), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setChatFontSize(int)", AngelScript::asMETHOD(GameScript,setChatFontSize), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void showChooser(const string &in, const string &in, const string &in)", AngelScript::asMETHOD(GameScript,showChooser), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void repairVehicle(const string &in, const string &in, bool)", AngelScript::asMETHOD(GameScript,repairVehicle), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void removeVehicle(const string &in, const string &in)", AngelScript::asMETHOD(GameScript,removeVehicle), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void spawnObject(const string &in, const string &in, vector3, vector3, const string &in, bool)", AngelScript::asMETHOD(GameScript,spawnObject), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void destroyObject(const string &in)", AngelScript::asMETHOD(GameScript,destroyObject), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int setMaterialAmbient(const string &in, float, float, float)", AngelScript::asMETHOD(GameScript,setMaterialAmbient), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int setMaterialDiffuse(const string &in, float, float, float, float)", AngelScript::asMETHOD(GameScript,setMaterialDiffuse), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int setMaterialSpecular(const string &in, float, float, float, float)", AngelScript::asMETHOD(GameScript,setMaterialSpecular), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int setMaterialEmissive(const string &in, float, float, float)", AngelScript::asMETHOD(GameScript,setMaterialEmissive), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int getNumTrucksByFlag(int)", AngelScript::asMETHOD(GameScript,getNumTrucksByFlag), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "bool getCaelumAvailable()", AngelScript::asMETHOD(GameScript,getCaelumAvailable), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void startTimer()", AngelScript::asMETHOD(GameScript,startTimer), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "float stopTimer()", AngelScript::asMETHOD(GameScript,stopTimer), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "float rangeRandom(float, float)", AngelScript::asMETHOD(GameScript,rangeRandom), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int useOnlineAPI(const string &in, const dictionary &in, string &out)", AngelScript::asMETHOD(GameScript,useOnlineAPI), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "int getLoadedTerrain(string &out)", AngelScript::asMETHOD(GameScript,getLoadedTerrain), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void clearEventCache()", AngelScript::asMETHOD(GameScript,clearEventCache), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraPosition(vector3)",  AngelScript::asMETHOD(GameScript,setCameraPosition),  AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraDirection(vector3)", AngelScript::asMETHOD(GameScript,setCameraDirection), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraYaw(float)",         AngelScript::asMETHOD(GameScript,setCameraYaw),       AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraPitch(float)",       AngelScript::asMETHOD(GameScript,setCameraPitch),     AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraRoll(float)",        AngelScript::asMETHOD(GameScript,setCameraRoll),      AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "vector3 getCameraPosition()",      AngelScript::asMETHOD(GameScript,getCameraPosition),  AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "vector3 getCameraDirection()",     AngelScript::asMETHOD(GameScript,getCameraDirection), AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
-	result = engine->RegisterObjectMethod("GameScriptClass", "void cameraLookAt(vector3)",       AngelScript::asMETHOD(GameScript,cameraLookAt),       AngelScript::asCALL_THISCALL); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void log(const string &in)", asPROFILED_METHOD(GameScript,log)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "double getTime()", asPROFILED_METHOD(GameScript,getTime)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setPersonPosition(vector3)", asPROFILED_METHOD(GameScript,setPersonPosition)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void loadTerrain(const string &in)", asPROFILED_METHOD(GameScript,loadTerrain)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "vector3 getPersonPosition()", asPROFILED_METHOD(GameScript,getPersonPosition)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void movePerson(float, float, float)", asPROFILED_METHOD(GameScript,movePerson)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "string getCaelumTime()", asPROFILED_METHOD(GameScript,getCaelumTime)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setCaelumTime(float)", asPROFILED_METHOD(GameScript,setCaelumTime)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setWaterHeight(float)", asPROFILED_METHOD(GameScript,setWaterHeight)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "float getWaterHeight()", asPROFILED_METHOD(GameScript,getWaterHeight)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "float getGroundHeight(vector3)", asPROFILED_METHOD(GameScript,getGroundHeight)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int getCurrentTruckNumber()", asPROFILED_METHOD(GameScript,getCurrentTruckNumber)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void boostCurrentTruck(float)", asPROFILED_METHOD(GameScript, boostCurrentTruck)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int getNumTrucks()", asPROFILED_METHOD(GameScript,getNumTrucks)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "float getGravity()", asPROFILED_METHOD(GameScript,getGravity)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setGravity(float)", asPROFILED_METHOD(GameScript,setGravity)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void flashMessage(const string &in, float, float)", asPROFILED_METHOD(GameScript,flashMessage)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setDirectionArrow(const string &in, vector3)", asPROFILED_METHOD(GameScript,setDirectionArrow)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void hideDirectionArrow()", asPROFILED_METHOD(GameScript,hideDirectionArrow)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void registerForEvent(int)", asPROFILED_METHOD(GameScript,registerForEvent)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "BeamClass @getCurrentTruck()", asPROFILED_METHOD(GameScript,getCurrentTruck)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "BeamClass @getTruckByNum(int)", asPROFILED_METHOD(GameScript,getTruckByNum)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int getChatFontSize()", asPROFILED_METHOD(GameScript,getChatFontSize)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setChatFontSize(int)", asPROFILED_METHOD(GameScript,setChatFontSize)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void showChooser(const string &in, const string &in, const string &in)", asPROFILED_METHOD(GameScript,showChooser)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void repairVehicle(const string &in, const string &in, bool)", asPROFILED_METHOD(GameScript,repairVehicle)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void removeVehicle(const string &in, const string &in)", asPROFILED_METHOD(GameScript,removeVehicle)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void spawnObject(const string &in, const string &in, vector3, vector3, const string &in, bool)", asPROFILED_METHOD(GameScript,spawnObject)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void destroyObject(const string &in)", asPROFILED_METHOD(GameScript,destroyObject)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int setMaterialAmbient(const string &in, float, float, float)", asPROFILED_METHOD(GameScript,setMaterialAmbient)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int setMaterialDiffuse(const string &in, float, float, float, float)", asPROFILED_METHOD(GameScript,setMaterialDiffuse)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int setMaterialSpecular(const string &in, float, float, float, float)", asPROFILED_METHOD(GameScript,setMaterialSpecular)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int setMaterialEmissive(const string &in, float, float, float)", asPROFILED_METHOD(GameScript,setMaterialEmissive)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int getNumTrucksByFlag(int)", asPROFILED_METHOD(GameScript,getNumTrucksByFlag)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "bool getCaelumAvailable()", asPROFILED_METHOD(GameScript,getCaelumAvailable)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void startTimer()", asPROFILED_METHOD(GameScript,startTimer)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "float stopTimer()", asPROFILED_METHOD(GameScript,stopTimer)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "float rangeRandom(float, float)", asPROFILED_METHOD(GameScript,rangeRandom)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int useOnlineAPI(const string &in, const dictionary &in, string &out)", asPROFILED_METHOD(GameScript,useOnlineAPI)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int getLoadedTerrain(string &out)", asPROFILED_METHOD(GameScript,getLoadedTerrain)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void clearEventCache()", asPROFILED_METHOD(GameScript,clearEventCache)); MYASSERT(result>=0);
+
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraPosition(vector3)",  asPROFILED_METHOD(GameScript,setCameraPosition)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraDirection(vector3)", asPROFILED_METHOD(GameScript,setCameraDirection)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraYaw(float)",         asPROFILED_METHOD(GameScript,setCameraYaw)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraPitch(float)",       asPROFILED_METHOD(GameScript,setCameraPitch)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setCameraRoll(float)",        asPROFILED_METHOD(GameScript,setCameraRoll)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "vector3 getCameraPosition()",      asPROFILED_METHOD(GameScript,getCameraPosition)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "vector3 getCameraDirection()",     asPROFILED_METHOD(GameScript,getCameraDirection)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void cameraLookAt(vector3)",       asPROFILED_METHOD(GameScript,cameraLookAt)); MYASSERT(result>=0);
+
+	result = engine->RegisterObjectMethod("GameScriptClass", "int attachComponent(const string &in, const string &in)", asPROFILED_METHOD(GameScript,attachComponent)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void detachComponent(int)",                               asPROFILED_METHOD(GameScript,detachComponent)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void detachComponents(const string &in)",                 asPROFILED_METHOD(GameScript,detachComponents)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void logComponentStatistics()",                           asPROFILED_METHOD(GameScript,logComponentStatistics)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setComponentPosition(const string &in, vector3)",    asPROFILED_METHOD(GameScript,setComponentPosition)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setComponentLod(float, float, int)",                 asPROFILED_METHOD(GameScript,setComponentLod)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int saveScriptState(const string &in)",                   asPROFILED_METHOD(GameScript,saveScriptState)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int loadScriptState(const string &in)",                   asPROFILED_METHOD(GameScript,loadScriptState)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "int resetScriptState()",                                  asPROFILED_METHOD(GameScript,resetScriptState)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void reloadChangedScripts()",                             asPROFILED_METHOD(GameScript,reloadChangedScripts)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "void setScriptTickRate(float)",                            asPROFILED_METHOD(GameScript,setScriptTickRate)); MYASSERT(result>=0);
+	result = engine->RegisterObjectMethod("GameScriptClass", "float getScriptTickRate()",                               asPROFILED_METHOD(GameScript,getScriptTickRate)); MYASSERT(result>=0);
 
 	// enum scriptEvents
 	result = engine->RegisterEnum("scriptEvents"); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_COLLISION_BOX_ENTER", SE_COLLISION_BOX_ENTER); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_COLLISION_BOX_LEAVE", SE_COLLISION_BOX_LEAVE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_ENTER", SE_TRUCK_ENTER); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_EXIT", SE_TRUCK_EXIT); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_ENGINE_DIED", SE_TRUCK_ENGINE_DIED); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_ENGINE_FIRE", SE_TRUCK_ENGINE_FIRE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_TOUCHED_WATER", SE_TRUCK_TOUCHED_WATER); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_BEAM_BROKE", SE_TRUCK_BEAM_BROKE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_LOCKED", SE_TRUCK_LOCKED); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_UNLOCKED", SE_TRUCK_UNLOCKED); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_LIGHT_TOGGLE", SE_TRUCK_LIGHT_TOGGLE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_SKELETON_TOGGLE", SE_TRUCK_SKELETON_TOGGLE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_TIE_TOGGLE", SE_TRUCK_TIE_TOGGLE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_PARKINGBREAK_TOGGLE", SE_TRUCK_PARKINGBREAK_TOGGLE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_TRACTIONCONTROL_TOGGLE", SE_TRUCK_TRACTIONCONTROL_TOGGLE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_ANTILOCKBRAKE_TOGGLE", SE_TRUCK_ANTILOCKBRAKE_TOGGLE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_BEACONS_TOGGLE", SE_TRUCK_BEACONS_TOGGLE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_CPARTICLES_TOGGLE", SE_TRUCK_CPARTICLES_TOGGLE); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_TRUCK_GROUND_CONTACT_CHANGED", SE_TRUCK_GROUND_CONTACT_CHANGED); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_GENERIC_NEW_TRUCK", SE_GENERIC_NEW_TRUCK); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_GENERIC_DELETED_TRUCK", SE_GENERIC_DELETED_TRUCK); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_GENERIC_INPUT_EVENT", SE_GENERIC_INPUT_EVENT); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_GENERIC_MOUSE_BEAM_INTERACTION", SE_GENERIC_MOUSE_BEAM_INTERACTION); MYASSERT(result>=0);
-	result = engine->RegisterEnumValue("scriptEvents", "SE_ALL_EVENTS", SE_ALL_EVENTS); MYASSERT(result>=0);
+	for(int i = 0; scriptEventNames[i].name; i++)
+	{
+		result = engine->RegisterEnumValue("scriptEvents", scriptEventNames[i].name, scriptEventNames[i].value); MYASSERT(result>=0);
+	}
 	
 
 	result = engine->RegisterEnum("truckStates"); MYASSERT(result>=0);
@@ -491,6 +696,225 @@ void ScriptEngine::init()
 	result = engine->RegisterGlobalProperty("SettingsClass settings", &SETTINGS); MYASSERT(result>=0);
 
 	SLOG("Type registrations done. If you see no error above everything should be working");
+
+	// cached bytecode is only valid for exactly this interface
+	interfaceFingerprint = AngelScript::GetConfigFingerprint(engine);
+
+	// the offline script compiler needs the interface to build the bundle that is shipped with the content
+	String interfaceFilename = SSETTING("Cache Path") + "scriptinterface.txt";
+	if(AngelScript::WriteConfigToFile(engine, interfaceFilename.c_str()) < 0)
+		SLOG("could not write the script interface to " + interfaceFilename);
+
+	// modules compiled at package time, this bundle is never written
+	precompiledBundle = new CBytecodeBundle();
+	precompiledBundle->open(SSETTING("Resources Path") + "scripts.bundle");
+	SLOG("precompiled script bundle holds " + TOSTRING(precompiledBundle->getModuleCount()) + " modules");
+
+	// all modules compiled on this machine live in one file
+	bytecodeBundle = new CBytecodeBundle();
+	String bundleFilename = SSETTING("Cache Path") + "scripts.bundle";
+	if(bytecodeBundle->open(bundleFilename))
+		SLOG("script bytecode bundle " + bundleFilename + " is damaged, it will be rebuilt");
+
+	// replaced modules and modules of older versions pile up, drop them once they take up half of the file
+	if(bytecodeBundle->getUnusedSize(interfaceFingerprint) * 2 > bytecodeBundle->getFileSize())
+	{
+		if(bytecodeBundle->compact(interfaceFingerprint))
+			SLOG("could not compact the script bytecode bundle " + bundleFilename);
+	}
+	SLOG("script bytecode bundle holds " + TOSTRING(bytecodeBundle->getModuleCount()) + " modules");
+
+	// the manifest scripts are loaded on demand, with or without the warm-up
+	exploreScripts();
+
+	// compile what is outdated while the menu is up, so the first session does not have to
+	if(SSETTING("Script Cache Warmup") != "No")
+		startCacheWarmup();
+}
+
+void ScriptEngine::startCacheWarmup()
+{
+	if(warmup || !bytecodeBundle) return;
+
+	std::stringstream config;
+	if(AngelScript::WriteConfigToStream(engine, config) < 0) return;
+
+	std::set<AngelScript::asQWORD> known;
+	bytecodeBundle->getSectionsHashes(interfaceFingerprint, known);
+	if(precompiledBundle) precompiledBundle->getSectionsHashes(interfaceFingerprint, known);
+
+	// only the scripts of the manifest and the terrain scripts they belong to are compiled
+	std::set<String> compile;
+	for(unsigned int i = 0; i < lazyScripts.size(); i++)
+	{
+		compile.insert(lazyScripts[i].filename);
+		if(!lazyScripts[i].terrain.empty()) compile.insert(lazyScripts[i].terrain);
+	}
+	if(compile.empty()) return;
+
+	warmup = new ScriptCacheWarmup(config.str(), known);
+
+	// the worker can not use the resource system, so the scripts are read here.
+	// The other scripts of the group are handed over as well, they might be included
+	FileInfoListPtr files = ResourceGroupManager::getSingleton().findResourceFileInfo("Scripts", "*.as", false);
+	for(std::set<String>::iterator it = compile.begin(); it != compile.end(); it++)
+		addWarmupSource(*it, true);
+	for(FileInfoList::iterator iterFiles = files->begin(); iterFiles != files->end(); ++iterFiles)
+	{
+		if(compile.find(iterFiles->filename) == compile.end())
+			addWarmupSource(iterFiles->filename, false);
+	}
+
+	if(warmup->start())
+	{
+		SLOG("could not start the script cache warm-up");
+		delete warmup;
+		warmup = 0;
+		return;
+	}
+	SLOG("script cache warm-up started for " + TOSTRING(compile.size()) + " scripts");
+}
+
+void ScriptEngine::addWarmupSource(const Ogre::String &filename, bool compile)
+{
+	try
+	{
+		DataStreamPtr ds = ResourceGroupManager::getSingleton().openResource(filename, "Scripts");
+		String code;
+		code.resize(ds->size());
+		if(!code.empty()) ds->read(&code[0], ds->size());
+		warmup->addSource(filename, code, compile);
+	} catch(Ogre::Exception& e)
+	{
+		SLOG("exception upon reading script file for the cache warm-up: " + e.getFullDescription());
+	}
+}
+
+float ScriptEngine::getCacheWarmupProgress()
+{
+	if(!warmup) return 1.0f;
+	unsigned int done = 0, total = 0;
+	warmup->getProgress(done, total);
+	return total ? (float)done / (float)total : 1.0f;
+}
+
+void ScriptEngine::pollCacheWarmup()
+{
+	if(!warmup) return;
+
+	ScriptCacheWarmup::result_t result;
+	while(warmup->popResult(result))
+	{
+		// the script might have been loaded and cached by the game in the meantime
+		if(bytecodeBundle->find(result.sectionsHash, interfaceFingerprint)) continue;
+		if(bytecodeBundle->append(result.name, result.sectionsHash, interfaceFingerprint, result.bytecode, compress_bytecode))
+			SLOG("could not add the bytecode of " + result.name + " to the script bytecode bundle");
+	}
+
+	if(warmup->isFinished())
+	{
+		warmup->logStatistics();
+		delete warmup;
+		warmup = 0;
+	}
+}
+
+Ogre::Real ScriptEngine::findHandlers(OgreScriptBuilder &builder, AngelScript::asIScriptModule *mod, std::map<Ogre::String, int> &handlers)
+{
+	Ogre::Real rate = 0;
+	int count = mod->GetFunctionCount();
+	for(int i = 0; i < count; i++)
+	{
+		int funcId = mod->GetFunctionIdByIndex(i);
+		AngelScript::asIScriptFunction *func = engine->GetFunctionDescriptorById(funcId);
+		if(!func) continue;
+
+		// an event attribute binds the function explicitly, otherwise its name has to match
+		String event = func->GetName();
+		String hz;
+		bool explicitEvent = false;
+		const std::vector<AngelScript::CScriptBuilder::SMetadataAttribute> &attributes = builder.GetAttributesForFunc(funcId);
+		for(unsigned int j = 0; j < attributes.size(); j++)
+		{
+			if(attributes[j].name == "event")
+			{
+				event = attributes[j].value;
+				explicitEvent = true;
+			}
+			else if(attributes[j].name == "hz")
+				hz = attributes[j].value;
+		}
+
+		for(unsigned int j = 0; j < sizeof(scriptHandlers) / sizeof(scriptHandlers[0]); j++)
+		{
+			if(event != scriptHandlers[j].event) continue;
+
+			String decl = String("void ") + func->GetName() + scriptHandlers[j].params;
+			if(decl != func->GetDeclaration())
+			{
+				if(explicitEvent)
+					SLOG("function " + String(func->GetDeclaration()) + " can not handle the event " + event + ", it needs the parameters " + scriptHandlers[j].params);
+				break;
+			}
+
+			handlers[event] = funcId;
+			if(event == "frameStep" && !hz.empty())
+				rate = StringConverter::parseReal(hz);
+			break;
+		}
+	}
+	return rate;
+}
+
+int ScriptEngine::buildModule(OgreScriptBuilder &builder, const char *module, const Ogre::String &scriptname, float &saveTime)
+{
+	// the bundle is keyed by the preprocessed code, the entry also has to match the registered interface
+	AngelScript::asQWORD sectionsHash = builder.GetSectionsHash();
+	CBytecodeBundle *bundles[2] = { precompiledBundle, bytecodeBundle };
+	for(int i = 0; i < 2; i++)
+	{
+		const bundleEntry_t *entry = bundles[i] ? bundles[i]->find(sectionsHash, interfaceFingerprint) : 0;
+		if(!entry) continue;
+
+		std::vector<char> unpacked;
+		CBytecodeReadStream bstream(bundles[i]->getBytecode(entry, unpacked), (size_t)entry->rawLength, entry->checksum);
+		int result = bstream.IsValid() ? builder.LoadModule(&bstream) : -1;
+		if(result >= 0 && !bstream.Failed())
+			return 0;
+
+		SLOG("precompiled bytecode of " + scriptname + " is not usable, ignoring it");
+		if(result >= 0)
+		{
+			// the module was loaded from incomplete data, start over
+			builder.StartNewModule(engine, module);
+			builder.AddSectionFromFile(scriptname.c_str());
+		}
+	}
+
+	// not cached so compile it
+	int result = builder.BuildModule();
+	if(result < 0) return result;
+
+	if(bytecodeBundle)
+	{
+		// the stream only collects the bytecode, it is written into the bundle
+		Ogre::Timer timer;
+		AngelScript::asIScriptModule *mod = engine->GetModule(module, AngelScript::asGM_ONLY_IF_EXISTS);
+		CBytecodeStream bstream("", sectionsHash, interfaceFingerprint);
+		if(mod->SaveByteCode(&bstream) < 0 || bytecodeBundle->append(scriptname, sectionsHash, interfaceFingerprint, bstream.getBytecode(), compress_bytecode))
+			SLOG("could not add the bytecode of " + scriptname + " to the script bytecode bundle");
+		saveTime = timer.getMicroseconds() / 1000.0f;
+	}
+	return 0;
+}
+
+void ScriptEngine::logBuildStatistics(const Ogre::String &scriptname, const AngelScript::CScriptBuilder::SBuildStatistics &stats, float saveTime, float mainTime)
+{
+	SLOG(scriptname + ": " + TOSTRING(stats.sections) + " sections (" + TOSTRING(stats.cachedSections) + " preprocessed before), "
+		+ TOSTRING(stats.lines) + " lines, " + TOSTRING(stats.bytes) + " bytes, " + TOSTRING(stats.tokens) + " tokens");
+	SLOG(scriptname + ": read " + TOSTRING((float)stats.readTime) + " ms, preprocess " + TOSTRING((float)stats.preprocessTime) + " ms, metadata " + TOSTRING((float)stats.metadataTime)
+		+ " ms, add sections " + TOSTRING((float)stats.addSectionTime) + " ms, build " + TOSTRING((float)stats.buildTime) + " ms, load bytecode " + TOSTRING((float)stats.loadTime)
+		+ " ms, save bytecode " + TOSTRING(saveTime) + " ms, main() " + TOSTRING(mainTime) + " ms");
 }
 
 void ScriptEngine::msgCallback(const AngelScript::asSMessageInfo *msg)
@@ -571,25 +995,139 @@ int ScriptEngine::framestep(Ogre::Real dt)
 
 #endif // 0
 
-	// framestep stuff below
-	if(frameStepFunctionPtr<=0) return 1;
 	if(!engine) return 0;
 	if(!context) context = engine->CreateContext();
-	context->Prepare(frameStepFunctionPtr);
 
-	// Set the function arguments
+	pollCacheWarmup();
+	pollScriptChanges(dt);
+
+#ifdef AS_PROFILE_NATIVE_CALLS
+	NativeCallProfiler::frameStep();
+#endif //AS_PROFILE_NATIVE_CALLS
+
+	// the main module and every script of the manifest run at their own update rate
+	stepModule(moduleName, -1, dt);
+	for(unsigned int i = 0; i < lazyScripts.size(); i++)
+		if(lazyScripts[i].frameStepFunctionPtr > 0)
+			stepModule(lazyScripts[i].filename, i, dt);
+	return 0;
+}
+
+void ScriptEngine::stepModule(const Ogre::String &module, int lazyScript, Ogre::Real dt)
+{
+	Ogre::Real rate = getTickRate(module);
+	if(rate <= 0)
+	{
+		// no fixed rate, update once per rendered frame
+		tickModule(lazyScript, dt);
+		return;
+	}
+
+	scriptTick_t &t = ticks[module];
+	Ogre::Real step = 1.0f / rate;
+	t.accumulator += dt;
+
+	// don't try to catch up forever after a hitch
+	if(t.accumulator > step * MAX_SCRIPT_TICKS_PER_FRAME)
+		t.accumulator = step * MAX_SCRIPT_TICKS_PER_FRAME;
+
+	// a rate the script sets while ticking only takes effect after this frame's updates
+	t.ticking = true;
+	while(t.accumulator >= step)
+	{
+		tickModule(lazyScript, step);
+		t.accumulator -= step;
+	}
+	t.ticking = false;
+	if(t.ratePending)
+	{
+		t.ratePending = false;
+		setTickRate(module, t.pendingRate);
+		return;
+	}
+
+	// let the script smooth things out between two fixed updates
+	if(lazyScript < 0 && frameInterpolateFunctionPtr > 0)
+	{
+		context->Prepare(frameInterpolateFunctionPtr);
+		context->SetArgFloat(0, t.accumulator / step);
+		context->Execute();
+	}
+}
+
+void ScriptEngine::tickModule(int lazyScript, Ogre::Real dt)
+{
+	if(lazyScript < 0)
+	{
+		tick(dt);
+		return;
+	}
+
+	int funcId = lazyScripts[lazyScript].frameStepFunctionPtr;
+	if(funcId <= 0) return;
+	context->Prepare(funcId);
 	context->SetArgFloat(0, dt);
+	context->Execute();
+}
 
-	//SLOG("Executing framestep()");
-	int r = context->Execute();
-	if( r == AngelScript::asEXECUTION_FINISHED )
+int ScriptEngine::tick(Ogre::Real dt)
+{
+	// framestep stuff below
+	if(frameStepFunctionPtr > 0)
 	{
-	  // The return value is only valid if the execution finished successfully
-		AngelScript::asDWORD ret = context->GetReturnDWord();
+		context->Prepare(frameStepFunctionPtr);
+
+		// Set the function arguments
+		context->SetArgFloat(0, dt);
+
+		//SLOG("Executing framestep()");
+		int r = context->Execute();
+		if( r == AngelScript::asEXECUTION_FINISHED )
+		{
+		  // The return value is only valid if the execution finished successfully
+			AngelScript::asDWORD ret = context->GetReturnDWord();
+		}
+	}
+
+	// then the per-object behaviours, batched by their update function
+	if(components)
+	{
+		Ogre::Vector3 cameraPos = Ogre::Vector3::ZERO;
+		if(mefl && mefl->getCamera()) cameraPos = mefl->getCamera()->getPosition();
+		components->update(context, dt, cameraPos);
 	}
+
 	return 0;
 }
 
+void ScriptEngine::setTickRate(const Ogre::String &module, Ogre::Real hz)
+{
+	scriptTick_t &t = ticks[module];
+	if(t.ticking)
+	{
+		t.ratePending = true;
+		t.pendingRate = hz;
+		return;
+	}
+	t.rate = std::max(hz, 0.0f);
+	t.accumulator = 0;
+}
+
+Ogre::Real ScriptEngine::getTickRate(const Ogre::String &module)
+{
+	std::map <Ogre::String, scriptTick_t>::iterator it = ticks.find(module);
+	if(it == ticks.end())
+	{
+		scriptTick_t t;
+		t.rate = defaultTickRate;
+		t.accumulator = 0;
+		t.ticking = false;
+		t.ratePending = false;
+		t.pendingRate = 0;
+		it = ticks.insert(std::map <Ogre::String, scriptTick_t>::value_type(module, t)).first;
+	}
+	return it->second.rate;
+}
 
 int ScriptEngine::envokeCallback(int functionPtr, eventsource_t *source, node_t *node, int type)
 {
@@ -645,6 +1183,27 @@ int ScriptEngine::executeString(Ogre::String command)
 void ScriptEngine::triggerEvent(int eventnum, int value)
 {
 	if(!engine) return;
+
+	// first load the scripts that wait for this event, so they get it as well
+	if(lazyEventMask & eventnum)
+	{
+		for(unsigned int i = 0; i < lazyScripts.size(); i++)
+			if(!lazyScripts[i].loaded && (lazyScripts[i].eventMask & eventnum))
+				loadLazyScript(lazyScripts[i]);
+	}
+
+	for(unsigned int i = 0; i < lazyScripts.size(); i++)
+	{
+		lazyScript_t &script = lazyScripts[i];
+		if(script.eventCallbackFunctionPtr <= 0 || !(script.eventMask & eventnum)) continue;
+
+		if(!context) context = engine->CreateContext();
+		context->Prepare(script.eventCallbackFunctionPtr);
+		context->SetArgDWord(0, eventnum);
+		context->SetArgDWord(1, value);
+		context->Execute();
+	}
+
 	if(eventCallbackFunctionPtr<=0) return;
 	if(eventMask & eventnum)
 	{
@@ -675,88 +1234,88 @@ int ScriptEngine::loadScript(Ogre::String scriptname)
 	// search for #include directives, and load any included files as 
 	// well.
 	OgreScriptBuilder builder;
+	builder.SetLoaderThreads(loaderThreads);
+	builder.SetSectionCache(&sectionCache);
+
+	// the module gets rebuilt, so all function ids the components use become invalid
+	if(components) components->clear();
+	initialState.clear();
+
+	// the same goes for the handlers, they stay unset if the new module fails to build
+	frameStepFunctionPtr            = -1;
+	frameInterpolateFunctionPtr     = -1;
+	wheelEventFunctionPtr           = -1;
+	eventCallbackFunctionPtr        = -1;
+	defaultEventCallbackFunctionPtr = -1;
 
 	AngelScript::asIScriptModule *mod = 0;
-	// try to load bytecode
-	bool cached = false;
-	{
-		// the code below should load a compilation result but it crashes for some reason atm ...
-		//AngelScript::asIScriptModule *mod = engine->GetModule("RoRScript", AngelScript::asGM_ALWAYS_CREATE);
-		/*
-		String fn = SSETTING("Cache Path") + "script" + hash + "_" + scriptname + "c";
-		CBytecodeStream bstream(fn);
-		if(bstream.Existing())
-		{
-			// CRASHES here :(
-			int res = mod->LoadByteCode(&bstream);
-			cached = !res;
-		}
-		*/
-	}
-	if(!cached)
+
+	// load and preprocess the script, this is needed to know if the cached bytecode is still valid
+	result = builder.StartNewModule(engine, moduleName);
+	if( result < 0 )
 	{
-		// not cached so dynamically load and compile it
-		result = builder.StartNewModule(engine, moduleName);
-		if( result < 0 )
-		{
-			SLOG("Failed to start new module");
-			return result;
-		}
+		SLOG("Failed to start new module");
+		return result;
+	}
 
-		mod = engine->GetModule(moduleName, AngelScript::asGM_ONLY_IF_EXISTS);
+	result = builder.AddSectionFromFile(scriptname.c_str());
+	if( result < 0 )
+	{
+		SLOG("Unkown error while loading script file: "+scriptname);
+		SLOG("Failed to add script file");
+		return result;
+	}
 
-		result = builder.AddSectionFromFile(scriptname.c_str());
-		if( result < 0 )
-		{
-			SLOG("Unkown error while loading script file: "+scriptname);
-			SLOG("Failed to add script file");
-			return result;
-		}
-		result = builder.BuildModule();
-		if( result < 0 )
-		{
-			SLOG("Failed to build the module");
-			return result;
-		}
+	// take what the warm-up compiled so far, the script might be among it
+	pollCacheWarmup();
 
-		// save the bytecode
-		string hash = "";
-		// TODO: fix hash!
-		{
-			String fn = SSETTING("Cache Path") + "script" + hash + "_" + scriptname + "c";
-			SLOG("saving script bytecode to file " + fn);
-			CBytecodeStream bstream(fn);
-			mod->SaveByteCode(&bstream);
-		}
+	// load the precompiled module or compile it
+	float saveTime = 0;
+	result = buildModule(builder, moduleName, scriptname, saveTime);
+	if( result < 0 )
+	{
+		SLOG("Failed to build the module");
+		return result;
 	}
+	dependencies->setModule(moduleName, scriptname, builder.GetDependencies());
+
+	mod = engine->GetModule(moduleName, AngelScript::asGM_ONLY_IF_EXISTS);
 
-	// get some other optional functions
-	frameStepFunctionPtr = mod->GetFunctionIdByDecl("void frameStep(float)");
+	// get some other optional functions, all of them are found in one pass over the module
+	std::map<Ogre::String, int> handlers;
+	Ogre::Real hz = findHandlers(builder, mod, handlers);
+	if(hz > 0) setTickRate(moduleName, hz);
+
+	frameStepFunctionPtr = getHandler(handlers, "frameStep");
 	if(frameStepFunctionPtr > 0) callbacks["frameStep"].push_back(frameStepFunctionPtr);
+
+	frameInterpolateFunctionPtr = getHandler(handlers, "frameInterpolate");
 	
-	wheelEventFunctionPtr = mod->GetFunctionIdByDecl("void wheelEvents(int, string, string, string)");
+	wheelEventFunctionPtr = getHandler(handlers, "wheelEvents");
 	if(wheelEventFunctionPtr > 0) callbacks["wheelEvents"].push_back(wheelEventFunctionPtr);
 
-	eventCallbackFunctionPtr = mod->GetFunctionIdByDecl("void eventCallback(int, int)");
+	eventCallbackFunctionPtr = getHandler(handlers, "eventCallback");
 	if(eventCallbackFunctionPtr > 0) callbacks["eventCallback"].push_back(eventCallbackFunctionPtr);
 
-	defaultEventCallbackFunctionPtr = mod->GetFunctionIdByDecl("void defaultEventCallback(int, string, string, int)");
+	defaultEventCallbackFunctionPtr = getHandler(handlers, "defaultEventCallback");
 	if(defaultEventCallbackFunctionPtr > 0) callbacks["defaultEventCallback"].push_back(defaultEventCallbackFunctionPtr);
 
-	int cb = mod->GetFunctionIdByDecl("void on_terrain_loading(string lines)");
+	int cb = getHandler(handlers, "on_terrain_loading");
 	if(cb > 0) callbacks["on_terrain_loading"].push_back(cb);
 
 	// Find the function that is to be called.
-	int funcId = mod->GetFunctionIdByDecl("void main()");
+	int funcId = getHandler(handlers, "main");
 	if( funcId < 0 )
 	{
 		// The function couldn't be found. Instruct the script writer to include the
 		// expected function in the script.
 		SLOG("The script should have the function 'void main()'.");
+		logBuildStatistics(scriptname, builder.GetStatistics(), saveTime, 0);
 		return 0;
 	}
 
 	// Create our context, prepare it, and then execute
+	if(context) context->Release();
 	context = engine->CreateContext();
 
 
@@ -798,7 +1357,9 @@ int ScriptEngine::loadScript(Ogre::String scriptname)
 	timeOut = OgreFramework::getSingleton().getTimeSinceStartup() + 1000;
 
 	SLOG("Executing main()");
+	Ogre::Timer mainTimer;
 	result = context->Execute();
+	logBuildStatistics(scriptname, builder.GetStatistics(), saveTime, mainTimer.getMicroseconds() / 1000.0f);
 	if( result != AngelScript::asEXECUTION_FINISHED )
 	{
 		// The execution didn't complete as expected. Determine what happened.
@@ -826,7 +1387,109 @@ int ScriptEngine::loadScript(Ogre::String scriptname)
 	} else
 	{
 		SLOG("The script finished successfully.");
+
+		// remember the initial state, so the script can be reset without running it again
+		ScriptSnapshot snapshot(engine);
+		snapshot.save(mod, initialState);
 	}
 
+	// the terrain is active now, load the scripts that belong to it
+	activateTerrain(scriptname);
+
+	return 0;
+}
+
+int ScriptEngine::reloadChangedScripts()
+{
+	if(!engine || !dependencies) return 0;
+
+	std::map<Ogre::String, Ogre::String> outdated;
+	int changed = dependencies->findOutdatedModules(outdated);
+	if(outdated.empty()) return 0;
+	SLOG(TOSTRING(changed) + " script files changed, rebuilding " + TOSTRING(outdated.size()) + " of " + TOSTRING(dependencies->getModuleCount()) + " modules");
+
+	int rebuilt = 0;
+	for(std::map<Ogre::String, Ogre::String>::iterator it = outdated.begin(); it != outdated.end(); it++)
+	{
+		if(it->first == moduleName)
+		{
+			// the handlers of the main module get bound again
+			for(std::map<std::string, std::vector<int> >::iterator cit = callbacks.begin(); cit != callbacks.end(); cit++)
+				cit->second.clear();
+			if(!loadScript(it->second)) rebuilt++;
+			continue;
+		}
+
+		for(unsigned int i = 0; i < lazyScripts.size(); i++)
+		{
+			if(lazyScripts[i].filename != it->first) continue;
+			if(!loadLazyScript(lazyScripts[i])) rebuilt++;
+			break;
+		}
+	}
+	return rebuilt;
+}
+
+void ScriptEngine::pollScriptChanges(Ogre::Real dt)
+{
+	reloadTimer += dt;
+	bool due = (reloadInterval > 0 && reloadTimer >= reloadInterval);
+	if(!reloadRequested && !due) return;
+
+	// hashing the files costs a bit, so it is not done every frame
+	reloadRequested = false;
+	reloadTimer = 0;
+	reloadChangedScripts();
+}
+
+int ScriptEngine::resetScript()
+{
+	if(!engine || initialState.empty()) return 1;
+	AngelScript::asIScriptModule *mod = engine->GetModule(moduleName, AngelScript::asGM_ONLY_IF_EXISTS);
+	if(!mod) return 1;
+
+	ScriptSnapshot snapshot(engine);
+	return (snapshot.restore(mod, initialState) < 0) ? 1 : 0;
+}
+
+Ogre::String ScriptEngine::getStateFilename(const Ogre::String &name)
+{
+	// same whitelist as the local storage
+	String safeName = name;
+	String allowedChars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-";
+	for(String::iterator it = safeName.begin(); it != safeName.end(); ++it)
+		if(allowedChars.find(*it) == String::npos)
+			*it = '_';
+	return SSETTING("Cache Path") + "scriptstate_" + safeName + ".bin";
+}
+
+int ScriptEngine::saveState(const Ogre::String &name)
+{
+	if(!engine) return 1;
+	AngelScript::asIScriptModule *mod = engine->GetModule(moduleName, AngelScript::asGM_ONLY_IF_EXISTS);
+	if(!mod) return 1;
+
+	std::vector<char> blob;
+	ScriptSnapshot snapshot(engine);
+	if(snapshot.save(mod, blob) < 0) return 1;
+	return ScriptSnapshot::saveToFile(blob, getStateFilename(name));
+}
+
+int ScriptEngine::loadState(const Ogre::String &name)
+{
+	if(!engine) return 1;
+	AngelScript::asIScriptModule *mod = engine->GetModule(moduleName, AngelScript::asGM_ONLY_IF_EXISTS);
+	if(!mod) return 1;
+
+	std::vector<char> blob;
+	if(ScriptSnapshot::loadFromFile(blob, getStateFilename(name))) return 1;
+
+	ScriptSnapshot snapshot(engine);
+	int res = snapshot.restore(mod, blob);
+	if(res < 0)
+	{
+		SLOG("invalid script state: " + name);
+		return 1;
+	}
 	return 0;
 }
@@ -53,6 +53,11 @@ THE SOFTWARE.
  */
 
 class GameScript;
+class ScriptComponentManager;
+class CBytecodeBundle;
+class ScriptCacheWarmup;
+class ScriptDependencies;
+class OgreScriptBuilder;
 
 /**
  *  @brief This class represents the angelscript scripting interface. It can load and execute scripts.
@@ -80,6 +85,23 @@ public:
 	 */
 	int framestep(Ogre::Real dt);
 
+	/**
+	 * sets the rate at which the script logic of a module is updated. With a fixed rate, frameStep
+	 * and the components are called with a constant time step as often as needed to keep up with
+	 * the rendered frames, so the script cost does not grow with the framerate.
+	 * If the script has a function void frameInterpolate(float alpha), it is called once per rendered
+	 * frame with the fraction of the next fixed step that has already passed.
+	 * A rate set from within the fixed updates takes effect once the updates of the frame are done.
+	 * @param module name of the module
+	 * @param hz updates per second, 0 to update once per rendered frame with the frame time
+	 */
+	void setTickRate(const Ogre::String &module, Ogre::Real hz);
+
+	/**
+	 * @return the update rate of a module in updates per second, 0 if it is updated once per rendered frame
+	 */
+	Ogre::Real getTickRate(const Ogre::String &module);
+
 	unsigned int eventMask;                              //!< filter mask for script events
 	
 	/**
@@ -96,7 +118,47 @@ public:
 
 	int envokeCallback(int functionPtr, eventsource_t *source, node_t *node=0, int type=0);
 
+	/**
+	 * puts all global variables of the script back into the state they had after main() finished,
+	 * without recompiling the script or running main() again
+	 * @return 0 on success
+	 */
+	int resetScript();
+
+	/**
+	 * writes a binary snapshot of all global script variables to the cache
+	 * @param name name of the snapshot, only letters, digits, '_' and '-' are used
+	 * @return 0 on success
+	 */
+	int saveState(const Ogre::String &name);
+
+	/**
+	 * restores the global script variables from a snapshot written by saveState()
+	 * @param name name of the snapshot
+	 * @return 0 on success
+	 */
+	int loadState(const Ogre::String &name);
+
+	/**
+	 * rebuilds the modules whose script or one of its includes changed since they were built,
+	 * all other modules keep running untouched
+	 * @return number of rebuilt modules
+	 */
+	int reloadChangedScripts();
+
+	/**
+	 * rebuilds the changed modules at the start of the next frame. Scripts call this, the
+	 * module that is running the call can not be rebuilt right away
+	 */
+	void requestScriptReload() { reloadRequested = true; };
+
+	/**
+	 * @return fraction of the scripts the background cache warm-up has processed, 1 if it is not running
+	 */
+	float getCacheWarmupProgress();
+
 	AngelScript::asIScriptEngine *getEngine() { return engine; };
+	ScriptComponentManager *getComponents() { return components; };
 
 	Ogre::String getTerrainName() { return terrainScriptName; };
 	Ogre::String getTerrainScriptHash() { return terrainScriptHash; };
@@ -104,8 +166,23 @@ public:
 	// method from Ogre::LogListener
 	virtual void messageLogged( const Ogre::String& message, Ogre::LogMessageLevel lml, bool maskDebug, const Ogre::String &logName );
 
+	/**
+	 * reads the script manifest (scripts.manifest in the Scripts resource group). The scripts listed
+	 * there are not loaded right away, but compiled into their own module when one of their events
+	 * fires for the first time or when the terrain script they belong to gets loaded:
+	 *   [myscript.as]
+	 *   events = SE_TRUCK_ENTER SE_TRUCK_EXIT
+	 *   terrain = myterrain.as
+	 * Reading the manifest again keeps the scripts that are loaded already.
+	 */
 	void exploreScripts();
 
+	/**
+	 * loads all manifest scripts that belong to a terrain script
+	 * @param terrainScript file name of the terrain script
+	 */
+	void activateTerrain(const Ogre::String &terrainScript);
+
 
 	Ogre::Log *scriptLog;
 
@@ -114,13 +191,50 @@ protected:
 	Collisions *coll;
     AngelScript::asIScriptEngine *engine;                //!< instance of the scripting engine
 	AngelScript::asIScriptContext *context;              //!< context in which all scripting happens
+	ScriptComponentManager *components;                  //!< per-object script behaviours, updated in batches
+	CBytecodeBundle *bytecodeBundle;                     //!< modules compiled on this machine, mapped once
+	CBytecodeBundle *precompiledBundle;                  //!< modules compiled by the offline script compiler, shipped with the content
+	ScriptCacheWarmup *warmup;                           //!< background compilation of outdated cache entries, 0 when done
+	ScriptDependencies *dependencies;                    //!< sections every module was built from, to rebuild only what changed
 	int frameStepFunctionPtr;               //!< script function pointer to the frameStep function
+	int frameInterpolateFunctionPtr;        //!< script function pointer to the optional frameInterpolate function
 	int wheelEventFunctionPtr;               //!< script function pointer
 	int eventCallbackFunctionPtr;           //!< script function pointer to the event callback function
 	int defaultEventCallbackFunctionPtr;    //!< script function pointer for spawner events
 	Ogre::String terrainScriptName, terrainScriptHash;
 	std::map <std::string , std::vector<int> > callbacks;
 	bool enable_ingame_console;
+	bool compress_bytecode;                 //!< store the bytecode of compiled scripts compressed
+	int loaderThreads;                      //!< threads reading and preprocessing included script files
+	AngelScript::CScriptBuilder::CSectionCache sectionCache; //!< preprocessed script sections, shared by all modules
+
+	struct scriptTick_t
+	{
+		Ogre::Real rate;                        //!< fixed updates per second, 0 for one update per rendered frame
+		Ogre::Real accumulator;                 //!< frame time not yet consumed by fixed updates
+		bool ticking;                           //!< true while the fixed updates of a frame run
+		bool ratePending;                       //!< the script changed the rate while ticking, see pendingRate
+		Ogre::Real pendingRate;                 //!< rate that takes effect once the running updates are done
+	};
+	std::map <Ogre::String, scriptTick_t> ticks; //!< update rate per module
+	std::vector<char> initialState;              //!< snapshot of the globals right after main() finished
+
+	struct lazyScript_t
+	{
+		Ogre::String filename;                  //!< script file, also used as module name
+		Ogre::String terrain;                   //!< terrain script that activates this script, empty for none
+		unsigned int eventMask;                 //!< events that trigger the loading and get forwarded to the script
+		bool loaded;                            //!< true once the loading was attempted
+		int eventCallbackFunctionPtr;           //!< script function pointer to the eventCallback function of the module
+		int frameStepFunctionPtr;               //!< script function pointer to the frameStep function of the module
+	};
+	std::vector<lazyScript_t> lazyScripts;       //!< scripts from the manifest
+	unsigned int lazyEventMask;                  //!< events some not yet loaded script waits for
+	Ogre::Real defaultTickRate;                  //!< update rate for modules without an explicit one
+	AngelScript::asQWORD interfaceFingerprint;   //!< hash of the registered application interface, part of the bytecode cache key
+	Ogre::Real reloadInterval;                   //!< seconds between two checks for changed script files, 0 to only reload on request
+	Ogre::Real reloadTimer;                      //!< seconds since the last check for changed script files
+	bool reloadRequested;                        //!< rebuild the changed modules at the start of the next frame
 
 	static char *moduleName;
 
@@ -130,6 +244,81 @@ protected:
 	 */
     void init();
 
+	/**
+	 * builds the module of a builder that has all sections added, the bytecode bundle is used if it has the module
+	 * @param builder builder with the preprocessed script
+	 * @param module name of the module
+	 * @param scriptname script file the sections came from
+	 * @param saveTime receives the time in ms it took to store the compiled bytecode
+	 * @return 0 on success, negative value on error
+	 */
+	int buildModule(OgreScriptBuilder &builder, const char *module, const Ogre::String &scriptname, float &saveTime);
+
+	/**
+	 * writes what loading a script cost, phase by phase, to the script log
+	 * @param scriptname script file the module was built from
+	 * @param stats statistics of the builder that built or loaded the module
+	 * @param saveTime time in ms it took to store the compiled bytecode
+	 * @param mainTime time in ms main() ran
+	 */
+	void logBuildStatistics(const Ogre::String &scriptname, const AngelScript::CScriptBuilder::SBuildStatistics &stats, float saveTime, float mainTime);
+
+	/**
+	 * finds the script functions the engine calls in one pass over the module. A function is bound to an
+	 * event by an [event name] attribute or, without one, by its own name:
+	 *   [event frameStep, hz 10]
+	 *   void update(float dt) {}
+	 * a hz attribute on the frameStep handler sets the update rate of the module
+	 * @param builder builder the module was built or loaded with, it has the metadata
+	 * @param mod module to search
+	 * @param handlers receives the function id per event name
+	 * @return update rate requested by the frameStep handler, 0 if it requests none
+	 */
+	Ogre::Real findHandlers(OgreScriptBuilder &builder, AngelScript::asIScriptModule *mod, std::map<Ogre::String, int> &handlers);
+
+	/**
+	 * starts compiling the scripts of the manifest and their terrain scripts whose bytecode is not cached yet in the background
+	 */
+	void startCacheWarmup();
+
+	/**
+	 * reads a script for the warm-up
+	 * @param compile false for files that are only included
+	 */
+	void addWarmupSource(const Ogre::String &filename, bool compile);
+
+	/**
+	 * adds the modules the warm-up compiled so far to the bytecode bundle
+	 */
+	void pollCacheWarmup();
+
+	/**
+	 * rebuilds the changed modules when requested or when the reload interval passed
+	 * @param dt time passed since the last frame in seconds
+	 */
+	void pollScriptChanges(Ogre::Real dt);
+
+	/**
+	 * runs the updates of a module that are due this frame, at the update rate of the module
+	 * @param module name of the module
+	 * @param lazyScript index of the script in lazyScripts, -1 for the main module
+	 * @param dt time passed since the last frame in seconds
+	 */
+	void stepModule(const Ogre::String &module, int lazyScript, Ogre::Real dt);
+
+	/**
+	 * runs one update of a module, see tick() for the main module
+	 * @param lazyScript index of the script in lazyScripts, -1 for the main module
+	 * @param dt time step in seconds
+	 */
+	void tickModule(int lazyScript, Ogre::Real dt);
+
+	/**
+	 * runs the script logic of the main module once: the frameStep function and all components
+	 * @param dt time step in seconds
+	 */
+	int tick(Ogre::Real dt);
+
 	/**
 	 * This is the callback function that gets called when script error occur.
 	 * When the script crashes, this function will provide you with more detail
@@ -146,6 +335,8 @@ protected:
 	 * @return 0 on success, everything else on error
 	 */
 	int loadScriptFile(const char *fileName, std::string &script, std::string &hash);
+	Ogre::String getStateFilename(const Ogre::String &name);
+	int loadLazyScript(lazyScript_t &script);
 
 	// undocumented debugging functions below, not working.
 	void ExceptionCallback(AngelScript::asIScriptContext *ctx, void *param);
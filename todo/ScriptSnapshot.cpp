@@ -0,0 +1,455 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ScriptSnapshot.h"
+
+#include "scriptarray/scriptarray.h"
+#include "scriptany/scriptany.h"
+#include "scriptdictionary/scriptdictionary.h"
+
+#include <string.h>
+#include <stdio.h>
+
+using namespace Ogre;
+
+// file and blob identification
+static const char snapshotMagic[4] = { 'R', 'S', 'N', 'P' };
+static const AngelScript::asUINT snapshotVersion = 2;
+// values are stored in native layout, so a blob only fits machines with the same byte order and pointer size
+static const AngelScript::asUINT snapshotByteOrder = 0x01020304;
+static const AngelScript::asUINT snapshotPointerSize = sizeof(void *);
+
+ScriptSnapshot::ScriptSnapshot(AngelScript::asIScriptEngine *_engine) : engine(_engine), module(0)
+{
+	stringTypeId     = engine->GetTypeIdByDecl("string");
+	vector3TypeId    = engine->GetTypeIdByDecl("vector3");
+	quaternionTypeId = engine->GetTypeIdByDecl("quaternion");
+	radianTypeId     = engine->GetTypeIdByDecl("radian");
+	degreeTypeId     = engine->GetTypeIdByDecl("degree");
+}
+
+int ScriptSnapshot::save(AngelScript::asIScriptModule *mod, std::vector<char> &blob)
+{
+	if(!mod) return -1;
+
+	blob.clear();
+	blob.insert(blob.end(), snapshotMagic, snapshotMagic + 4);
+	writeUInt(blob, snapshotVersion);
+	writeUInt(blob, snapshotByteOrder);
+	writeUInt(blob, snapshotPointerSize);
+
+	// the number of variables is only known after skipping the constants
+	size_t countPos = blob.size();
+	writeUInt(blob, 0);
+
+	AngelScript::asUINT count = 0;
+	for(int i = 0; i < mod->GetGlobalVarCount(); i++)
+	{
+		bool isConst = false;
+		int typeId = mod->GetGlobalVarTypeId(i, &isConst);
+		if(isConst) continue;
+
+		// the declaration contains the type, so a variable that changed its type is not restored
+		writeString(blob, mod->GetGlobalVarDeclaration(i));
+		writeValue(blob, mod->GetAddressOfGlobalVar(i), typeId);
+		count++;
+	}
+	memcpy(&blob[countPos], &count, sizeof(count));
+	return (int)count;
+}
+
+int ScriptSnapshot::restore(AngelScript::asIScriptModule *mod, const std::vector<char> &blob)
+{
+	if(!mod) return -1;
+	if(blob.size() < 20 || memcmp(&blob[0], snapshotMagic, 4)) return -1;
+
+	size_t pos = 4;
+	AngelScript::asUINT version = 0, byteOrder = 0, pointerSize = 0, count = 0;
+	if(!readUInt(blob, pos, version) || version != snapshotVersion) return -1;
+	if(!readUInt(blob, pos, byteOrder) || byteOrder != snapshotByteOrder) return -1;
+	if(!readUInt(blob, pos, pointerSize) || pointerSize != snapshotPointerSize) return -1;
+	if(!readUInt(blob, pos, count)) return -1;
+
+	module = mod;
+	int restored = 0;
+	for(AngelScript::asUINT i = 0; i < count; i++)
+	{
+		std::string decl;
+		if(!readString(blob, pos, decl)) break;
+
+		int index = mod->GetGlobalVarIndexByDecl(decl.c_str());
+		if(index < 0)
+		{
+			// the variable does not exist anymore, skip its value
+			AngelScript::asUINT size = 0;
+			if(!readUInt(blob, pos, size) || pos + size > blob.size()) break;
+			pos += size;
+			continue;
+		}
+
+		if(!readValue(blob, pos, mod->GetAddressOfGlobalVar(index), mod->GetGlobalVarTypeId(index))) break;
+		restored++;
+	}
+	module = 0;
+	return restored;
+}
+
+int ScriptSnapshot::saveToFile(const std::vector<char> &blob, const std::string &filename)
+{
+	FILE *f = fopen(filename.c_str(), "wb");
+	if(!f) return 1;
+	size_t written = blob.empty() ? 0 : fwrite(&blob[0], blob.size(), 1, f);
+	fclose(f);
+	return (blob.empty() || written == 1) ? 0 : 1;
+}
+
+int ScriptSnapshot::loadFromFile(std::vector<char> &blob, const std::string &filename)
+{
+	FILE *f = fopen(filename.c_str(), "rb");
+	if(!f) return 1;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if(size <= 0)
+	{
+		fclose(f);
+		return 1;
+	}
+	blob.resize(size);
+	size_t read = fread(&blob[0], size, 1, f);
+	fclose(f);
+	return (read == 1) ? 0 : 1;
+}
+
+void ScriptSnapshot::writeUInt(std::vector<char> &blob, AngelScript::asUINT value)
+{
+	const char *p = (const char *)&value;
+	blob.insert(blob.end(), p, p + sizeof(value));
+}
+
+void ScriptSnapshot::writeString(std::vector<char> &blob, const std::string &value)
+{
+	writeUInt(blob, (AngelScript::asUINT)value.size());
+	blob.insert(blob.end(), value.begin(), value.end());
+}
+
+void ScriptSnapshot::writeValue(std::vector<char> &blob, void *ptr, int typeId)
+{
+	// every value is prefixed with its size, so the reader can skip values it can not restore
+	size_t sizePos = blob.size();
+	writeUInt(blob, 0);
+	writePayload(blob, ptr, typeId);
+	AngelScript::asUINT size = (AngelScript::asUINT)(blob.size() - sizePos - sizeof(AngelScript::asUINT));
+	memcpy(&blob[sizePos], &size, sizeof(size));
+}
+
+void ScriptSnapshot::writePayload(std::vector<char> &blob, void *ptr, int typeId)
+{
+	// handles point to objects owned by someone else, they are not stored
+	if(!ptr || (typeId & AngelScript::asTYPEID_OBJHANDLE)) return;
+
+	if(!(typeId & AngelScript::asTYPEID_MASK_OBJECT))
+	{
+		// primitives and enums
+		int size = engine->GetSizeOfPrimitiveType(typeId);
+		blob.insert(blob.end(), (char *)ptr, (char *)ptr + size);
+	}
+	else if(typeId == stringTypeId)
+	{
+		writeString(blob, *(std::string *)ptr);
+	}
+	else if(getPodSize(typeId))
+	{
+		blob.insert(blob.end(), (char *)ptr, (char *)ptr + getPodSize(typeId));
+	}
+	else if(typeId & AngelScript::asTYPEID_SCRIPTOBJECT)
+	{
+		AngelScript::asIScriptObject *obj = (AngelScript::asIScriptObject *)ptr;
+		writeUInt(blob, obj->GetPropertyCount());
+		for(int i = 0; i < obj->GetPropertyCount(); i++)
+		{
+			int propTypeId = obj->GetPropertyTypeId(i);
+			writeString(blob, obj->GetPropertyName(i));
+			writeString(blob, getTypeDeclaration(propTypeId));
+			writeValue(blob, obj->GetAddressOfProperty(i), propTypeId);
+		}
+	}
+	else if(isObjectType(typeId, "array"))
+	{
+		AngelScript::CScriptArray *arr = (AngelScript::CScriptArray *)ptr;
+		int elementTypeId = arr->GetElementTypeId();
+		if(elementTypeId & AngelScript::asTYPEID_OBJHANDLE) return;
+
+		writeUInt(blob, arr->GetSize());
+		if(!(elementTypeId & AngelScript::asTYPEID_MASK_OBJECT))
+		{
+			// primitives are stored packed, without the per value size
+			int size = engine->GetSizeOfPrimitiveType(elementTypeId);
+			for(AngelScript::asUINT i = 0; i < arr->GetSize(); i++)
+				blob.insert(blob.end(), (char *)arr->At(i), (char *)arr->At(i) + size);
+		}
+		else
+		{
+			for(AngelScript::asUINT i = 0; i < arr->GetSize(); i++)
+				writeValue(blob, arr->At(i), elementTypeId);
+		}
+	}
+	else if(isObjectType(typeId, "dictionary"))
+	{
+		AngelScript::CScriptDictionary *dict = (AngelScript::CScriptDictionary *)ptr;
+		std::map<std::string, AngelScript::CScriptDictionary::valueStruct>::iterator it;
+
+		AngelScript::asUINT count = 0;
+		for(it = dict->dict.begin(); it != dict->dict.end(); it++)
+			if(!(it->second.typeId & AngelScript::asTYPEID_OBJHANDLE)) count++;
+
+		writeUInt(blob, count);
+		for(it = dict->dict.begin(); it != dict->dict.end(); it++)
+		{
+			int valueTypeId = it->second.typeId;
+			if(valueTypeId & AngelScript::asTYPEID_OBJHANDLE) continue;
+			void *valuePtr = (valueTypeId & AngelScript::asTYPEID_MASK_OBJECT) ? it->second.valueObj : (void *)&it->second.valueInt;
+			writeString(blob, it->first);
+			writeString(blob, getTypeDeclaration(valueTypeId));
+			writeValue(blob, valuePtr, valueTypeId);
+		}
+	}
+	else if(isObjectType(typeId, "any"))
+	{
+		AngelScript::CScriptAny *any = (AngelScript::CScriptAny *)ptr;
+		int valueTypeId = any->GetTypeId();
+		if(!valueTypeId || (valueTypeId & AngelScript::asTYPEID_OBJHANDLE)) return;
+
+		writeString(blob, getTypeDeclaration(valueTypeId));
+		if(valueTypeId & AngelScript::asTYPEID_MASK_OBJECT)
+		{
+			void *tmp = engine->CreateScriptObject(valueTypeId);
+			if(!tmp) return;
+			any->Retrieve(tmp, valueTypeId);
+			writeValue(blob, tmp, valueTypeId);
+			engine->ReleaseScriptObject(tmp, valueTypeId);
+		}
+		else
+		{
+			AngelScript::asINT64 tmp = 0;
+			any->Retrieve(&tmp, valueTypeId);
+			writeValue(blob, &tmp, valueTypeId);
+		}
+	}
+	// other registered types have no known layout and are not stored
+}
+
+bool ScriptSnapshot::readUInt(const std::vector<char> &blob, size_t &pos, AngelScript::asUINT &value)
+{
+	if(pos + sizeof(value) > blob.size()) return false;
+	memcpy(&value, &blob[pos], sizeof(value));
+	pos += sizeof(value);
+	return true;
+}
+
+bool ScriptSnapshot::readString(const std::vector<char> &blob, size_t &pos, std::string &value)
+{
+	AngelScript::asUINT size = 0;
+	if(!readUInt(blob, pos, size) || pos + size > blob.size()) return false;
+	value.assign(blob.begin() + pos, blob.begin() + pos + size);
+	pos += size;
+	return true;
+}
+
+bool ScriptSnapshot::readValue(const std::vector<char> &blob, size_t &pos, void *ptr, int typeId)
+{
+	AngelScript::asUINT size = 0;
+	if(!readUInt(blob, pos, size) || pos + size > blob.size()) return false;
+
+	size_t end = pos + size;
+	// an empty value was not stored, the target keeps its current value
+	bool ok = (size == 0 || !ptr) ? true : readPayload(blob, pos, end, ptr, typeId);
+
+	// continue after the value even if it could not be read completely
+	pos = end;
+	return ok;
+}
+
+bool ScriptSnapshot::readPayload(const std::vector<char> &blob, size_t pos, size_t end, void *ptr, int typeId)
+{
+	if(typeId & AngelScript::asTYPEID_OBJHANDLE) return true;
+
+	if(!(typeId & AngelScript::asTYPEID_MASK_OBJECT))
+	{
+		int size = engine->GetSizeOfPrimitiveType(typeId);
+		if(pos + size > end) return false;
+		memcpy(ptr, &blob[pos], size);
+	}
+	else if(typeId == stringTypeId)
+	{
+		std::string value;
+		if(!readString(blob, pos, value) || pos > end) return false;
+		((std::string *)ptr)->swap(value);
+	}
+	else if(getPodSize(typeId))
+	{
+		int size = getPodSize(typeId);
+		if(pos + size > end) return false;
+		memcpy(ptr, &blob[pos], size);
+	}
+	else if(typeId & AngelScript::asTYPEID_SCRIPTOBJECT)
+	{
+		AngelScript::asIScriptObject *obj = (AngelScript::asIScriptObject *)ptr;
+		AngelScript::asUINT count = 0;
+		if(!readUInt(blob, pos, count)) return false;
+		for(AngelScript::asUINT i = 0; i < count; i++)
+		{
+			std::string name, decl;
+			if(!readString(blob, pos, name) || !readString(blob, pos, decl)) return false;
+
+			// properties are matched by name and type, so members can be added or reordered
+			void *propPtr = 0;
+			int propTypeId = 0;
+			for(int j = 0; j < obj->GetPropertyCount(); j++)
+			{
+				if(name != obj->GetPropertyName(j)) continue;
+				if(decl != getTypeDeclaration(obj->GetPropertyTypeId(j))) break;
+				propPtr    = obj->GetAddressOfProperty(j);
+				propTypeId = obj->GetPropertyTypeId(j);
+				break;
+			}
+			if(!readValue(blob, pos, propPtr, propTypeId)) return false;
+		}
+	}
+	else if(isObjectType(typeId, "array"))
+	{
+		AngelScript::CScriptArray *arr = (AngelScript::CScriptArray *)ptr;
+		int elementTypeId = arr->GetElementTypeId();
+		AngelScript::asUINT count = 0;
+		if(!readUInt(blob, pos, count)) return false;
+
+		if(!(elementTypeId & AngelScript::asTYPEID_MASK_OBJECT))
+		{
+			int size = engine->GetSizeOfPrimitiveType(elementTypeId);
+			if(pos + (size_t)size * count > end) return false;
+			arr->Resize(count);
+			for(AngelScript::asUINT i = 0; i < count; i++, pos += size)
+				memcpy(arr->At(i), &blob[pos], size);
+		}
+		else
+		{
+			arr->Resize(count);
+			for(AngelScript::asUINT i = 0; i < count; i++)
+				if(!readValue(blob, pos, arr->At(i), elementTypeId)) return false;
+		}
+	}
+	else if(isObjectType(typeId, "dictionary"))
+	{
+		AngelScript::CScriptDictionary *dict = (AngelScript::CScriptDictionary *)ptr;
+		AngelScript::asUINT count = 0;
+		if(!readUInt(blob, pos, count)) return false;
+
+		dict->DeleteAll();
+		for(AngelScript::asUINT i = 0; i < count; i++)
+		{
+			std::string key, decl;
+			if(!readString(blob, pos, key) || !readString(blob, pos, decl)) return false;
+
+			int valueTypeId = getTypeIdByDecl(decl);
+			if(valueTypeId < 0)
+			{
+				// unknown type, skip the value
+				if(!readValue(blob, pos, 0, 0)) return false;
+				continue;
+			}
+
+			if(valueTypeId & AngelScript::asTYPEID_MASK_OBJECT)
+			{
+				void *tmp = engine->CreateScriptObject(valueTypeId);
+				bool ok = readValue(blob, pos, tmp, valueTypeId);
+				if(ok && tmp) dict->Set(key, tmp, valueTypeId);
+				if(tmp) engine->ReleaseScriptObject(tmp, valueTypeId);
+				if(!ok) return false;
+			}
+			else
+			{
+				AngelScript::asINT64 tmp = 0;
+				if(!readValue(blob, pos, &tmp, valueTypeId)) return false;
+				dict->Set(key, &tmp, valueTypeId);
+			}
+		}
+	}
+	else if(isObjectType(typeId, "any"))
+	{
+		AngelScript::CScriptAny *any = (AngelScript::CScriptAny *)ptr;
+		std::string decl;
+		if(!readString(blob, pos, decl)) return false;
+
+		int valueTypeId = getTypeIdByDecl(decl);
+		if(valueTypeId < 0) return true;
+
+		if(valueTypeId & AngelScript::asTYPEID_MASK_OBJECT)
+		{
+			void *tmp = engine->CreateScriptObject(valueTypeId);
+			if(!tmp) return true;
+			bool ok = readValue(blob, pos, tmp, valueTypeId);
+			if(ok) any->Store(tmp, valueTypeId);
+			engine->ReleaseScriptObject(tmp, valueTypeId);
+			return ok;
+		}
+
+		AngelScript::asINT64 tmp = 0;
+		if(!readValue(blob, pos, &tmp, valueTypeId)) return false;
+		any->Store(&tmp, valueTypeId);
+	}
+	return true;
+}
+
+std::string ScriptSnapshot::getTypeDeclaration(int typeId)
+{
+	const char *decl = engine->GetTypeDeclaration(typeId);
+	return decl ? std::string(decl) : std::string();
+}
+
+int ScriptSnapshot::getTypeIdByDecl(const std::string &decl)
+{
+	// script classes are only known to their module
+	int typeId = module ? module->GetTypeIdByDecl(decl.c_str()) : -1;
+	if(typeId < 0) typeId = engine->GetTypeIdByDecl(decl.c_str());
+	return typeId;
+}
+
+int ScriptSnapshot::getPodSize(int typeId)
+{
+	// registered value types that are plain old data can be copied directly
+	if(typeId == vector3TypeId)    return sizeof(Ogre::Vector3);
+	if(typeId == quaternionTypeId) return sizeof(Ogre::Quaternion);
+	if(typeId == radianTypeId)     return sizeof(Ogre::Radian);
+	if(typeId == degreeTypeId)     return sizeof(Ogre::Degree);
+	return 0;
+}
+
+bool ScriptSnapshot::isObjectType(int typeId, const char *name)
+{
+	AngelScript::asIObjectType *ot = engine->GetObjectTypeById(typeId);
+	return ot && !strcmp(ot->GetName(), name);
+}
@@ -0,0 +1,108 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef SCRIPTSNAPSHOT_H__
+#define SCRIPTSNAPSHOT_H__
+
+#include "RoRPrerequisites.h"
+
+#include <string>
+#include <vector>
+#include <angelscript.h>
+#include <Ogre.h>
+
+/**
+ *  @brief Binary snapshot of the global variables of a script module.
+ *
+ *  Captures primitives, enums, strings, arrays, dictionaries, any, vector3, quaternion,
+ *  radian, degree and script class instances into a compact blob and writes them back
+ *  in one pass, without recompiling the module or running main() again.
+ *  Every value is stored with its size, so values whose type changed or that can not be
+ *  stored (handles) are skipped on restore and keep their current value.
+ *  The header records the byte order and pointer size, blobs of other machines are rejected.
+ */
+class ScriptSnapshot
+{
+public:
+	ScriptSnapshot(AngelScript::asIScriptEngine *engine);
+
+	/**
+	 * captures all non-const global variables of a module
+	 * @param mod the module to capture
+	 * @param blob receives the binary snapshot
+	 * @return number of variables stored, negative value on error
+	 */
+	int save(AngelScript::asIScriptModule *mod, std::vector<char> &blob);
+
+	/**
+	 * writes the variables of a snapshot back into a module
+	 * @param mod the module to restore, must declare the variables with the same declarations
+	 * @param blob snapshot created by save()
+	 * @return number of variables restored, negative value if the blob is invalid
+	 */
+	int restore(AngelScript::asIScriptModule *mod, const std::vector<char> &blob);
+
+	/**
+	 * writes a snapshot to a file
+	 * @return 0 on success
+	 */
+	static int saveToFile(const std::vector<char> &blob, const std::string &filename);
+
+	/**
+	 * reads a snapshot from a file
+	 * @return 0 on success
+	 */
+	static int loadFromFile(std::vector<char> &blob, const std::string &filename);
+
+protected:
+	AngelScript::asIScriptEngine *engine;
+	AngelScript::asIScriptModule *module; //!< module used to resolve the script types while restoring
+	int stringTypeId;
+	int vector3TypeId;
+	int quaternionTypeId;
+	int radianTypeId;
+	int degreeTypeId;
+
+	// writing
+	void writeUInt(std::vector<char> &blob, AngelScript::asUINT value);
+	void writeString(std::vector<char> &blob, const std::string &value);
+	void writeValue(std::vector<char> &blob, void *ptr, int typeId);
+	void writePayload(std::vector<char> &blob, void *ptr, int typeId);
+
+	// reading, pos is advanced and checked against the end of the blob
+	bool readUInt(const std::vector<char> &blob, size_t &pos, AngelScript::asUINT &value);
+	bool readString(const std::vector<char> &blob, size_t &pos, std::string &value);
+	bool readValue(const std::vector<char> &blob, size_t &pos, void *ptr, int typeId);
+	bool readPayload(const std::vector<char> &blob, size_t pos, size_t end, void *ptr, int typeId);
+
+	std::string getTypeDeclaration(int typeId);
+	int getTypeIdByDecl(const std::string &decl);
+	int getPodSize(int typeId);
+	bool isObjectType(int typeId, const char *name);
+};
+
+#endif //SCRIPTSNAPSHOT_H__
@@ -0,0 +1,101 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef SIMDMATH_H__
+#define SIMDMATH_H__
+
+/**
+ *  Minimal helpers for the batch kernels of the script types.
+ *
+ *  They map to AVX or SSE intrinsics, depending on what the compiler targets, or to plain
+ *  float code otherwise. Kernels are written once against them and process SIMD_WIDTH floats
+ *  per step. vload and vstore need pointers aligned to SIMD_WIDTH floats, vloadu and vstoreu don't.
+ *  vselectgt(a, b, t, f) returns t where a > b and f elsewhere, vmaskge(a, b) has bit n set where lane n of a >= b.
+ */
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_ENABLED
+#define SIMD_WIDTH 8
+typedef __m256 vfloat;
+static inline vfloat vload(const float *p)           { return _mm256_load_ps(p); }
+static inline vfloat vloadu(const float *p)          { return _mm256_loadu_ps(p); }
+static inline void   vstore(float *p, vfloat a)      { _mm256_store_ps(p, a); }
+static inline void   vstoreu(float *p, vfloat a)     { _mm256_storeu_ps(p, a); }
+static inline vfloat vset(float f)                   { return _mm256_set1_ps(f); }
+static inline vfloat vadd(vfloat a, vfloat b)        { return _mm256_add_ps(a, b); }
+static inline vfloat vsub(vfloat a, vfloat b)        { return _mm256_sub_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b)        { return _mm256_mul_ps(a, b); }
+static inline vfloat vdiv(vfloat a, vfloat b)        { return _mm256_div_ps(a, b); }
+static inline vfloat vsqrt(vfloat a)                 { return _mm256_sqrt_ps(a); }
+static inline vfloat vmin(vfloat a, vfloat b)        { return _mm256_min_ps(a, b); }
+static inline vfloat vmax(vfloat a, vfloat b)        { return _mm256_max_ps(a, b); }
+static inline vfloat vselectgt(vfloat a, vfloat b, vfloat t, vfloat f) { return _mm256_blendv_ps(f, t, _mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+static inline int    vmaskge(vfloat a, vfloat b)     { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ)); }
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SIMD_ENABLED
+#define SIMD_WIDTH 4
+typedef __m128 vfloat;
+static inline vfloat vload(const float *p)           { return _mm_load_ps(p); }
+static inline vfloat vloadu(const float *p)          { return _mm_loadu_ps(p); }
+static inline void   vstore(float *p, vfloat a)      { _mm_store_ps(p, a); }
+static inline void   vstoreu(float *p, vfloat a)     { _mm_storeu_ps(p, a); }
+static inline vfloat vset(float f)                   { return _mm_set1_ps(f); }
+static inline vfloat vadd(vfloat a, vfloat b)        { return _mm_add_ps(a, b); }
+static inline vfloat vsub(vfloat a, vfloat b)        { return _mm_sub_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b)        { return _mm_mul_ps(a, b); }
+static inline vfloat vdiv(vfloat a, vfloat b)        { return _mm_div_ps(a, b); }
+static inline vfloat vsqrt(vfloat a)                 { return _mm_sqrt_ps(a); }
+static inline vfloat vmin(vfloat a, vfloat b)        { return _mm_min_ps(a, b); }
+static inline vfloat vmax(vfloat a, vfloat b)        { return _mm_max_ps(a, b); }
+static inline vfloat vselectgt(vfloat a, vfloat b, vfloat t, vfloat f)
+{
+	vfloat mask = _mm_cmpgt_ps(a, b);
+	return _mm_or_ps(_mm_and_ps(mask, t), _mm_andnot_ps(mask, f));
+}
+static inline int    vmaskge(vfloat a, vfloat b)     { return _mm_movemask_ps(_mm_cmpge_ps(a, b)); }
+#else
+#include <math.h>
+#define SIMD_WIDTH 1
+typedef float vfloat;
+static inline vfloat vload(const float *p)           { return *p; }
+static inline vfloat vloadu(const float *p)          { return *p; }
+static inline void   vstore(float *p, vfloat a)      { *p = a; }
+static inline void   vstoreu(float *p, vfloat a)     { *p = a; }
+static inline vfloat vset(float f)                   { return f; }
+static inline vfloat vadd(vfloat a, vfloat b)        { return a + b; }
+static inline vfloat vsub(vfloat a, vfloat b)        { return a - b; }
+static inline vfloat vmul(vfloat a, vfloat b)        { return a * b; }
+static inline vfloat vdiv(vfloat a, vfloat b)        { return a / b; }
+static inline vfloat vsqrt(vfloat a)                 { return sqrtf(a); }
+static inline vfloat vmin(vfloat a, vfloat b)        { return a < b ? a : b; }
+static inline vfloat vmax(vfloat a, vfloat b)        { return a > b ? a : b; }
+static inline vfloat vselectgt(vfloat a, vfloat b, vfloat t, vfloat f) { return a > b ? t : f; }
+static inline int    vmaskge(vfloat a, vfloat b)     { return a >= b ? 1 : 0; }
+#endif
+
+#endif //SIMDMATH_H__
@@ -0,0 +1,344 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "Vector3Array.h"
+#include "SimdMath.h"
+
+#include <angelscript.h>
+
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+
+// the storage is padded to this many elements, enough for the widest vectors
+#define V3A_PADDING 8
+// largest number of elements, a power of two so the capacity doubling stays below it and the block below 4 GB
+#define V3A_MAX_SIZE 0x10000000
+
+static void setScriptException(const char *message)
+{
+	AngelScript::asIScriptContext *ctx = AngelScript::asGetActiveContext();
+	if(ctx) ctx->SetException(message);
+}
+
+static float *allocFloats(size_t n)
+{
+#ifdef SIMD_ENABLED
+	return (float *)_mm_malloc(n * sizeof(float), V3A_PADDING * sizeof(float));
+#else
+	return (float *)malloc(n * sizeof(float));
+#endif
+}
+
+static void freeFloats(float *p)
+{
+#ifdef SIMD_ENABLED
+	_mm_free(p);
+#else
+	free(p);
+#endif
+}
+
+// number of elements the in place kernels work on, the padding behind the last element is processed as well
+static inline unsigned int padded(unsigned int count)
+{
+	return (count + SIMD_WIDTH - 1) & ~(SIMD_WIDTH - 1);
+}
+
+// number of elements the kernels writing to unpadded output can process in full vectors
+static inline unsigned int fullVectors(unsigned int count)
+{
+	return count & ~(SIMD_WIDTH - 1);
+}
+
+Vector3Array::Vector3Array() : x(0), y(0), z(0), count(0), capacity(0)
+{
+}
+
+Vector3Array::Vector3Array(unsigned int size) : x(0), y(0), z(0), count(0), capacity(0)
+{
+	resize(size);
+}
+
+Vector3Array::Vector3Array(const Vector3Array &other) : x(0), y(0), z(0), count(0), capacity(0)
+{
+	*this = other;
+}
+
+Vector3Array::~Vector3Array()
+{
+	// the components share one allocation
+	if(x) freeFloats(x);
+}
+
+Vector3Array &Vector3Array::operator=(const Vector3Array &other)
+{
+	if(&other == this) return *this;
+	if(!reserve(other.count)) return *this;
+	if(other.count)
+	{
+		memcpy(x, other.x, other.count * sizeof(float));
+		memcpy(y, other.y, other.count * sizeof(float));
+		memcpy(z, other.z, other.count * sizeof(float));
+	}
+	count = other.count;
+	return *this;
+}
+
+bool Vector3Array::reserve(unsigned int size)
+{
+	if(size <= capacity) return true;
+	if(size > V3A_MAX_SIZE)
+	{
+		setScriptException("Too large array size");
+		return false;
+	}
+
+	unsigned int newCapacity = std::max(capacity * 2, (unsigned int)V3A_PADDING);
+	while(newCapacity < size) newCapacity *= 2;
+
+	// one block for all three components, each starts at a multiple of the padding and is aligned
+	float *block = allocFloats((size_t)newCapacity * 3);
+	if(!block)
+	{
+		setScriptException("Out of memory");
+		return false;
+	}
+	memset(block, 0, (size_t)newCapacity * 3 * sizeof(float));
+	if(count)
+	{
+		memcpy(block,                   x, count * sizeof(float));
+		memcpy(block + newCapacity,     y, count * sizeof(float));
+		memcpy(block + newCapacity * 2, z, count * sizeof(float));
+	}
+	if(x) freeFloats(x);
+
+	x = block;
+	y = block + newCapacity;
+	z = block + newCapacity * 2;
+	capacity = newCapacity;
+	return true;
+}
+
+void Vector3Array::resize(unsigned int size)
+{
+	if(!reserve(size)) return;
+	if(size > count)
+	{
+		// the padding may contain leftovers of the kernels
+		memset(x + count, 0, (size - count) * sizeof(float));
+		memset(y + count, 0, (size - count) * sizeof(float));
+		memset(z + count, 0, (size - count) * sizeof(float));
+	}
+	count = size;
+}
+
+void Vector3Array::push_back(const Ogre::Vector3 &v)
+{
+	if(!reserve(count + 1)) return;
+	set(count++, v);
+}
+
+void Vector3Array::add(const Vector3Array &other)
+{
+	unsigned int n = padded(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vstore(x + i, vadd(vload(x + i), vload(other.x + i)));
+		vstore(y + i, vadd(vload(y + i), vload(other.y + i)));
+		vstore(z + i, vadd(vload(z + i), vload(other.z + i)));
+	}
+}
+
+void Vector3Array::add(const Ogre::Vector3 &v)
+{
+	vfloat vx = vset(v.x), vy = vset(v.y), vz = vset(v.z);
+	unsigned int n = padded(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vstore(x + i, vadd(vload(x + i), vx));
+		vstore(y + i, vadd(vload(y + i), vy));
+		vstore(z + i, vadd(vload(z + i), vz));
+	}
+}
+
+void Vector3Array::sub(const Vector3Array &other)
+{
+	unsigned int n = padded(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vstore(x + i, vsub(vload(x + i), vload(other.x + i)));
+		vstore(y + i, vsub(vload(y + i), vload(other.y + i)));
+		vstore(z + i, vsub(vload(z + i), vload(other.z + i)));
+	}
+}
+
+void Vector3Array::scale(float s)
+{
+	scale(Ogre::Vector3(s, s, s));
+}
+
+void Vector3Array::scale(const Ogre::Vector3 &v)
+{
+	vfloat vx = vset(v.x), vy = vset(v.y), vz = vset(v.z);
+	unsigned int n = padded(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vstore(x + i, vmul(vload(x + i), vx));
+		vstore(y + i, vmul(vload(y + i), vy));
+		vstore(z + i, vmul(vload(z + i), vz));
+	}
+}
+
+void Vector3Array::cross(const Ogre::Vector3 &v)
+{
+	vfloat vx = vset(v.x), vy = vset(v.y), vz = vset(v.z);
+	unsigned int n = padded(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vfloat ax = vload(x + i), ay = vload(y + i), az = vload(z + i);
+		vstore(x + i, vsub(vmul(ay, vz), vmul(az, vy)));
+		vstore(y + i, vsub(vmul(az, vx), vmul(ax, vz)));
+		vstore(z + i, vsub(vmul(ax, vy), vmul(ay, vx)));
+	}
+}
+
+void Vector3Array::cross(const Vector3Array &other)
+{
+	unsigned int n = padded(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vfloat ax = vload(x + i), ay = vload(y + i), az = vload(z + i);
+		vfloat bx = vload(other.x + i), by = vload(other.y + i), bz = vload(other.z + i);
+		vstore(x + i, vsub(vmul(ay, bz), vmul(az, by)));
+		vstore(y + i, vsub(vmul(az, bx), vmul(ax, bz)));
+		vstore(z + i, vsub(vmul(ax, by), vmul(ay, bx)));
+	}
+}
+
+void Vector3Array::normalise()
+{
+	vfloat zero = vset(0.0f), one = vset(1.0f);
+	unsigned int n = padded(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vfloat ax = vload(x + i), ay = vload(y + i), az = vload(z + i);
+		vfloat len = vsqrt(vadd(vadd(vmul(ax, ax), vmul(ay, ay)), vmul(az, az)));
+		// a full division instead of the reciprocal estimate, so the result matches Vector3::normalise
+		vfloat inv = vselectgt(len, zero, vdiv(one, len), one);
+		vstore(x + i, vmul(ax, inv));
+		vstore(y + i, vmul(ay, inv));
+		vstore(z + i, vmul(az, inv));
+	}
+}
+
+void Vector3Array::rotate(const Ogre::Quaternion &q)
+{
+	// same as Quaternion::operator*(Vector3): v + 2w (q x v) + 2 (q x (q x v))
+	vfloat qx = vset(q.x), qy = vset(q.y), qz = vset(q.z);
+	vfloat w2 = vset(2.0f * q.w), two = vset(2.0f);
+	unsigned int n = padded(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vfloat vx = vload(x + i), vy = vload(y + i), vz = vload(z + i);
+		vfloat uvx = vsub(vmul(qy, vz), vmul(qz, vy));
+		vfloat uvy = vsub(vmul(qz, vx), vmul(qx, vz));
+		vfloat uvz = vsub(vmul(qx, vy), vmul(qy, vx));
+		vfloat uuvx = vsub(vmul(qy, uvz), vmul(qz, uvy));
+		vfloat uuvy = vsub(vmul(qz, uvx), vmul(qx, uvz));
+		vfloat uuvz = vsub(vmul(qx, uvy), vmul(qy, uvx));
+		vstore(x + i, vadd(vx, vadd(vmul(uvx, w2), vmul(uuvx, two))));
+		vstore(y + i, vadd(vy, vadd(vmul(uvy, w2), vmul(uuvy, two))));
+		vstore(z + i, vadd(vz, vadd(vmul(uvz, w2), vmul(uuvz, two))));
+	}
+}
+
+void Vector3Array::dot(const Ogre::Vector3 &v, float *out) const
+{
+	vfloat vx = vset(v.x), vy = vset(v.y), vz = vset(v.z);
+	unsigned int n = fullVectors(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+		vstoreu(out + i, vadd(vadd(vmul(vload(x + i), vx), vmul(vload(y + i), vy)), vmul(vload(z + i), vz)));
+	for(unsigned int i = n; i < count; i++)
+		out[i] = x[i] * v.x + y[i] * v.y + z[i] * v.z;
+}
+
+void Vector3Array::dot(const Vector3Array &other, float *out) const
+{
+	unsigned int n = fullVectors(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+		vstoreu(out + i, vadd(vadd(vmul(vload(x + i), vload(other.x + i)), vmul(vload(y + i), vload(other.y + i))), vmul(vload(z + i), vload(other.z + i))));
+	for(unsigned int i = n; i < count; i++)
+		out[i] = x[i] * other.x[i] + y[i] * other.y[i] + z[i] * other.z[i];
+}
+
+void Vector3Array::length(float *out) const
+{
+	unsigned int n = fullVectors(count);
+	for(unsigned int i = 0; i < n; i += SIMD_WIDTH)
+	{
+		vfloat ax = vload(x + i), ay = vload(y + i), az = vload(z + i);
+		vstoreu(out + i, vsqrt(vadd(vadd(vmul(ax, ax), vmul(ay, ay)), vmul(az, az))));
+	}
+	for(unsigned int i = n; i < count; i++)
+		out[i] = Ogre::Math::Sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+}
+
+bool Vector3Array::getBounds(Ogre::Vector3 &min, Ogre::Vector3 &max) const
+{
+	if(!count) return false;
+
+	min = max = get(0);
+	unsigned int n = fullVectors(count);
+	if(n)
+	{
+		vfloat minx = vload(x), miny = vload(y), minz = vload(z);
+		vfloat maxx = minx, maxy = miny, maxz = minz;
+		for(unsigned int i = SIMD_WIDTH; i < n; i += SIMD_WIDTH)
+		{
+			vfloat ax = vload(x + i), ay = vload(y + i), az = vload(z + i);
+			minx = vmin(minx, ax); miny = vmin(miny, ay); minz = vmin(minz, az);
+			maxx = vmax(maxx, ax); maxy = vmax(maxy, ay); maxz = vmax(maxz, az);
+		}
+
+		// reduce the lanes
+		float lanes[6][SIMD_WIDTH];
+		vstoreu(lanes[0], minx); vstoreu(lanes[1], miny); vstoreu(lanes[2], minz);
+		vstoreu(lanes[3], maxx); vstoreu(lanes[4], maxy); vstoreu(lanes[5], maxz);
+		for(int l = 0; l < SIMD_WIDTH; l++)
+		{
+			min.makeFloor(Ogre::Vector3(lanes[0][l], lanes[1][l], lanes[2][l]));
+			max.makeCeil(Ogre::Vector3(lanes[3][l], lanes[4][l], lanes[5][l]));
+		}
+	}
+	for(unsigned int i = n; i < count; i++)
+	{
+		min.makeFloor(get(i));
+		max.makeCeil(get(i));
+	}
+	return true;
+}
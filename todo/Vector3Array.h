@@ -0,0 +1,126 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef VECTOR3ARRAY_H__
+#define VECTOR3ARRAY_H__
+
+#include "RoRPrerequisites.h"
+
+#include <Ogre.h>
+
+/**
+ *  @brief Array of vectors stored as structure of arrays.
+ *
+ *  The x, y and z components are kept in three separate float arrays, aligned and padded
+ *  to a multiple of eight elements. The bulk operations work on all elements in one call
+ *  and use AVX or SSE when the compiler targets them, otherwise plain loops.
+ *  Operations that take a second array require both arrays to have the same size.
+ */
+class Vector3Array
+{
+public:
+	Vector3Array();
+	Vector3Array(unsigned int size);
+	Vector3Array(const Vector3Array &other);
+	~Vector3Array();
+
+	Vector3Array &operator=(const Vector3Array &other);
+
+	unsigned int size() const { return count; };
+
+	/**
+	 * changes the number of elements, new elements are zero
+	 */
+	void resize(unsigned int size);
+	void clear() { count = 0; };
+
+	Ogre::Vector3 get(unsigned int i) const { return Ogre::Vector3(x[i], y[i], z[i]); };
+	void set(unsigned int i, const Ogre::Vector3 &v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; };
+	void push_back(const Ogre::Vector3 &v);
+
+	// element wise operations, the result is stored in this array
+	void add(const Vector3Array &other);
+	void add(const Ogre::Vector3 &v);
+	void sub(const Vector3Array &other);
+	void scale(float s);
+	void scale(const Ogre::Vector3 &v);
+
+	/**
+	 * replaces every element with its cross product with v
+	 */
+	void cross(const Ogre::Vector3 &v);
+	void cross(const Vector3Array &other);
+
+	/**
+	 * normalises every element, zero length elements are left alone like Vector3::normalise does
+	 */
+	void normalise();
+
+	/**
+	 * rotates every element by the quaternion
+	 */
+	void rotate(const Ogre::Quaternion &q);
+
+	/**
+	 * @param out receives size() dot products of the elements with v
+	 */
+	void dot(const Ogre::Vector3 &v, float *out) const;
+	void dot(const Vector3Array &other, float *out) const;
+
+	/**
+	 * @param out receives the size() element lengths
+	 */
+	void length(float *out) const;
+
+	/**
+	 * components for native kernels, aligned and padded like described above
+	 */
+	const float *getX() const { return x; };
+	const float *getY() const { return y; };
+	const float *getZ() const { return z; };
+
+	/**
+	 * gets the axis aligned bounds of all elements
+	 * @return false if the array is empty
+	 */
+	bool getBounds(Ogre::Vector3 &min, Ogre::Vector3 &max) const;
+
+protected:
+	float *x;
+	float *y;
+	float *z;
+	unsigned int count;
+	unsigned int capacity;   //!< allocated elements per component, a multiple of the vector width
+
+	/**
+	 * grows the storage, sets a script exception and keeps the array unchanged if the size is too large
+	 * @return false if the storage could not be allocated
+	 */
+	bool reserve(unsigned int size);
+};
+
+#endif //VECTOR3ARRAY_H__
@@ -26,6 +26,11 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "as_ogre.h"
+#include "NativeCallProfiler.h"
+#include "Vector3Array.h"
+#include "KeyframeTrack.h"
+#include "BatchIntersection.h"
+#include "scriptarray/scriptarray.h"
 
 using namespace Ogre;
 using namespace AngelScript;
@@ -160,6 +165,384 @@ static void QuaternionInitConstructorScaler(float s, Quaternion *self)
 	new(self) Quaternion(s,s,s,s);
 }
 
+/***VECTOR3ARRAY***/
+static void Vector3ArrayDefaultConstructor(Vector3Array *self)
+{
+	new(self) Vector3Array();
+}
+
+static void Vector3ArrayCopyConstructor(const Vector3Array &other, Vector3Array *self)
+{
+	new(self) Vector3Array(other);
+}
+
+static void Vector3ArraySizeConstructor(unsigned int size, Vector3Array *self)
+{
+	new(self) Vector3Array(size);
+}
+
+static void Vector3ArrayDestructor(Vector3Array *self)
+{
+	self->~Vector3Array();
+}
+
+// raises a script exception if the index is out of range
+static bool Vector3ArrayCheckIndex(unsigned int i, const Vector3Array *self)
+{
+	if(i < self->size()) return true;
+	asIScriptContext *ctx = asGetActiveContext();
+	if(ctx) ctx->SetException("Index out of bounds");
+	return false;
+}
+
+// raises a script exception if the arrays can't be combined element wise
+static bool Vector3ArrayCheckSize(const Vector3Array &other, const Vector3Array *self)
+{
+	if(other.size() == self->size()) return true;
+	asIScriptContext *ctx = asGetActiveContext();
+	if(ctx) ctx->SetException("Array sizes differ");
+	return false;
+}
+
+static Vector3 Vector3ArrayGet(unsigned int i, Vector3Array *self)
+{
+	if(!Vector3ArrayCheckIndex(i, self)) return Vector3::ZERO;
+	return self->get(i);
+}
+
+static void Vector3ArraySet(unsigned int i, const Vector3 &v, Vector3Array *self)
+{
+	if(Vector3ArrayCheckIndex(i, self)) self->set(i, v);
+}
+
+static void Vector3ArrayAdd(const Vector3Array &other, Vector3Array *self)
+{
+	if(Vector3ArrayCheckSize(other, self)) self->add(other);
+}
+
+static void Vector3ArraySub(const Vector3Array &other, Vector3Array *self)
+{
+	if(Vector3ArrayCheckSize(other, self)) self->sub(other);
+}
+
+static void Vector3ArrayCross(const Vector3Array &other, Vector3Array *self)
+{
+	if(Vector3ArrayCheckSize(other, self)) self->cross(other);
+}
+
+static void Vector3ArrayDot(const Vector3 &v, CScriptArray &out, Vector3Array *self)
+{
+	out.Resize(self->size());
+	if(!self->size() || out.GetSize() != self->size()) return;
+	self->dot(v, (float *)out.At(0));
+}
+
+static void Vector3ArrayDotArray(const Vector3Array &other, CScriptArray &out, Vector3Array *self)
+{
+	if(!Vector3ArrayCheckSize(other, self)) return;
+	out.Resize(self->size());
+	if(!self->size() || out.GetSize() != self->size()) return;
+	self->dot(other, (float *)out.At(0));
+}
+
+static void Vector3ArrayLength(CScriptArray &out, Vector3Array *self)
+{
+	out.Resize(self->size());
+	if(!self->size() || out.GetSize() != self->size()) return;
+	self->length((float *)out.At(0));
+}
+
+static void Vector3ArrayFromArray(CScriptArray &in, Vector3Array *self)
+{
+	self->resize(in.GetSize());
+	if(self->size() != in.GetSize()) return;
+	for(unsigned int i = 0; i < in.GetSize(); i++)
+		self->set(i, *(Vector3 *)in.At(i));
+}
+
+static void Vector3ArrayToArray(CScriptArray &out, Vector3Array *self)
+{
+	out.Resize(self->size());
+	if(out.GetSize() != self->size()) return;
+	for(unsigned int i = 0; i < self->size(); i++)
+		*(Vector3 *)out.At(i) = self->get(i);
+}
+
+/***KEYFRAMETRACK***/
+static void KeyframeTrackDefaultConstructor(KeyframeTrack *self)
+{
+	new(self) KeyframeTrack();
+}
+
+static void KeyframeTrackCopyConstructor(const KeyframeTrack &other, KeyframeTrack *self)
+{
+	new(self) KeyframeTrack(other);
+}
+
+static void KeyframeTrackDestructor(KeyframeTrack *self)
+{
+	self->~KeyframeTrack();
+}
+
+static void AnimationSamplerDefaultConstructor(AnimationSampler *self)
+{
+	new(self) AnimationSampler();
+}
+
+static void AnimationSamplerCopyConstructor(const AnimationSampler &other, AnimationSampler *self)
+{
+	new(self) AnimationSampler(other);
+}
+
+static void AnimationSamplerDestructor(AnimationSampler *self)
+{
+	self->~AnimationSampler();
+}
+
+static void AnimationSamplerSetTrack(unsigned int index, const KeyframeTrack &track, AnimationSampler *self)
+{
+	if(index < self->getTrackCount())
+	{
+		self->setTrack(index, track);
+		return;
+	}
+	asIScriptContext *ctx = asGetActiveContext();
+	if(ctx) ctx->SetException("Index out of bounds");
+}
+
+static void AnimationSamplerSample(float time, InterpolationMode mode, CScriptArray &rotations, Vector3Array &positions, AnimationSampler *self)
+{
+	rotations.Resize(self->getTrackCount());
+	if(rotations.GetSize() != self->getTrackCount()) return;
+	self->sample(time, mode, self->getTrackCount() ? (Quaternion *)rotations.At(0) : 0, positions);
+}
+
+/***MATRIX3 / MATRIX4***/
+// raises a script exception if the element is out of range
+static bool MatrixCheckIndex(unsigned int row, unsigned int col, unsigned int dim)
+{
+	if(row < dim && col < dim) return true;
+	asIScriptContext *ctx = asGetActiveContext();
+	if(ctx) ctx->SetException("Index out of bounds");
+	return false;
+}
+
+// Ogre leaves the matrices uninitialised, scripts get the identity instead
+static void Matrix3DefaultConstructor(Matrix3 *self)
+{
+	new(self) Matrix3(Matrix3::IDENTITY);
+}
+
+static void Matrix3CopyConstructor(const Matrix3 &other, Matrix3 *self)
+{
+	new(self) Matrix3(other);
+}
+
+static void Matrix3InitConstructor(float e00, float e01, float e02, float e10, float e11, float e12, float e20, float e21, float e22, Matrix3 *self)
+{
+	new(self) Matrix3(e00, e01, e02, e10, e11, e12, e20, e21, e22);
+}
+
+static float Matrix3Get(unsigned int row, unsigned int col, const Matrix3 *self)
+{
+	if(!MatrixCheckIndex(row, col, 3)) return 0.0f;
+	return (*self)[row][col];
+}
+
+static void Matrix3Set(unsigned int row, unsigned int col, float value, Matrix3 *self)
+{
+	if(MatrixCheckIndex(row, col, 3)) (*self)[row][col] = value;
+}
+
+static Vector3 Matrix3GetColumn(unsigned int col, const Matrix3 *self)
+{
+	if(!MatrixCheckIndex(0, col, 3)) return Vector3::ZERO;
+	return self->GetColumn(col);
+}
+
+static void Matrix3SetColumn(unsigned int col, const Vector3 &v, Matrix3 *self)
+{
+	if(MatrixCheckIndex(0, col, 3)) self->SetColumn(col, v);
+}
+
+static Matrix3 Matrix3Inverse(const Matrix3 *self)
+{
+	return self->Inverse();
+}
+
+static void Matrix4DefaultConstructor(Matrix4 *self)
+{
+	new(self) Matrix4(Matrix4::IDENTITY);
+}
+
+static void Matrix4CopyConstructor(const Matrix4 &other, Matrix4 *self)
+{
+	new(self) Matrix4(other);
+}
+
+static void Matrix4InitConstructor(float m00, float m01, float m02, float m03, float m10, float m11, float m12, float m13, float m20, float m21, float m22, float m23, float m30, float m31, float m32, float m33, Matrix4 *self)
+{
+	new(self) Matrix4(m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23, m30, m31, m32, m33);
+}
+
+static void Matrix4Matrix3Constructor(const Matrix3 &m, Matrix4 *self)
+{
+	new(self) Matrix4(m);
+}
+
+static void Matrix4QuaternionConstructor(const Quaternion &q, Matrix4 *self)
+{
+	new(self) Matrix4(q);
+}
+
+static float Matrix4Get(unsigned int row, unsigned int col, const Matrix4 *self)
+{
+	if(!MatrixCheckIndex(row, col, 4)) return 0.0f;
+	return (*self)[row][col];
+}
+
+static void Matrix4Set(unsigned int row, unsigned int col, float value, Matrix4 *self)
+{
+	if(MatrixCheckIndex(row, col, 4)) (*self)[row][col] = value;
+}
+
+/***RAY***/
+static void RayDefaultConstructor(Ray *self)
+{
+	new(self) Ray();
+}
+
+static void RayCopyConstructor(const Ray &other, Ray *self)
+{
+	new(self) Ray(other);
+}
+
+static void RayInitConstructor(const Vector3 &origin, const Vector3 &direction, Ray *self)
+{
+	new(self) Ray(origin, direction);
+}
+
+// Ogre returns the hit and the distance as std::pair, scripts get the distance as out parameter
+static bool RayIntersectsPlane(const Plane &p, float &distance, const Ray *self)
+{
+	std::pair<bool, Real> res = self->intersects(p);
+	distance = res.second;
+	return res.first;
+}
+
+static bool RayIntersectsSphere(const Sphere &s, float &distance, const Ray *self)
+{
+	std::pair<bool, Real> res = self->intersects(s);
+	distance = res.second;
+	return res.first;
+}
+
+static bool RayIntersectsBox(const AxisAlignedBox &box, float &distance, const Ray *self)
+{
+	std::pair<bool, Real> res = self->intersects(box);
+	distance = res.second;
+	return res.first;
+}
+
+// raises a script exception if the corner arrays don't describe the same boxes
+static bool BoxArraysCheckSize(const Vector3Array &mins, const Vector3Array &maxs)
+{
+	if(mins.size() == maxs.size()) return true;
+	asIScriptContext *ctx = asGetActiveContext();
+	if(ctx) ctx->SetException("Array sizes differ");
+	return false;
+}
+
+static void RayIntersectBoxes(const Vector3Array &mins, const Vector3Array &maxs, CScriptArray &boxes, CScriptArray &distances, const Ray *self)
+{
+	if(!BoxArraysCheckSize(mins, maxs)) return;
+
+	std::vector<unsigned int> hits;
+	std::vector<float> hitDistances;
+	unsigned int count = intersectRayBoxes(*self, mins, maxs, hits, hitDistances);
+	boxes.Resize(count);
+	distances.Resize(count);
+	if(!count || boxes.GetSize() != count || distances.GetSize() != count) return;
+	std::copy(hits.begin(), hits.end(), (unsigned int *)boxes.At(0));
+	std::copy(hitDistances.begin(), hitDistances.end(), (float *)distances.At(0));
+}
+
+static void ScriptFindPointsInBoxes(const Vector3Array &positions, const Vector3Array &mins, const Vector3Array &maxs, CScriptArray &points, CScriptArray &boxes)
+{
+	if(!BoxArraysCheckSize(mins, maxs)) return;
+
+	std::vector<unsigned int> pointHits, boxHits;
+	unsigned int count = findPointsInBoxes(positions, mins, maxs, pointHits, boxHits);
+	points.Resize(count);
+	boxes.Resize(count);
+	if(!count || points.GetSize() != count || boxes.GetSize() != count) return;
+	std::copy(pointHits.begin(), pointHits.end(), (unsigned int *)points.At(0));
+	std::copy(boxHits.begin(), boxHits.end(), (unsigned int *)boxes.At(0));
+}
+
+/***PLANE***/
+static void PlaneDefaultConstructor(Plane *self)
+{
+	new(self) Plane();
+}
+
+static void PlaneCopyConstructor(const Plane &other, Plane *self)
+{
+	new(self) Plane(other);
+}
+
+static void PlaneInitConstructor(const Vector3 &normal, float d, Plane *self)
+{
+	new(self) Plane(normal, d);
+}
+
+static void PlanePointConstructor(const Vector3 &normal, const Vector3 &point, Plane *self)
+{
+	new(self) Plane(normal, point);
+}
+
+static void PlanePointsConstructor(const Vector3 &p0, const Vector3 &p1, const Vector3 &p2, Plane *self)
+{
+	new(self) Plane(p0, p1, p2);
+}
+
+/***SPHERE***/
+static void SphereDefaultConstructor(Sphere *self)
+{
+	new(self) Sphere();
+}
+
+static void SphereCopyConstructor(const Sphere &other, Sphere *self)
+{
+	new(self) Sphere(other);
+}
+
+static void SphereInitConstructor(const Vector3 &center, float radius, Sphere *self)
+{
+	new(self) Sphere(center, radius);
+}
+
+/***AXISALIGNEDBOX***/
+static void AxisAlignedBoxDefaultConstructor(AxisAlignedBox *self)
+{
+	new(self) AxisAlignedBox();
+}
+
+static void AxisAlignedBoxCopyConstructor(const AxisAlignedBox &other, AxisAlignedBox *self)
+{
+	new(self) AxisAlignedBox(other);
+}
+
+static void AxisAlignedBoxInitConstructor(const Vector3 &min, const Vector3 &max, AxisAlignedBox *self)
+{
+	new(self) AxisAlignedBox(min, max);
+}
+
+static void AxisAlignedBoxDestructor(AxisAlignedBox *self)
+{
+	self->~AxisAlignedBox();
+}
+
 // main registration method
 void registerOgreObjects(AngelScript::asIScriptEngine *engine)
 {
@@ -178,11 +561,36 @@ void registerOgreObjects(AngelScript::asIScriptEngine *engine)
 
 	// Ogre::Quaternion
 	r = engine->RegisterObjectType("quaternion", sizeof(Quaternion), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS_CA); MYASSERT( r >= 0 );
+
+	// Vector3Array
+	r = engine->RegisterObjectType("vector3_array", sizeof(Vector3Array), asOBJ_VALUE | asOBJ_APP_CLASS_CDAK); MYASSERT( r >= 0 );
+
+	// KeyframeTrack and AnimationSampler
+	r = engine->RegisterObjectType("keyframe_track", sizeof(KeyframeTrack), asOBJ_VALUE | asOBJ_APP_CLASS_CDAK); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectType("animation_sampler", sizeof(AnimationSampler), asOBJ_VALUE | asOBJ_APP_CLASS_CDAK); MYASSERT( r >= 0 );
+
+	// Ogre::Matrix3 and Ogre::Matrix4
+	r = engine->RegisterObjectType("matrix3", sizeof(Matrix3), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS_CAK); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectType("matrix4", sizeof(Matrix4), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS_CA); MYASSERT( r >= 0 );
+
+	// Ogre::Ray, Ogre::Plane and Ogre::Sphere
+	r = engine->RegisterObjectType("ray", sizeof(Ray), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS_CA); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectType("plane", sizeof(Plane), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS_CAK); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectType("sphere", sizeof(Sphere), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS_CA); MYASSERT( r >= 0 );
+
+	// Ogre::AxisAlignedBox, it allocates its corners on demand
+	r = engine->RegisterObjectType("aabb", sizeof(AxisAlignedBox), asOBJ_VALUE | asOBJ_APP_CLASS_CDAK); MYASSERT( r >= 0 );
 	
 	registerOgreRadian(engine);
 	registerOgreDegree(engine);
 	registerOgreVector3(engine);
 	registerOgreQuaternion(engine);
+	registerOgreVector3Array(engine);
+	registerKeyframeTracks(engine);
+	registerOgreMatrices(engine);
+	registerOgreRay(engine);
+	registerOgrePlaneSphere(engine);
+	registerOgreAxisAlignedBox(engine);
 }
 
 // register Ogre::Vector3
@@ -196,75 +604,75 @@ void registerOgreVector3(AngelScript::asIScriptEngine *engine)
 	r = engine->RegisterObjectProperty("vector3", "float z", offsetof(Ogre::Vector3, z)); MYASSERT( r >= 0 );
 
 	// Register the object constructors
-	r = engine->RegisterObjectBehaviour("vector3", asBEHAVE_CONSTRUCT,  "void f()",                    asFUNCTION(Vector3DefaultConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("vector3", asBEHAVE_CONSTRUCT,  "void f(float, float, float)", asFUNCTION(Vector3InitConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("vector3", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in)",   asFUNCTION(Vector3CopyConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("vector3", asBEHAVE_CONSTRUCT,  "void f(float)",               asFUNCTION(Vector3InitConstructorScaler), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("vector3", asBEHAVE_CONSTRUCT,  "void f()",                    asPROFILED_FUNCTION_OBJLAST(Vector3DefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("vector3", asBEHAVE_CONSTRUCT,  "void f(float, float, float)", asPROFILED_FUNCTION_OBJLAST(Vector3InitConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("vector3", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in)",   asPROFILED_FUNCTION_OBJLAST(Vector3CopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("vector3", asBEHAVE_CONSTRUCT,  "void f(float)",               asPROFILED_FUNCTION_OBJLAST(Vector3InitConstructorScaler)); MYASSERT( r >= 0 );
 
 	// Register the object operators
-	r = engine->RegisterObjectMethod("vector3", "float opIndex(int) const",                  asMETHODPR(Vector3, operator[], (size_t) const, float), asCALL_THISCALL);MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 &f(const vector3 &in)",             asMETHODPR(Vector3, operator =, (const Vector3 &), Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "bool opEquals(const vector3 &in) const",    asMETHODPR(Vector3, operator==,(const Vector3&) const, bool), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "float opIndex(int) const",                  asPROFILED_METHODPR(Vector3, operator[], (size_t) const, float));MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &f(const vector3 &in)",             asPROFILED_METHODPR(Vector3, operator =, (const Vector3 &), Vector3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "bool opEquals(const vector3 &in) const",    asPROFILED_METHODPR(Vector3, operator==,(const Vector3&) const, bool)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("vector3", "vector3 opAdd(const vector3 &in) const",    asMETHODPR(Vector3, operator+,(const Vector3&) const, Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 opSub(const vector3 &in) const",    asMETHODPR(Vector3, operator-,(const Vector3&) const, Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 opAdd(const vector3 &in) const",    asPROFILED_METHODPR(Vector3, operator+,(const Vector3&) const, Vector3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 opSub(const vector3 &in) const",    asPROFILED_METHODPR(Vector3, operator-,(const Vector3&) const, Vector3)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "vector3 opMul(float) const",      asMETHODPR(Vector3, operator*,(const float) const, Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 opMul(const vector3 &in) const",    asMETHODPR(Vector3, operator*,(const Vector3&) const, Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 opDiv(float) const",      asMETHODPR(Vector3, operator/,(const float) const, Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 opDiv(const vector3 &in) const",    asMETHODPR(Vector3, operator/,(const Vector3&) const, Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 opMul(float) const",      asPROFILED_METHODPR(Vector3, operator*,(const float) const, Vector3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 opMul(const vector3 &in) const",    asPROFILED_METHODPR(Vector3, operator*,(const Vector3&) const, Vector3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 opDiv(float) const",      asPROFILED_METHODPR(Vector3, operator/,(const float) const, Vector3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 opDiv(const vector3 &in) const",    asPROFILED_METHODPR(Vector3, operator/,(const Vector3&) const, Vector3)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("vector3", "vector3 opAdd() const",                     asMETHODPR(Vector3, operator+,() const, const Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 opSub() const",                     asMETHODPR(Vector3, operator-,() const, Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 opAdd() const",                     asPROFILED_METHODPR(Vector3, operator+,() const, const Vector3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 opSub() const",                     asPROFILED_METHODPR(Vector3, operator-,() const, Vector3)); MYASSERT( r >= 0 );
 
 	//r = engine->RegisterObjectMethod("vector3", "vector3 opMul(float, const vector3 &in)", asMETHODPR(Vector3, operator*,(const float, const Vector3&), Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("vector3", "vector3 &opAddAssign(const vector3 &in)",   asMETHODPR(Vector3,operator+=,(const Vector3 &),Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 &opAddAssign(float)",     asMETHODPR(Vector3,operator+=,(const float),Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &opAddAssign(const vector3 &in)",   asPROFILED_METHODPR(Vector3,operator+=,(const Vector3 &),Vector3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &opAddAssign(float)",     asPROFILED_METHODPR(Vector3,operator+=,(const float),Vector3&)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "vector3 &opSubAssign(const vector3 &in)",   asMETHODPR(Vector3,operator-=,(const Vector3 &),Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 &opSubAssign(float)",     asMETHODPR(Vector3,operator-=,(const float),Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &opSubAssign(const vector3 &in)",   asPROFILED_METHODPR(Vector3,operator-=,(const Vector3 &),Vector3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &opSubAssign(float)",     asPROFILED_METHODPR(Vector3,operator-=,(const float),Vector3&)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "vector3 &opMulAssign(const vector3 &in)",   asMETHODPR(Vector3,operator*=,(const Vector3 &),Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 &opMulAssign(float)",     asMETHODPR(Vector3,operator*=,(const float),Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &opMulAssign(const vector3 &in)",   asPROFILED_METHODPR(Vector3,operator*=,(const Vector3 &),Vector3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &opMulAssign(float)",     asPROFILED_METHODPR(Vector3,operator*=,(const float),Vector3&)); MYASSERT( r >= 0 );
 
 	//r = engine->RegisterObjectMethod("vector3", "vector3& operator @= ( const vector3& rkVector f( const Vector3& rkVector )", asMETHOD(Ogre::Vector3, f), asCALL_THISCALL); MYASSERT(r>=0);
 	
-	r = engine->RegisterObjectMethod("vector3", "vector3 &opDivAssign(const vector3 &in)",   asMETHODPR(Vector3,operator/=,(const Vector3 &),Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 &opDivAssign(float)",     asMETHODPR(Vector3,operator/=,(const float),Vector3&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &opDivAssign(const vector3 &in)",   asPROFILED_METHODPR(Vector3,operator/=,(const Vector3 &),Vector3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 &opDivAssign(float)",     asPROFILED_METHODPR(Vector3,operator/=,(const float),Vector3&)); MYASSERT( r >= 0 );
 	
 	// r = engine->RegisterObjectMethod("vector3", "int opCmp(const vector3 &in) const",        asFUNCTION(Vector3Cmp), asCALL_CDECL_OBJFIRST); MYASSERT( r >= 0 );
 	
 	// Register the object methods
 	// r = engine->RegisterObjectMethod("vector3", "void swap(vector3 &inout)",  asMETHOD(Vector3,swap), asCALL_THISCALL); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "float length() const",        asMETHOD(Vector3,length), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "float squaredLength() const", asMETHOD(Vector3,squaredLength), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "float length() const",        asPROFILED_METHOD(Vector3,length)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "float squaredLength() const", asPROFILED_METHOD(Vector3,squaredLength)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "float distance(const vector3 &in) const",        asMETHOD(Vector3,distance), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "float squaredDistance(const vector3 &in) const", asMETHOD(Vector3,squaredDistance), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "float distance(const vector3 &in) const",        asPROFILED_METHOD(Vector3,distance)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "float squaredDistance(const vector3 &in) const", asPROFILED_METHOD(Vector3,squaredDistance)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "float dotProduct(const vector3 &in) const",    asMETHOD(Vector3,dotProduct), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "float absDotProduct(const vector3 &in) const", asMETHOD(Vector3,absDotProduct), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "float dotProduct(const vector3 &in) const",    asPROFILED_METHOD(Vector3,dotProduct)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "float absDotProduct(const vector3 &in) const", asPROFILED_METHOD(Vector3,absDotProduct)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "float normalise()", asMETHOD(Vector3,normalise), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "float crossProduct(const vector3 &in) const", asMETHOD(Vector3,crossProduct), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 midPoint(const vector3 &in) const", asMETHOD(Vector3,midPoint), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "void makeFloor(const vector3 &in)", asMETHOD(Vector3,makeFloor), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "void makeCeil(const vector3 &in)", asMETHOD(Vector3,makeCeil), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 perpendicular() const", asMETHOD(Vector3,perpendicular), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 randomDeviant(const radian &in, const vector3 &in) const", asMETHOD(Vector3,randomDeviant), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "radian angleBetween(const vector3 &in)", asMETHOD(Vector3,angleBetween), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "quaternion getRotationTo(const vector3 &in, const vector3 &in) const", asMETHOD(Vector3,getRotationTo), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "bool isZeroLength() const", asMETHOD(Vector3,isZeroLength), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 normalisedCopy() const", asMETHOD(Vector3,normalisedCopy), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "vector3 reflect(const vector3 &in) const", asMETHOD(Vector3,reflect), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "float normalise()", asPROFILED_METHOD(Vector3,normalise)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 crossProduct(const vector3 &in) const", asPROFILED_METHOD(Vector3,crossProduct)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 midPoint(const vector3 &in) const", asPROFILED_METHOD(Vector3,midPoint)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "void makeFloor(const vector3 &in)", asPROFILED_METHOD(Vector3,makeFloor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "void makeCeil(const vector3 &in)", asPROFILED_METHOD(Vector3,makeCeil)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 perpendicular() const", asPROFILED_METHOD(Vector3,perpendicular)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 randomDeviant(const radian &in, const vector3 &in) const", asPROFILED_METHOD(Vector3,randomDeviant)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "radian angleBetween(const vector3 &in)", asPROFILED_METHOD(Vector3,angleBetween)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "quaternion getRotationTo(const vector3 &in, const vector3 &in) const", asPROFILED_METHOD(Vector3,getRotationTo)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "bool isZeroLength() const", asPROFILED_METHOD(Vector3,isZeroLength)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 normalisedCopy() const", asPROFILED_METHOD(Vector3,normalisedCopy)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "vector3 reflect(const vector3 &in) const", asPROFILED_METHOD(Vector3,reflect)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "bool positionEquals(const vector3 &in, float) const",  asMETHOD(Vector3,positionEquals), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "bool positionCloses(const vector3 &in, float) const",  asMETHOD(Vector3,positionCloses), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("vector3", "bool directionEquals(const vector3 &in, radian &in) const", asMETHOD(Vector3,directionEquals), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "bool positionEquals(const vector3 &in, float) const",  asPROFILED_METHOD(Vector3,positionEquals)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "bool positionCloses(const vector3 &in, float) const",  asPROFILED_METHOD(Vector3,positionCloses)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "bool directionEquals(const vector3 &in, radian &in) const", asPROFILED_METHOD(Vector3,directionEquals)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("vector3", "bool isNaN() const", asMETHOD(Vector3,isNaN), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3", "bool isNaN() const", asPROFILED_METHOD(Vector3,isNaN)); MYASSERT( r >= 0 );
 }
 
 void registerOgreRadian(AngelScript::asIScriptEngine *engine)
@@ -272,50 +680,50 @@ void registerOgreRadian(AngelScript::asIScriptEngine *engine)
 	int r;
 
 	// Register the object constructors
-	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_CONSTRUCT,  "void f()",                 asFUNCTION(RadianDefaultConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_CONSTRUCT,  "void f(float)",            asFUNCTION(RadianInitConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_CONSTRUCT,  "void f(const radian &in)", asFUNCTION(RadianCopyConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_CONSTRUCT,  "void f()",                 asPROFILED_FUNCTION_OBJLAST(RadianDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_CONSTRUCT,  "void f(float)",            asPROFILED_FUNCTION_OBJLAST(RadianInitConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_CONSTRUCT,  "void f(const radian &in)", asPROFILED_FUNCTION_OBJLAST(RadianCopyConstructor)); MYASSERT( r >= 0 );
 
 	// Register other object behaviours
-	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_IMPLICIT_VALUE_CAST, "float f() const", asMETHOD(Radian,valueRadians), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_IMPLICIT_VALUE_CAST, "double f() const", asMETHOD(Radian,valueRadians), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_IMPLICIT_VALUE_CAST, "float f() const", asPROFILED_METHOD(Radian,valueRadians)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("radian", asBEHAVE_IMPLICIT_VALUE_CAST, "double f() const", asPROFILED_METHOD(Radian,valueRadians)); MYASSERT( r >= 0 );
 	
 	// Register the object operators
-	r = engine->RegisterObjectMethod("radian", "radian &opAssign(const radian &in)",      asMETHODPR(Radian, operator =, (const Radian &), Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian &opAssign(const float)",       asMETHODPR(Radian, operator =, (const float &), Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian &opAssign(const degree &in)",      asMETHODPR(Radian, operator =, (const Degree &), Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opAssign(const radian &in)",      asPROFILED_METHODPR(Radian, operator =, (const Radian &), Radian&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opAssign(const float)",       asPROFILED_METHODPR(Radian, operator =, (const float &), Radian&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opAssign(const degree &in)",      asPROFILED_METHODPR(Radian, operator =, (const Degree &), Radian&)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("radian", "radian opAdd() const",                    asMETHODPR(Radian, operator+,() const, const Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian opAdd(const radian &in) const",    asMETHODPR(Radian, operator+,(const Radian&) const, Radian), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian opAdd(const degree &in) const",    asMETHODPR(Radian, operator+,(const Degree&) const, Radian), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opAdd() const",                    asPROFILED_METHODPR(Radian, operator+,() const, const Radian&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opAdd(const radian &in) const",    asPROFILED_METHODPR(Radian, operator+,(const Radian&) const, Radian)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opAdd(const degree &in) const",    asPROFILED_METHODPR(Radian, operator+,(const Degree&) const, Radian)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("radian", "radian &opAddAssign(const radian &in)",   asMETHODPR(Radian,operator+=,(const Radian &),Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian &opAddAssign(const degree &in)",   asMETHODPR(Radian,operator+=,(const Degree &),Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opAddAssign(const radian &in)",   asPROFILED_METHODPR(Radian,operator+=,(const Radian &),Radian&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opAddAssign(const degree &in)",   asPROFILED_METHODPR(Radian,operator+=,(const Degree &),Radian&)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("radian", "radian opSub() const",                    asMETHODPR(Radian, operator-,() const, Radian), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian opSub(const radian &in) const",    asMETHODPR(Radian, operator-,(const Radian&) const, Radian), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian opSub(const degree &in) const",    asMETHODPR(Radian, operator-,(const Degree&) const, Radian), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opSub() const",                    asPROFILED_METHODPR(Radian, operator-,() const, Radian)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opSub(const radian &in) const",    asPROFILED_METHODPR(Radian, operator-,(const Radian&) const, Radian)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opSub(const degree &in) const",    asPROFILED_METHODPR(Radian, operator-,(const Degree&) const, Radian)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("radian", "radian &opSubAssign(const radian &in)",   asMETHODPR(Radian,operator-=,(const Radian &),Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian &opSubAssign(const degree &in)",   asMETHODPR(Radian,operator-=,(const Degree &),Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opSubAssign(const radian &in)",   asPROFILED_METHODPR(Radian,operator-=,(const Radian &),Radian&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opSubAssign(const degree &in)",   asPROFILED_METHODPR(Radian,operator-=,(const Degree &),Radian&)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("radian", "radian opMul(float) const",           asMETHODPR(Radian, operator*,(float) const, Radian), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "radian opMul(const radian &in) const",    asMETHODPR(Radian, operator*,(const Radian&) const, Radian), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opMul(float) const",           asPROFILED_METHODPR(Radian, operator*,(float) const, Radian)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opMul(const radian &in) const",    asPROFILED_METHODPR(Radian, operator*,(const Radian&) const, Radian)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("radian", "radian &opMulAssign(float)",          asMETHODPR(Radian,operator*=,(float),Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opMulAssign(float)",          asPROFILED_METHODPR(Radian,operator*=,(float),Radian&)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("radian", "radian opDiv(float) const",           asMETHODPR(Radian, operator/,(float) const, Radian), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian opDiv(float) const",           asPROFILED_METHODPR(Radian, operator/,(float) const, Radian)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("radian", "radian &opDivAssign(float)",          asMETHODPR(Radian,operator*=,(float),Radian&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "radian &opDivAssign(float)",          asPROFILED_METHODPR(Radian,operator*=,(float),Radian&)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("radian", "int opCmp(const radian &in) const",       asFUNCTION(RadianCmp), asCALL_CDECL_OBJFIRST); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "int opCmp(const radian &in) const",       asPROFILED_FUNCTION_OBJFIRST(RadianCmp)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("radian", "bool opEquals(const radian &in) const",   asMETHODPR(Radian, operator==,(const Radian&) const, bool), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "bool opEquals(const radian &in) const",   asPROFILED_METHODPR(Radian, operator==,(const Radian&) const, bool)); MYASSERT( r >= 0 );
 
 	// Register the object methods
-	r = engine->RegisterObjectMethod("radian", "float valueDegrees() const",    asMETHOD(Radian,valueDegrees), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "float valueRadians() const",    asMETHOD(Radian,valueRadians), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("radian", "float valueAngleUnits() const", asMETHOD(Radian,valueAngleUnits), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "float valueDegrees() const",    asPROFILED_METHOD(Radian,valueDegrees)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "float valueRadians() const",    asPROFILED_METHOD(Radian,valueRadians)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("radian", "float valueAngleUnits() const", asPROFILED_METHOD(Radian,valueAngleUnits)); MYASSERT( r >= 0 );
 }
 
 void registerOgreDegree(AngelScript::asIScriptEngine *engine)
@@ -323,50 +731,50 @@ void registerOgreDegree(AngelScript::asIScriptEngine *engine)
 	int r;
 
 	// Register the object constructors
-	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_CONSTRUCT,  "void f()",                    asFUNCTION(DegreeDefaultConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_CONSTRUCT,  "void f(float)", asFUNCTION(DegreeInitConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_CONSTRUCT,  "void f(const degree &in)",   asFUNCTION(DegreeCopyConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_CONSTRUCT,  "void f()",                    asPROFILED_FUNCTION_OBJLAST(DegreeDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_CONSTRUCT,  "void f(float)", asPROFILED_FUNCTION_OBJLAST(DegreeInitConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_CONSTRUCT,  "void f(const degree &in)",   asPROFILED_FUNCTION_OBJLAST(DegreeCopyConstructor)); MYASSERT( r >= 0 );
 
 	// Register other object behaviours
-	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_IMPLICIT_VALUE_CAST, "float f() const", asMETHOD(Degree,valueDegrees), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_IMPLICIT_VALUE_CAST, "double f() const", asMETHOD(Degree,valueDegrees), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_IMPLICIT_VALUE_CAST, "float f() const", asPROFILED_METHOD(Degree,valueDegrees)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("degree", asBEHAVE_IMPLICIT_VALUE_CAST, "double f() const", asPROFILED_METHOD(Degree,valueDegrees)); MYASSERT( r >= 0 );
 	
 	// Register the object operators
-	r = engine->RegisterObjectMethod("degree", "degree &opAssign(const degree &in)",      asMETHODPR(Degree, operator =, (const Degree &), Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree &opAssign(float)",       asMETHODPR(Degree, operator =, (const float &), Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree &opAssign(const radian &in)",      asMETHODPR(Degree, operator =, (const Radian &), Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opAssign(const degree &in)",      asPROFILED_METHODPR(Degree, operator =, (const Degree &), Degree&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opAssign(float)",       asPROFILED_METHODPR(Degree, operator =, (const float &), Degree&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opAssign(const radian &in)",      asPROFILED_METHODPR(Degree, operator =, (const Radian &), Degree&)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("degree", "degree opAdd() const",                    asMETHODPR(Degree, operator+,() const, const Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree opAdd(const degree &in) const",    asMETHODPR(Degree, operator+,(const Degree&) const, Degree), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree opAdd(const radian &in) const",    asMETHODPR(Degree, operator+,(const Radian&) const, Degree), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opAdd() const",                    asPROFILED_METHODPR(Degree, operator+,() const, const Degree&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opAdd(const degree &in) const",    asPROFILED_METHODPR(Degree, operator+,(const Degree&) const, Degree)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opAdd(const radian &in) const",    asPROFILED_METHODPR(Degree, operator+,(const Radian&) const, Degree)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("degree", "degree &opAddAssign(const degree &in)",   asMETHODPR(Degree,operator+=,(const Degree &),Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree &opAddAssign(const radian &in)",   asMETHODPR(Degree,operator+=,(const Radian &),Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opAddAssign(const degree &in)",   asPROFILED_METHODPR(Degree,operator+=,(const Degree &),Degree&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opAddAssign(const radian &in)",   asPROFILED_METHODPR(Degree,operator+=,(const Radian &),Degree&)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("degree", "degree opSub() const",                    asMETHODPR(Degree, operator-,() const, Degree), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree opSub(const degree &in) const",    asMETHODPR(Degree, operator-,(const Degree&) const, Degree), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree opSub(const radian &in) const",    asMETHODPR(Degree, operator-,(const Radian&) const, Degree), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opSub() const",                    asPROFILED_METHODPR(Degree, operator-,() const, Degree)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opSub(const degree &in) const",    asPROFILED_METHODPR(Degree, operator-,(const Degree&) const, Degree)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opSub(const radian &in) const",    asPROFILED_METHODPR(Degree, operator-,(const Radian&) const, Degree)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("degree", "degree &opSubAssign(const degree &in)",   asMETHODPR(Degree,operator-=,(const Degree &),Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree &opSubAssign(const radian &in)",   asMETHODPR(Degree,operator-=,(const Radian &),Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opSubAssign(const degree &in)",   asPROFILED_METHODPR(Degree,operator-=,(const Degree &),Degree&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opSubAssign(const radian &in)",   asPROFILED_METHODPR(Degree,operator-=,(const Radian &),Degree&)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("degree", "degree opMul(float) const",           asMETHODPR(Degree, operator*,(float) const, Degree), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "degree opMul(const degree &in) const",    asMETHODPR(Degree, operator*,(const Degree&) const, Degree), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opMul(float) const",           asPROFILED_METHODPR(Degree, operator*,(float) const, Degree)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opMul(const degree &in) const",    asPROFILED_METHODPR(Degree, operator*,(const Degree&) const, Degree)); MYASSERT( r >= 0 );
 	
-	r = engine->RegisterObjectMethod("degree", "degree &opMulAssign(float)",          asMETHODPR(Degree,operator*=,(float),Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opMulAssign(float)",          asPROFILED_METHODPR(Degree,operator*=,(float),Degree&)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("degree", "degree opDiv(float) const",           asMETHODPR(Degree, operator/,(float) const, Degree), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree opDiv(float) const",           asPROFILED_METHODPR(Degree, operator/,(float) const, Degree)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("degree", "degree &opDivAssign(float)",          asMETHODPR(Degree,operator*=,(float),Degree&), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "degree &opDivAssign(float)",          asPROFILED_METHODPR(Degree,operator*=,(float),Degree&)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("degree", "int opCmp(const degree &in) const",       asFUNCTION(DegreeCmp), asCALL_CDECL_OBJFIRST); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "int opCmp(const degree &in) const",       asPROFILED_FUNCTION_OBJFIRST(DegreeCmp)); MYASSERT( r >= 0 );
 
-	r = engine->RegisterObjectMethod("degree", "bool opEquals(const degree &in) const",   asMETHODPR(Degree, operator==,(const Degree&) const, bool), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "bool opEquals(const degree &in) const",   asPROFILED_METHODPR(Degree, operator==,(const Degree&) const, bool)); MYASSERT( r >= 0 );
 
 	// Register the object methods
-	r = engine->RegisterObjectMethod("degree", "float valueRadians() const",    asMETHOD(Degree,valueRadians), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "float valueDegrees() const",    asMETHOD(Degree,valueDegrees), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("degree", "float valueAngleUnits() const", asMETHOD(Degree,valueAngleUnits), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "float valueRadians() const",    asPROFILED_METHOD(Degree,valueRadians)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "float valueDegrees() const",    asPROFILED_METHOD(Degree,valueDegrees)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("degree", "float valueAngleUnits() const", asPROFILED_METHOD(Degree,valueAngleUnits)); MYASSERT( r >= 0 );
 
 }
 
@@ -385,43 +793,300 @@ void registerOgreQuaternion(AngelScript::asIScriptEngine *engine)
 
 
 	// Register the object constructors
-	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f()",                    asFUNCTION(QuaternionDefaultConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(const radian &in, const vector3 &in)", asFUNCTION(QuaternionInitConstructor1), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(float, float, float, float)", asFUNCTION(QuaternionInitConstructor2), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in, const vector3 &in, const vector3 &in)", asFUNCTION(QuaternionInitConstructor3), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(float)",           asFUNCTION(QuaternionInitConstructorScaler), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(const quaternion &in)",   asFUNCTION(QuaternionCopyConstructor), asCALL_CDECL_OBJLAST); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f()",                    asPROFILED_FUNCTION_OBJLAST(QuaternionDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(const radian &in, const vector3 &in)", asPROFILED_FUNCTION_OBJLAST(QuaternionInitConstructor1)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(float, float, float, float)", asPROFILED_FUNCTION_OBJLAST(QuaternionInitConstructor2)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in, const vector3 &in, const vector3 &in)", asPROFILED_FUNCTION_OBJLAST(QuaternionInitConstructor3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(float)",           asPROFILED_FUNCTION_OBJLAST(QuaternionInitConstructorScaler)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("quaternion", asBEHAVE_CONSTRUCT,  "void f(const quaternion &in)",   asPROFILED_FUNCTION_OBJLAST(QuaternionCopyConstructor)); MYASSERT( r >= 0 );
 
 	// Register the object operators
-	r = engine->RegisterObjectMethod("quaternion", "float opIndex(int) const",                        asMETHODPR(Quaternion, operator[], (size_t) const, float), asCALL_THISCALL);MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion &opAssign(const quaternion &in)",      asMETHODPR(Quaternion, operator =, (const Quaternion &), Quaternion&), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion opAdd(const quaternion &in) const",    asMETHODPR(Quaternion, operator+,(const Quaternion&) const, Quaternion), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion opSub(const quaternion &in) const",    asMETHODPR(Quaternion, operator-,(const Quaternion&) const, Quaternion), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion opMul(const quaternion &in) const",    asMETHODPR(Quaternion, operator*,(const Quaternion&) const, Quaternion), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion opMul(float) const",               asMETHODPR(Quaternion, operator*,(float) const, Quaternion), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion opSub() const",                        asMETHODPR(Quaternion, operator-,() const, Quaternion), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "bool opEquals(const quaternion &in) const",       asMETHODPR(Quaternion, operator==,(const Quaternion&) const, bool), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "vector3 opMul(const vector3 &in) const",          asMETHODPR(Quaternion, operator*,(const Vector3&) const, Vector3), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "float opIndex(int) const",                        asPROFILED_METHODPR(Quaternion, operator[], (size_t) const, float));MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion &opAssign(const quaternion &in)",      asPROFILED_METHODPR(Quaternion, operator =, (const Quaternion &), Quaternion&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion opAdd(const quaternion &in) const",    asPROFILED_METHODPR(Quaternion, operator+,(const Quaternion&) const, Quaternion)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion opSub(const quaternion &in) const",    asPROFILED_METHODPR(Quaternion, operator-,(const Quaternion&) const, Quaternion)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion opMul(const quaternion &in) const",    asPROFILED_METHODPR(Quaternion, operator*,(const Quaternion&) const, Quaternion)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion opMul(float) const",               asPROFILED_METHODPR(Quaternion, operator*,(float) const, Quaternion)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion opSub() const",                        asPROFILED_METHODPR(Quaternion, operator-,() const, Quaternion)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "bool opEquals(const quaternion &in) const",       asPROFILED_METHODPR(Quaternion, operator==,(const Quaternion&) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "vector3 opMul(const vector3 &in) const",          asPROFILED_METHODPR(Quaternion, operator*,(const Vector3&) const, Vector3)); MYASSERT( r >= 0 );
 	
 	// Register the object methods
-	r = engine->RegisterObjectMethod("quaternion", "float Dot(const quaternion &in) const",    asMETHOD(Quaternion,Dot), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "float Norm() const",    asMETHOD(Quaternion,Norm), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "float normalise()",    asMETHOD(Quaternion,normalise), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion Inverse() const",    asMETHOD(Quaternion,Inverse), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion UnitInverse() const",    asMETHOD(Quaternion,UnitInverse), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion Exp() const",    asMETHOD(Quaternion,Exp), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "quaternion Log() const",    asMETHOD(Quaternion,Log), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "radian getRoll(bool) const",    asMETHOD(Quaternion,getRoll), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "radian getPitch(bool) const",    asMETHOD(Quaternion,getPitch), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "radian getYaw(bool) const",    asMETHOD(Quaternion,getYaw), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "bool equals(const quaternion &in, const radian &in) const",    asMETHOD(Quaternion,equals), asCALL_THISCALL); MYASSERT( r >= 0 );
-	r = engine->RegisterObjectMethod("quaternion", "bool isNaN() const", asMETHOD(Quaternion,isNaN), asCALL_THISCALL); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "float Dot(const quaternion &in) const",    asPROFILED_METHOD(Quaternion,Dot)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "float Norm() const",    asPROFILED_METHOD(Quaternion,Norm)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "float normalise()",    asPROFILED_METHOD(Quaternion,normalise)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion Inverse() const",    asPROFILED_METHOD(Quaternion,Inverse)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion UnitInverse() const",    asPROFILED_METHOD(Quaternion,UnitInverse)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion Exp() const",    asPROFILED_METHOD(Quaternion,Exp)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "quaternion Log() const",    asPROFILED_METHOD(Quaternion,Log)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "radian getRoll(bool) const",    asPROFILED_METHOD(Quaternion,getRoll)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "radian getPitch(bool) const",    asPROFILED_METHOD(Quaternion,getPitch)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "radian getYaw(bool) const",    asPROFILED_METHOD(Quaternion,getYaw)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "bool equals(const quaternion &in, const radian &in) const",    asPROFILED_METHOD(Quaternion,equals)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("quaternion", "bool isNaN() const", asPROFILED_METHOD(Quaternion,isNaN)); MYASSERT( r >= 0 );
 
 	// Register some static methods
-	r = engine->RegisterGlobalFunction("quaternion Slerp(float, const quaternion &in, const quaternion &in, bool &in)",  asFUNCTIONPR(Quaternion::Slerp,(Real fT, const Quaternion&, const Quaternion&, bool), Quaternion), asCALL_CDECL); MYASSERT( r >= 0 );
-	r = engine->RegisterGlobalFunction("quaternion SlerpExtraSpins(float, const quaternion &in, const quaternion &in, int &in)",    asFUNCTION(Quaternion::SlerpExtraSpins), asCALL_CDECL); MYASSERT( r >= 0 );
-	r = engine->RegisterGlobalFunction("void Intermediate(const quaternion &in, const quaternion &in, const quaternion &in, const quaternion &in, const quaternion &in)",    asFUNCTION(Quaternion::Intermediate), asCALL_CDECL); MYASSERT( r >= 0 );
-	r = engine->RegisterGlobalFunction("quaternion Squad(float, const quaternion &in, const quaternion &in, const quaternion &in, const quaternion &in, bool &in)",    asFUNCTION(Quaternion::Squad), asCALL_CDECL); MYASSERT( r >= 0 );
-	r = engine->RegisterGlobalFunction("quaternion nlerp(float, const quaternion &in, const quaternion &in, bool &in)",    asFUNCTION(Quaternion::nlerp), asCALL_CDECL); MYASSERT( r >= 0 );
+	r = engine->RegisterGlobalFunction("quaternion Slerp(float, const quaternion &in, const quaternion &in, bool &in)",  asPROFILED_FUNCTIONPR(Quaternion::Slerp,(Real fT, const Quaternion&, const Quaternion&, bool), Quaternion)); MYASSERT( r >= 0 );
+	r = engine->RegisterGlobalFunction("quaternion SlerpExtraSpins(float, const quaternion &in, const quaternion &in, int &in)",    asPROFILED_FUNCTION(Quaternion::SlerpExtraSpins)); MYASSERT( r >= 0 );
+	r = engine->RegisterGlobalFunction("void Intermediate(const quaternion &in, const quaternion &in, const quaternion &in, const quaternion &in, const quaternion &in)",    asPROFILED_FUNCTION(Quaternion::Intermediate)); MYASSERT( r >= 0 );
+	r = engine->RegisterGlobalFunction("quaternion Squad(float, const quaternion &in, const quaternion &in, const quaternion &in, const quaternion &in, bool &in)",    asPROFILED_FUNCTION(Quaternion::Squad)); MYASSERT( r >= 0 );
+	r = engine->RegisterGlobalFunction("quaternion nlerp(float, const quaternion &in, const quaternion &in, bool &in)",    asPROFILED_FUNCTION(Quaternion::nlerp)); MYASSERT( r >= 0 );
 	
 }
+
+// register Vector3Array, the bulk operations work on all elements in one call
+void registerOgreVector3Array(AngelScript::asIScriptEngine *engine)
+{
+	int r;
+
+	// Register the object behaviours
+	r = engine->RegisterObjectBehaviour("vector3_array", asBEHAVE_CONSTRUCT,  "void f()",                        asPROFILED_FUNCTION_OBJLAST(Vector3ArrayDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("vector3_array", asBEHAVE_CONSTRUCT,  "void f(uint)",                    asPROFILED_FUNCTION_OBJLAST(Vector3ArraySizeConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("vector3_array", asBEHAVE_CONSTRUCT,  "void f(const vector3_array &in)", asPROFILED_FUNCTION_OBJLAST(Vector3ArrayCopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("vector3_array", asBEHAVE_DESTRUCT,   "void f()",                        asPROFILED_FUNCTION_OBJLAST(Vector3ArrayDestructor)); MYASSERT( r >= 0 );
+
+	// Register the element access
+	r = engine->RegisterObjectMethod("vector3_array", "vector3_array &opAssign(const vector3_array &in)", asPROFILED_METHODPR(Vector3Array, operator=, (const Vector3Array &), Vector3Array&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "vector3 opIndex(uint) const",           asPROFILED_FUNCTION_OBJLAST(Vector3ArrayGet)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void set(uint, const vector3 &in)",     asPROFILED_FUNCTION_OBJLAST(Vector3ArraySet)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "uint size() const",                     asPROFILED_METHOD(Vector3Array, size)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void resize(uint)",                     asPROFILED_METHOD(Vector3Array, resize)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void clear()",                          asPROFILED_METHOD(Vector3Array, clear)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void insertLast(const vector3 &in)",    asPROFILED_METHOD(Vector3Array, push_back)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void fromArray(const array<vector3> &in)", asPROFILED_FUNCTION_OBJLAST(Vector3ArrayFromArray)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void toArray(array<vector3> &inout) const", asPROFILED_FUNCTION_OBJLAST(Vector3ArrayToArray)); MYASSERT( r >= 0 );
+
+	// Register the bulk operations
+	r = engine->RegisterObjectMethod("vector3_array", "void add(const vector3_array &in)",     asPROFILED_FUNCTION_OBJLAST(Vector3ArrayAdd)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void add(const vector3 &in)",           asPROFILED_METHODPR(Vector3Array, add, (const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void sub(const vector3_array &in)",     asPROFILED_FUNCTION_OBJLAST(Vector3ArraySub)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void scale(float)",                     asPROFILED_METHODPR(Vector3Array, scale, (float), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void scale(const vector3 &in)",         asPROFILED_METHODPR(Vector3Array, scale, (const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void cross(const vector3 &in)",         asPROFILED_METHODPR(Vector3Array, cross, (const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void cross(const vector3_array &in)",   asPROFILED_FUNCTION_OBJLAST(Vector3ArrayCross)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void normalise()",                      asPROFILED_METHOD(Vector3Array, normalise)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void rotate(const quaternion &in)",     asPROFILED_METHOD(Vector3Array, rotate)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void dot(const vector3 &in, array<float> &inout) const",       asPROFILED_FUNCTION_OBJLAST(Vector3ArrayDot)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void dot(const vector3_array &in, array<float> &inout) const", asPROFILED_FUNCTION_OBJLAST(Vector3ArrayDotArray)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "void length(array<float> &inout) const",                       asPROFILED_FUNCTION_OBJLAST(Vector3ArrayLength)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("vector3_array", "bool getBounds(vector3 &out, vector3 &out) const",              asPROFILED_METHOD(Vector3Array, getBounds)); MYASSERT( r >= 0 );
+}
+
+// register KeyframeTrack and AnimationSampler
+void registerKeyframeTracks(AngelScript::asIScriptEngine *engine)
+{
+	int r;
+
+	r = engine->RegisterEnum("interpolation_mode"); MYASSERT( r >= 0 );
+	r = engine->RegisterEnumValue("interpolation_mode", "INTERPOLATE_NLERP", INTERPOLATE_NLERP); MYASSERT( r >= 0 );
+	r = engine->RegisterEnumValue("interpolation_mode", "INTERPOLATE_SLERP", INTERPOLATE_SLERP); MYASSERT( r >= 0 );
+	r = engine->RegisterEnumValue("interpolation_mode", "INTERPOLATE_SQUAD", INTERPOLATE_SQUAD); MYASSERT( r >= 0 );
+
+	// keyframe_track
+	r = engine->RegisterObjectBehaviour("keyframe_track", asBEHAVE_CONSTRUCT,  "void f()",                         asPROFILED_FUNCTION_OBJLAST(KeyframeTrackDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("keyframe_track", asBEHAVE_CONSTRUCT,  "void f(const keyframe_track &in)", asPROFILED_FUNCTION_OBJLAST(KeyframeTrackCopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("keyframe_track", asBEHAVE_DESTRUCT,   "void f()",                         asPROFILED_FUNCTION_OBJLAST(KeyframeTrackDestructor)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("keyframe_track", "keyframe_track &opAssign(const keyframe_track &in)", asPROFILED_METHODPR(KeyframeTrack, operator=, (const KeyframeTrack &), KeyframeTrack&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("keyframe_track", "void addKey(float, const quaternion &in, const vector3 &in)", asPROFILED_METHOD(KeyframeTrack, addKey)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("keyframe_track", "uint getKeyCount() const", asPROFILED_METHOD(KeyframeTrack, getKeyCount)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("keyframe_track", "float getLength() const",  asPROFILED_METHOD(KeyframeTrack, getLength)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("keyframe_track", "void clear()",             asPROFILED_METHOD(KeyframeTrack, clear)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("keyframe_track", "void sample(float, interpolation_mode, quaternion &out, vector3 &out) const", asPROFILED_METHOD(KeyframeTrack, sample)); MYASSERT( r >= 0 );
+
+	// animation_sampler
+	r = engine->RegisterObjectBehaviour("animation_sampler", asBEHAVE_CONSTRUCT,  "void f()",                            asPROFILED_FUNCTION_OBJLAST(AnimationSamplerDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("animation_sampler", asBEHAVE_CONSTRUCT,  "void f(const animation_sampler &in)", asPROFILED_FUNCTION_OBJLAST(AnimationSamplerCopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("animation_sampler", asBEHAVE_DESTRUCT,   "void f()",                            asPROFILED_FUNCTION_OBJLAST(AnimationSamplerDestructor)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("animation_sampler", "animation_sampler &opAssign(const animation_sampler &in)", asPROFILED_METHODPR(AnimationSampler, operator=, (const AnimationSampler &), AnimationSampler&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("animation_sampler", "uint addTrack(const keyframe_track &in)",       asPROFILED_METHOD(AnimationSampler, addTrack)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("animation_sampler", "void setTrack(uint, const keyframe_track &in)", asPROFILED_FUNCTION_OBJLAST(AnimationSamplerSetTrack)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("animation_sampler", "uint getTrackCount() const",                    asPROFILED_METHOD(AnimationSampler, getTrackCount)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("animation_sampler", "void clear()",                                  asPROFILED_METHOD(AnimationSampler, clear)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("animation_sampler", "void sample(float, interpolation_mode, array<quaternion> &inout, vector3_array &out)", asPROFILED_FUNCTION_OBJLAST(AnimationSamplerSample)); MYASSERT( r >= 0 );
+}
+
+// register Ogre::Matrix3 and Ogre::Matrix4
+void registerOgreMatrices(AngelScript::asIScriptEngine *engine)
+{
+	int r;
+
+	// matrix3
+	r = engine->RegisterObjectBehaviour("matrix3", asBEHAVE_CONSTRUCT,  "void f()",                  asPROFILED_FUNCTION_OBJLAST(Matrix3DefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("matrix3", asBEHAVE_CONSTRUCT,  "void f(const matrix3 &in)", asPROFILED_FUNCTION_OBJLAST(Matrix3CopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("matrix3", asBEHAVE_CONSTRUCT,  "void f(float, float, float, float, float, float, float, float, float)", asPROFILED_FUNCTION_OBJLAST(Matrix3InitConstructor)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("matrix3", "matrix3 &opAssign(const matrix3 &in)",   asPROFILED_METHODPR(Matrix3, operator=, (const Matrix3 &), Matrix3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "bool opEquals(const matrix3 &in) const", asPROFILED_METHODPR(Matrix3, operator==, (const Matrix3 &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "matrix3 opAdd(const matrix3 &in) const", asPROFILED_METHODPR(Matrix3, operator+, (const Matrix3 &) const, Matrix3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "matrix3 opSub(const matrix3 &in) const", asPROFILED_METHODPR(Matrix3, operator-, (const Matrix3 &) const, Matrix3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "matrix3 opMul(const matrix3 &in) const", asPROFILED_METHODPR(Matrix3, operator*, (const Matrix3 &) const, Matrix3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "vector3 opMul(const vector3 &in) const", asPROFILED_METHODPR(Matrix3, operator*, (const Vector3 &) const, Vector3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "matrix3 opMul(float) const",             asPROFILED_METHODPR(Matrix3, operator*, (Real) const, Matrix3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "matrix3 opSub() const",                  asPROFILED_METHODPR(Matrix3, operator-, () const, Matrix3)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("matrix3", "float get(uint, uint) const",            asPROFILED_FUNCTION_OBJLAST(Matrix3Get)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "void set(uint, uint, float)",            asPROFILED_FUNCTION_OBJLAST(Matrix3Set)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "vector3 GetColumn(uint) const",          asPROFILED_FUNCTION_OBJLAST(Matrix3GetColumn)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "void SetColumn(uint, const vector3 &in)", asPROFILED_FUNCTION_OBJLAST(Matrix3SetColumn)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "void FromAxes(const vector3 &in, const vector3 &in, const vector3 &in)", asPROFILED_METHOD(Matrix3, FromAxes)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "matrix3 Transpose() const",              asPROFILED_METHOD(Matrix3, Transpose)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "matrix3 Inverse() const",                asPROFILED_FUNCTION_OBJLAST(Matrix3Inverse)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "float Determinant() const",              asPROFILED_METHOD(Matrix3, Determinant)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "void Orthonormalize()",                  asPROFILED_METHOD(Matrix3, Orthonormalize)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "void ToAxisAngle(vector3 &out, radian &out) const",     asPROFILED_METHODPR(Matrix3, ToAxisAngle, (Vector3 &, Radian &) const, void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "void FromAxisAngle(const vector3 &in, const radian &in)", asPROFILED_METHOD(Matrix3, FromAxisAngle)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "bool ToEulerAnglesXYZ(radian &out, radian &out, radian &out) const", asPROFILED_METHOD(Matrix3, ToEulerAnglesXYZ)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "bool ToEulerAnglesYXZ(radian &out, radian &out, radian &out) const", asPROFILED_METHOD(Matrix3, ToEulerAnglesYXZ)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "void FromEulerAnglesXYZ(const radian &in, const radian &in, const radian &in)", asPROFILED_METHOD(Matrix3, FromEulerAnglesXYZ)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix3", "void FromEulerAnglesYXZ(const radian &in, const radian &in, const radian &in)", asPROFILED_METHOD(Matrix3, FromEulerAnglesYXZ)); MYASSERT( r >= 0 );
+
+	// matrix4
+	r = engine->RegisterObjectBehaviour("matrix4", asBEHAVE_CONSTRUCT,  "void f()",                     asPROFILED_FUNCTION_OBJLAST(Matrix4DefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("matrix4", asBEHAVE_CONSTRUCT,  "void f(const matrix4 &in)",    asPROFILED_FUNCTION_OBJLAST(Matrix4CopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("matrix4", asBEHAVE_CONSTRUCT,  "void f(const matrix3 &in)",    asPROFILED_FUNCTION_OBJLAST(Matrix4Matrix3Constructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("matrix4", asBEHAVE_CONSTRUCT,  "void f(const quaternion &in)", asPROFILED_FUNCTION_OBJLAST(Matrix4QuaternionConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("matrix4", asBEHAVE_CONSTRUCT,  "void f(float, float, float, float, float, float, float, float, float, float, float, float, float, float, float, float)", asPROFILED_FUNCTION_OBJLAST(Matrix4InitConstructor)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 &opAssign(const matrix4 &in)",   asPROFILED_METHODPR(Matrix4, operator=, (const Matrix4 &), Matrix4&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "bool opEquals(const matrix4 &in) const", asPROFILED_METHODPR(Matrix4, operator==, (const Matrix4 &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 opAdd(const matrix4 &in) const", asPROFILED_METHODPR(Matrix4, operator+, (const Matrix4 &) const, Matrix4)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 opSub(const matrix4 &in) const", asPROFILED_METHODPR(Matrix4, operator-, (const Matrix4 &) const, Matrix4)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 opMul(const matrix4 &in) const", asPROFILED_METHODPR(Matrix4, operator*, (const Matrix4 &) const, Matrix4)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "vector3 opMul(const vector3 &in) const", asPROFILED_METHODPR(Matrix4, operator*, (const Vector3 &) const, Vector3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "plane opMul(const plane &in) const",     asPROFILED_METHODPR(Matrix4, operator*, (const Plane &) const, Plane)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 opMul(float) const",             asPROFILED_METHODPR(Matrix4, operator*, (Real) const, Matrix4)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("matrix4", "float get(uint, uint) const",            asPROFILED_FUNCTION_OBJLAST(Matrix4Get)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "void set(uint, uint, float)",            asPROFILED_FUNCTION_OBJLAST(Matrix4Set)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 transpose() const",              asPROFILED_METHOD(Matrix4, transpose)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 inverse() const",                asPROFILED_METHOD(Matrix4, inverse)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 inverseAffine() const",          asPROFILED_METHOD(Matrix4, inverseAffine)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "bool isAffine() const",                  asPROFILED_METHOD(Matrix4, isAffine)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "matrix4 concatenateAffine(const matrix4 &in) const", asPROFILED_METHOD(Matrix4, concatenateAffine)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "vector3 transformAffine(const vector3 &in) const",   asPROFILED_METHODPR(Matrix4, transformAffine, (const Vector3 &) const, Vector3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "float determinant() const",              asPROFILED_METHOD(Matrix4, determinant)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "void setTrans(const vector3 &in)",       asPROFILED_METHOD(Matrix4, setTrans)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "vector3 getTrans() const",               asPROFILED_METHODPR(Matrix4, getTrans, () const, Vector3)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "void makeTrans(const vector3 &in)",      asPROFILED_METHODPR(Matrix4, makeTrans, (const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "void setScale(const vector3 &in)",       asPROFILED_METHOD(Matrix4, setScale)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "bool hasScale() const",                  asPROFILED_METHOD(Matrix4, hasScale)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "void extract3x3Matrix(matrix3 &out) const", asPROFILED_METHOD(Matrix4, extract3x3Matrix)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "quaternion extractQuaternion() const",   asPROFILED_METHOD(Matrix4, extractQuaternion)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "void makeTransform(const vector3 &in, const vector3 &in, const quaternion &in)", asPROFILED_METHOD(Matrix4, makeTransform)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("matrix4", "void decomposition(vector3 &out, vector3 &out, quaternion &out) const",         asPROFILED_METHOD(Matrix4, decomposition)); MYASSERT( r >= 0 );
+}
+
+// register Ogre::Ray and the batch intersection tests
+void registerOgreRay(AngelScript::asIScriptEngine *engine)
+{
+	int r;
+
+	r = engine->RegisterObjectBehaviour("ray", asBEHAVE_CONSTRUCT,  "void f()",                                asPROFILED_FUNCTION_OBJLAST(RayDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("ray", asBEHAVE_CONSTRUCT,  "void f(const ray &in)",                   asPROFILED_FUNCTION_OBJLAST(RayCopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("ray", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in, const vector3 &in)", asPROFILED_FUNCTION_OBJLAST(RayInitConstructor)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("ray", "ray &opAssign(const ray &in)",             asPROFILED_METHODPR(Ray, operator=, (const Ray &), Ray&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "vector3 opMul(float) const",               asPROFILED_METHOD(Ray, operator*)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "void setOrigin(const vector3 &in)",        asPROFILED_METHOD(Ray, setOrigin)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "const vector3 &getOrigin() const",         asPROFILED_METHOD(Ray, getOrigin)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "void setDirection(const vector3 &in)",     asPROFILED_METHOD(Ray, setDirection)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "const vector3 &getDirection() const",      asPROFILED_METHOD(Ray, getDirection)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "vector3 getPoint(float) const",            asPROFILED_METHOD(Ray, getPoint)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "bool intersects(const plane &in, float &out) const",  asPROFILED_FUNCTION_OBJLAST(RayIntersectsPlane)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "bool intersects(const sphere &in, float &out) const", asPROFILED_FUNCTION_OBJLAST(RayIntersectsSphere)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("ray", "bool intersects(const aabb &in, float &out) const",   asPROFILED_FUNCTION_OBJLAST(RayIntersectsBox)); MYASSERT( r >= 0 );
+
+	// batch tests, the boxes are given as arrays of their minimum and maximum corners
+	r = engine->RegisterObjectMethod("ray", "void intersectBoxes(const vector3_array &in, const vector3_array &in, array<uint> &inout, array<float> &inout) const", asPROFILED_FUNCTION_OBJLAST(RayIntersectBoxes)); MYASSERT( r >= 0 );
+	r = engine->RegisterGlobalFunction("void findPointsInBoxes(const vector3_array &in, const vector3_array &in, const vector3_array &in, array<uint> &inout, array<uint> &inout)", asPROFILED_FUNCTION(ScriptFindPointsInBoxes)); MYASSERT( r >= 0 );
+}
+
+// register Ogre::Plane and Ogre::Sphere
+void registerOgrePlaneSphere(AngelScript::asIScriptEngine *engine)
+{
+	int r;
+
+	r = engine->RegisterEnum("plane_side"); MYASSERT( r >= 0 );
+	r = engine->RegisterEnumValue("plane_side", "NO_SIDE",       Plane::NO_SIDE); MYASSERT( r >= 0 );
+	r = engine->RegisterEnumValue("plane_side", "POSITIVE_SIDE", Plane::POSITIVE_SIDE); MYASSERT( r >= 0 );
+	r = engine->RegisterEnumValue("plane_side", "NEGATIVE_SIDE", Plane::NEGATIVE_SIDE); MYASSERT( r >= 0 );
+	r = engine->RegisterEnumValue("plane_side", "BOTH_SIDE",     Plane::BOTH_SIDE); MYASSERT( r >= 0 );
+
+	// plane
+	r = engine->RegisterObjectProperty("plane", "vector3 normal", offsetof(Plane, normal)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectProperty("plane", "float d",        offsetof(Plane, d)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectBehaviour("plane", asBEHAVE_CONSTRUCT,  "void f()",                         asPROFILED_FUNCTION_OBJLAST(PlaneDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("plane", asBEHAVE_CONSTRUCT,  "void f(const plane &in)",          asPROFILED_FUNCTION_OBJLAST(PlaneCopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("plane", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in, float)", asPROFILED_FUNCTION_OBJLAST(PlaneInitConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("plane", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in, const vector3 &in)", asPROFILED_FUNCTION_OBJLAST(PlanePointConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("plane", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in, const vector3 &in, const vector3 &in)", asPROFILED_FUNCTION_OBJLAST(PlanePointsConstructor)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("plane", "plane &opAssign(const plane &in)",       asPROFILED_METHODPR(Plane, operator=, (const Plane &), Plane&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "bool opEquals(const plane &in) const",   asPROFILED_METHODPR(Plane, operator==, (const Plane &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "plane_side getSide(const vector3 &in) const",                  asPROFILED_METHODPR(Plane, getSide, (const Vector3 &) const, Plane::Side)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "plane_side getSide(const aabb &in) const",                     asPROFILED_METHODPR(Plane, getSide, (const AxisAlignedBox &) const, Plane::Side)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "plane_side getSide(const vector3 &in, const vector3 &in) const", asPROFILED_METHODPR(Plane, getSide, (const Vector3 &, const Vector3 &) const, Plane::Side)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "float getDistance(const vector3 &in) const",   asPROFILED_METHOD(Plane, getDistance)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "vector3 projectVector(const vector3 &in) const", asPROFILED_METHOD(Plane, projectVector)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "float normalise()",                           asPROFILED_METHOD(Plane, normalise)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "void redefine(const vector3 &in, const vector3 &in)", asPROFILED_METHODPR(Plane, redefine, (const Vector3 &, const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("plane", "void redefine(const vector3 &in, const vector3 &in, const vector3 &in)", asPROFILED_METHODPR(Plane, redefine, (const Vector3 &, const Vector3 &, const Vector3 &), void)); MYASSERT( r >= 0 );
+
+	// sphere
+	r = engine->RegisterObjectBehaviour("sphere", asBEHAVE_CONSTRUCT,  "void f()",                         asPROFILED_FUNCTION_OBJLAST(SphereDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("sphere", asBEHAVE_CONSTRUCT,  "void f(const sphere &in)",         asPROFILED_FUNCTION_OBJLAST(SphereCopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("sphere", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in, float)", asPROFILED_FUNCTION_OBJLAST(SphereInitConstructor)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("sphere", "sphere &opAssign(const sphere &in)",        asPROFILED_METHODPR(Sphere, operator=, (const Sphere &), Sphere&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("sphere", "float getRadius() const",                   asPROFILED_METHOD(Sphere, getRadius)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("sphere", "void setRadius(float)",                     asPROFILED_METHOD(Sphere, setRadius)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("sphere", "const vector3 &getCenter() const",          asPROFILED_METHOD(Sphere, getCenter)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("sphere", "void setCenter(const vector3 &in)",         asPROFILED_METHOD(Sphere, setCenter)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("sphere", "bool intersects(const sphere &in) const",   asPROFILED_METHODPR(Sphere, intersects, (const Sphere &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("sphere", "bool intersects(const aabb &in) const",     asPROFILED_METHODPR(Sphere, intersects, (const AxisAlignedBox &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("sphere", "bool intersects(const plane &in) const",    asPROFILED_METHODPR(Sphere, intersects, (const Plane &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("sphere", "bool intersects(const vector3 &in) const",  asPROFILED_METHODPR(Sphere, intersects, (const Vector3 &) const, bool)); MYASSERT( r >= 0 );
+}
+
+// register Ogre::AxisAlignedBox
+void registerOgreAxisAlignedBox(AngelScript::asIScriptEngine *engine)
+{
+	int r;
+
+	r = engine->RegisterObjectBehaviour("aabb", asBEHAVE_CONSTRUCT,  "void f()",                                 asPROFILED_FUNCTION_OBJLAST(AxisAlignedBoxDefaultConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("aabb", asBEHAVE_CONSTRUCT,  "void f(const aabb &in)",                   asPROFILED_FUNCTION_OBJLAST(AxisAlignedBoxCopyConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("aabb", asBEHAVE_CONSTRUCT,  "void f(const vector3 &in, const vector3 &in)", asPROFILED_FUNCTION_OBJLAST(AxisAlignedBoxInitConstructor)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectBehaviour("aabb", asBEHAVE_DESTRUCT,   "void f()",                                 asPROFILED_FUNCTION_OBJLAST(AxisAlignedBoxDestructor)); MYASSERT( r >= 0 );
+
+	r = engine->RegisterObjectMethod("aabb", "aabb &opAssign(const aabb &in)",          asPROFILED_METHODPR(AxisAlignedBox, operator=, (const AxisAlignedBox &), AxisAlignedBox&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool opEquals(const aabb &in) const",     asPROFILED_METHODPR(AxisAlignedBox, operator==, (const AxisAlignedBox &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "const vector3 &getMinimum() const",       asPROFILED_METHODPR(AxisAlignedBox, getMinimum, () const, const Vector3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "const vector3 &getMaximum() const",       asPROFILED_METHODPR(AxisAlignedBox, getMaximum, () const, const Vector3&)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void setMinimum(const vector3 &in)",      asPROFILED_METHODPR(AxisAlignedBox, setMinimum, (const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void setMaximum(const vector3 &in)",      asPROFILED_METHODPR(AxisAlignedBox, setMaximum, (const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void setExtents(const vector3 &in, const vector3 &in)", asPROFILED_METHODPR(AxisAlignedBox, setExtents, (const Vector3 &, const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void merge(const aabb &in)",              asPROFILED_METHODPR(AxisAlignedBox, merge, (const AxisAlignedBox &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void merge(const vector3 &in)",           asPROFILED_METHODPR(AxisAlignedBox, merge, (const Vector3 &), void)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void transform(const matrix4 &in)",       asPROFILED_METHOD(AxisAlignedBox, transform)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void transformAffine(const matrix4 &in)", asPROFILED_METHOD(AxisAlignedBox, transformAffine)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void setNull()",                          asPROFILED_METHOD(AxisAlignedBox, setNull)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool isNull() const",                     asPROFILED_METHOD(AxisAlignedBox, isNull)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool isFinite() const",                   asPROFILED_METHOD(AxisAlignedBox, isFinite)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void setInfinite()",                      asPROFILED_METHOD(AxisAlignedBox, setInfinite)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool isInfinite() const",                 asPROFILED_METHOD(AxisAlignedBox, isInfinite)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool intersects(const aabb &in) const",   asPROFILED_METHODPR(AxisAlignedBox, intersects, (const AxisAlignedBox &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool intersects(const sphere &in) const", asPROFILED_METHODPR(AxisAlignedBox, intersects, (const Sphere &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool intersects(const plane &in) const",  asPROFILED_METHODPR(AxisAlignedBox, intersects, (const Plane &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool intersects(const vector3 &in) const", asPROFILED_METHODPR(AxisAlignedBox, intersects, (const Vector3 &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "aabb intersection(const aabb &in) const", asPROFILED_METHOD(AxisAlignedBox, intersection)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "float volume() const",                    asPROFILED_METHOD(AxisAlignedBox, volume)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "void scale(const vector3 &in)",           asPROFILED_METHOD(AxisAlignedBox, scale)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "vector3 getCenter() const",               asPROFILED_METHOD(AxisAlignedBox, getCenter)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "vector3 getSize() const",                 asPROFILED_METHOD(AxisAlignedBox, getSize)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "vector3 getHalfSize() const",             asPROFILED_METHOD(AxisAlignedBox, getHalfSize)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool contains(const vector3 &in) const",  asPROFILED_METHODPR(AxisAlignedBox, contains, (const Vector3 &) const, bool)); MYASSERT( r >= 0 );
+	r = engine->RegisterObjectMethod("aabb", "bool contains(const aabb &in) const",     asPROFILED_METHODPR(AxisAlignedBox, contains, (const AxisAlignedBox &) const, bool)); MYASSERT( r >= 0 );
+}
@@ -38,6 +38,12 @@ THE SOFTWARE.
 //    - Ogre::Radian
 //    - Ogre::Degree
 //    - Ogre::Quaternion
+//    - vector3_array
+//    - keyframe_track and animation_sampler
+//    - Ogre::Matrix3 and Ogre::Matrix4
+//    - Ogre::Ray, with batch intersection against boxes
+//    - Ogre::Plane and Ogre::Sphere
+//    - Ogre::AxisAlignedBox
 void registerOgreObjects(AngelScript::asIScriptEngine *engine);
 
 // The following functions shouldn't be called directly!
@@ -46,5 +52,11 @@ void registerOgreVector3(AngelScript::asIScriptEngine *engine);
 void registerOgreRadian(AngelScript::asIScriptEngine *engine);
 void registerOgreDegree(AngelScript::asIScriptEngine *engine);
 void registerOgreQuaternion(AngelScript::asIScriptEngine *engine);
+void registerOgreVector3Array(AngelScript::asIScriptEngine *engine);
+void registerKeyframeTracks(AngelScript::asIScriptEngine *engine);
+void registerOgreMatrices(AngelScript::asIScriptEngine *engine);
+void registerOgreRay(AngelScript::asIScriptEngine *engine);
+void registerOgrePlaneSphere(AngelScript::asIScriptEngine *engine);
+void registerOgreAxisAlignedBox(AngelScript::asIScriptEngine *engine);
 
 #endif //AS_OGRE_H_
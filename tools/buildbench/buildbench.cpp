@@ -0,0 +1,221 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+// Script build benchmark
+//
+// Generates a synthetic script corpus, one main script including a number of
+// files that all include a shared header, and builds it several times like the
+// game does. Reports the time of every phase of the build and the throughput in
+// thousand lines per second, so regressions of the pipeline show up in numbers.
+// The first round starts with an empty section cache, the later ones reuse it,
+// so they also check that cached sections keep their macros.
+//
+// usage: buildbench [-f <files>] [-n <functions per file>] [-r <rounds>] [-j <threads>]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif //_WIN32
+
+#include <angelscript.h>
+#include "scriptbuilder/scriptbuilder.h"
+
+#include "CBytecodeStream.h"
+
+using namespace std;
+using namespace AngelScript;
+
+static double now()
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif //_WIN32
+}
+
+// serves the generated scripts, the map is only read so the loader threads can share it
+class MemoryScriptBuilder : public CScriptBuilder
+{
+public:
+	MemoryScriptBuilder(const map<string, string> &_sources) : sources(_sources) {};
+protected:
+	const map<string, string> &sources;
+	int ReadScriptSection(const char *filename, string &code)
+	{
+		map<string, string>::const_iterator it = sources.find(filename);
+		if(it == sources.end()) return -1;
+		code = it->second;
+		return 0;
+	}
+};
+
+static void MessageCallback(const asSMessageInfo *msg, void *param)
+{
+	if(msg->type != asMSGTYPE_ERROR) return;
+	fprintf(stderr, "%s (%d, %d) : %s\n", msg->section, msg->row, msg->col, msg->message);
+}
+
+// writes a corpus that uses what real scripts use: includes, metadata, conditional code, classes and globals
+static void generateCorpus(int files, int functions, map<string, string> &sources)
+{
+	char buf[1024];
+	string common =
+		"// shared helpers, included by every file\n"
+		"const float GRAVITY = 9.81f;\n"
+		"float clampValue(float v, float lo, float hi)\n"
+		"{\n"
+		"\tif(v < lo) return lo;\n"
+		"\tif(v > hi) return hi;\n"
+		"\treturn v;\n"
+		"}\n"
+		"#define lerp(a, b, t) a + (b - a) * t\n";
+	sources["common.as"] = common;
+
+	string mainScript = "// synthetic main script\n";
+	for(int f = 0; f < files; f++)
+	{
+		string code = "#include \"common.as\"\n\n";
+		for(int n = 0; n < functions; n++)
+		{
+			sprintf(buf,
+				"[event e%d, hz %d]\n"
+				"void file%d_func%d(float dt)\n"
+				"{\n"
+				"\tfloat x = dt * %d.0f;\n"
+				"\tfor(int k = 0; k < 4; k++)\n"
+				"\t{\n"
+				"\t\tx = clampValue(x + GRAVITY * dt, 0.0f, 100.0f); // keep it in range\n"
+				"\t\tx = lerp(x, 50.0f, 0.1f);\n"
+				"\t}\n"
+				"#if DEBUG\n"
+				"\tx = 0;\n"
+				"#endif\n"
+				"\tfile%d_counter += int(x);\n"
+				"}\n\n",
+				n % 7, 10 + n % 50, f, n, n, f);
+			code += buf;
+		}
+		sprintf(buf,
+			"int file%d_counter = 0;\n\n"
+			"[component]\n"
+			"class File%dState\n"
+			"{\n"
+			"\tint steps;\n"
+			"\tfloat time;\n"
+			"\tvoid update(float dt) { time += dt; steps++; }\n"
+			"}\n",
+			f, f);
+		code += buf;
+
+		sprintf(buf, "file%d.as", f);
+		sources[buf] = code;
+		mainScript += "#include \"" + string(buf) + "\"\n";
+	}
+	mainScript += "\nvoid main()\n{\n}\n";
+	sources["main.as"] = mainScript;
+}
+
+int main(int argc, char **argv)
+{
+	int files = 50, functions = 40, rounds = 3, threads = 4;
+	for(int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		bool hasValue = (i + 1 < argc);
+		if(arg == "-f" && hasValue)       files     = atoi(argv[++i]);
+		else if(arg == "-n" && hasValue)  functions = atoi(argv[++i]);
+		else if(arg == "-r" && hasValue)  rounds    = atoi(argv[++i]);
+		else if(arg == "-j" && hasValue)  threads   = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: buildbench [-f <files>] [-n <functions per file>] [-r <rounds>] [-j <threads>]\n");
+			return 1;
+		}
+	}
+	if(files < 1) files = 1;
+	if(rounds < 1) rounds = 1;
+
+	map<string, string> sources;
+	generateCorpus(files, functions, sources);
+
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	if(!engine)
+	{
+		fprintf(stderr, "could not create the script engine\n");
+		return 1;
+	}
+	engine->SetMessageCallback(asFUNCTION(MessageCallback), 0, asCALL_CDECL);
+
+	CScriptBuilder::CSectionCache sectionCache;
+	printf("round  sections    lines     tokens   read  preproc metadata  addsec    build     save    total    KLOC/s\n");
+	for(int r = 0; r < rounds; r++)
+	{
+		double start = now();
+
+		MemoryScriptBuilder builder(sources);
+		builder.SetLoaderThreads(threads);
+		builder.SetSectionCache(&sectionCache);
+		int result = builder.StartNewModule(engine, "bench");
+		if(result >= 0) result = builder.AddSectionFromFile("main.as");
+		if(result >= 0) result = builder.BuildModule();
+		if(result < 0)
+		{
+			fprintf(stderr, "the corpus failed to build\n");
+			engine->Release();
+			return 1;
+		}
+
+		// store the bytecode the way the game does, only in memory
+		double saveStart = now();
+		CBytecodeStream bstream("", builder.GetSectionsHash(), 0);
+		engine->GetModule("bench")->SaveByteCode(&bstream);
+		double saveTime = now() - saveStart;
+
+		double total = now() - start;
+		const CScriptBuilder::SBuildStatistics &s = builder.GetStatistics();
+		printf("%5d %9u %8u %10u %6.1f %8.1f %8.1f %7.1f %8.1f %8.1f %8.1f %9.1f\n", r + 1, s.sections, s.lines, s.tokens,
+			s.readTime, s.preprocessTime, s.metadataTime, s.addSectionTime, s.buildTime, saveTime, total,
+			total > 0 ? s.lines / total : 0.0);
+	}
+	printf("times in ms, read and preprocess are summed over %d loader threads\n", threads);
+
+	engine->Release();
+	return 0;
+}
@@ -0,0 +1,194 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+// Bytecode cache benchmark
+//
+// Stores all modules of a bundle once uncompressed and once compressed and
+// reports the size ratio and the time it takes to load every module from each.
+// On Linux the files are dropped from the page cache before every round, so the
+// numbers include the disk read. Elsewhere the second round onwards is warm.
+//
+// usage: bytecodebench <bundle> [rounds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif //_WIN32
+
+#include <angelscript.h>
+
+#include "CBytecodeStream.h"
+#include "CBytecodeBundle.h"
+#include "LZCompression.h"
+
+using namespace std;
+
+static double now()
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif //_WIN32
+}
+
+static void dropFromCache(const string &filename)
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+	int fd = open(filename.c_str(), O_RDONLY);
+	if(fd < 0) return;
+	fdatasync(fd);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	close(fd);
+#endif
+}
+
+// loads every module like the game does, returns the time in ms or a negative value on error
+static double loadAll(const string &filename, size_t &bytes)
+{
+	dropFromCache(filename);
+
+	double start = now();
+	CBytecodeBundle bundle;
+	if(bundle.open(filename)) return -1;
+
+	bytes = 0;
+	std::vector<char> unpacked, out;
+	for(unsigned int i = 0; i < bundle.getModuleCount(); i++)
+	{
+		const bundleEntry_t *e = bundle.getEntry(i);
+		CBytecodeReadStream bstream(bundle.getBytecode(e, unpacked), (size_t)e->rawLength, e->checksum);
+		if(!bstream.IsValid()) return -1;
+
+		// the engine reads the bytecode in small pieces
+		out.resize((size_t)e->rawLength);
+		for(size_t pos = 0; pos < out.size(); pos += 4)
+			bstream.Read(&out[pos], (AngelScript::asUINT)(out.size() - pos < 4 ? out.size() - pos : 4));
+		if(bstream.Failed()) return -1;
+		bytes += out.size();
+	}
+	return now() - start;
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		fprintf(stderr, "usage: bytecodebench <bundle> [rounds]\n");
+		return 1;
+	}
+	string source = argv[1];
+	int rounds = argc > 2 ? atoi(argv[2]) : 5;
+	if(rounds < 1) rounds = 1;
+
+	CBytecodeBundle input;
+	if(input.open(source) || !input.getModuleCount())
+	{
+		fprintf(stderr, "%s is not a bundle or has no modules\n", source.c_str());
+		return 1;
+	}
+
+	string plainFile  = source + ".plain";
+	string packedFile = source + ".packed";
+	remove(plainFile.c_str());
+	remove(packedFile.c_str());
+
+	CBytecodeBundle plain, packed;
+	plain.open(plainFile);
+	packed.open(packedFile);
+
+	size_t rawSize = 0, packedSize = 0;
+	double compressTime = 0, decompressTime = 0;
+	std::vector<char> bytecode, buffer, unpacked;
+	for(unsigned int i = 0; i < input.getModuleCount(); i++)
+	{
+		const bundleEntry_t *e = input.getEntry(i);
+		const char *data = input.getBytecode(e, buffer);
+		if(!data) continue;
+		bytecode.assign(data, data + e->rawLength);
+
+		double start = now();
+		lzCompress(&bytecode[0], bytecode.size(), buffer);
+		compressTime += now() - start;
+
+		unpacked.resize(bytecode.size());
+		start = now();
+		lzDecompress(&buffer[0], buffer.size(), &unpacked[0], unpacked.size());
+		decompressTime += now() - start;
+
+		rawSize    += bytecode.size();
+		packedSize += std::min(buffer.size(), bytecode.size());
+
+		// every module needs its own name, otherwise compacting would drop them
+		char name[32];
+		sprintf(name, "module%u", i);
+		plain.append(name, e->sectionsHash, e->fingerprint, bytecode, false);
+		packed.append(name, e->sectionsHash, e->fingerprint, bytecode, true);
+	}
+	plain.close();
+	packed.close();
+
+	printf("%u modules, %u bytes of bytecode\n", input.getModuleCount(), (unsigned int)rawSize);
+	printf("compressed: %u bytes, ratio %.3f\n", (unsigned int)packedSize, rawSize ? (double)packedSize / rawSize : 0.0);
+	printf("compression %.1f MB/s, decompression %.1f MB/s\n",
+		compressTime > 0 ? rawSize / compressTime / 1000.0 : 0.0, decompressTime > 0 ? rawSize / decompressTime / 1000.0 : 0.0);
+
+	double plainTotal = 0, packedTotal = 0;
+	for(int r = 0; r < rounds; r++)
+	{
+		size_t bytes = 0;
+		double tPlain  = loadAll(plainFile, bytes);
+		double tPacked = loadAll(packedFile, bytes);
+		if(tPlain < 0 || tPacked < 0)
+		{
+			fprintf(stderr, "loading failed\n");
+			return 1;
+		}
+		printf("round %d: uncompressed %.2f ms, compressed %.2f ms\n", r + 1, tPlain, tPacked);
+		plainTotal  += tPlain;
+		packedTotal += tPacked;
+	}
+	printf("average load: uncompressed %.2f ms, compressed %.2f ms\n", plainTotal / rounds, packedTotal / rounds);
+
+	remove(plainFile.c_str());
+	remove(packedFile.c_str());
+	return 0;
+}
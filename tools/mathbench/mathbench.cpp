@@ -0,0 +1,191 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+// Script math benchmark
+//
+// Runs the same computation over a float array once as a scalar script loop,
+// calling the math function per element, and once with the array overloads
+// registered by RegisterScriptMathArray, both precise and with the fast
+// approximations. Reports the time per pass and the speedup over the loop.
+//
+// usage: mathbench [-n <elements>] [-r <rounds>]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif //_WIN32
+
+#include <angelscript.h>
+#include "scriptarray/scriptarray.h"
+#include "scriptmath/scriptmath.h"
+#include "scriptmath/scriptmatharray.h"
+
+using namespace std;
+using namespace AngelScript;
+
+static double now()
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif //_WIN32
+}
+
+static void MessageCallback(const asSMessageInfo *msg, void *param)
+{
+	if(msg->type != asMSGTYPE_ERROR) return;
+	fprintf(stderr, "%s (%d, %d) : %s\n", msg->section, msg->row, msg->col, msg->message);
+}
+
+// every test has a scalar loop and the same computation with the array overload
+static const char *benchScript =
+	"array<float> x(N), y(N);\n"
+	"void setup()\n"
+	"{\n"
+	"\tfor(uint i = 0; i < x.length(); i++)\n"
+	"\t{\n"
+	"\t\tx[i] = 0.5f + float(i % 1000) * 0.01f;\n"
+	"\t\ty[i] = 1.0f;\n"
+	"\t}\n"
+	"}\n"
+	"void scalarSin()  { for(uint i = 0; i < x.length(); i++) y[i] = sin(x[i]); }\n"
+	"void arraySin()   { sin(x, y); }\n"
+	"void scalarCos()  { for(uint i = 0; i < x.length(); i++) y[i] = cos(x[i]); }\n"
+	"void arrayCos()   { cos(x, y); }\n"
+	"void scalarLog()  { for(uint i = 0; i < x.length(); i++) y[i] = log(x[i]); }\n"
+	"void arrayLog()   { log(x, y); }\n"
+	"void scalarPow()  { for(uint i = 0; i < x.length(); i++) y[i] = pow(x[i], 2.5f); }\n"
+	"void arrayPow()   { pow(x, 2.5f, y); }\n"
+	"void scalarSqrt() { for(uint i = 0; i < x.length(); i++) y[i] = sqrt(x[i]); }\n"
+	"void arraySqrt()  { sqrt(x, y); }\n"
+	"void scalarAxpy() { for(uint i = 0; i < x.length(); i++) y[i] = 0.5f * x[i] + y[i]; }\n"
+	"void arrayAxpy()  { axpy(0.5f, x, y); }\n";
+
+static const char *tests[] = { "Sin", "Cos", "Log", "Pow", "Sqrt", "Axpy" };
+
+static asIScriptEngine *createEngine(bool fastApproximations, int elements)
+{
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	if(!engine) return 0;
+	engine->SetMessageCallback(asFUNCTION(MessageCallback), 0, asCALL_CDECL);
+	RegisterScriptArray(engine, true);
+	RegisterScriptMath(engine);
+	RegisterScriptMathArray(engine, fastApproximations);
+
+	char buf[64];
+	sprintf(buf, "const uint N = %d;\n", elements);
+	string code = string(buf) + benchScript;
+	asIScriptModule *mod = engine->GetModule("bench", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("bench", code.c_str(), code.size());
+	if(mod->Build() < 0)
+	{
+		engine->Release();
+		return 0;
+	}
+	return engine;
+}
+
+// average time of one call of the function in ms, -1 on failure
+static double timeFunction(asIScriptEngine *engine, asIScriptContext *ctx, const string &decl, int rounds)
+{
+	int funcId = engine->GetModule("bench")->GetFunctionIdByDecl(decl.c_str());
+	if(funcId < 0) return -1;
+
+	double start = now();
+	for(int r = 0; r < rounds; r++)
+	{
+		ctx->Prepare(funcId);
+		if(ctx->Execute() != asEXECUTION_FINISHED) return -1;
+	}
+	return (now() - start) / rounds;
+}
+
+int main(int argc, char **argv)
+{
+	int elements = 100000, rounds = 20;
+	for(int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		bool hasValue = (i + 1 < argc);
+		if(arg == "-n" && hasValue)       elements = atoi(argv[++i]);
+		else if(arg == "-r" && hasValue)  rounds   = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: mathbench [-n <elements>] [-r <rounds>]\n");
+			return 1;
+		}
+	}
+	if(elements < 1) elements = 1;
+	if(rounds < 1) rounds = 1;
+
+	asIScriptEngine *precise = createEngine(false, elements);
+	asIScriptEngine *fast    = createEngine(true, elements);
+	if(!precise || !fast)
+	{
+		fprintf(stderr, "could not set up the script engines\n");
+		if(precise) precise->Release();
+		if(fast) fast->Release();
+		return 1;
+	}
+	asIScriptContext *preciseCtx = precise->CreateContext();
+	asIScriptContext *fastCtx    = fast->CreateContext();
+	timeFunction(precise, preciseCtx, "void setup()", 1);
+	timeFunction(fast, fastCtx, "void setup()", 1);
+
+	printf("function   scalar loop     array  array fast   speedup  fast speedup\n");
+	for(unsigned int i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+	{
+		double scalar     = timeFunction(precise, preciseCtx, string("void scalar") + tests[i] + "()", rounds);
+		double array      = timeFunction(precise, preciseCtx, string("void array") + tests[i] + "()", rounds);
+		double arrayFast  = timeFunction(fast, fastCtx, string("void array") + tests[i] + "()", rounds);
+		if(scalar < 0 || array < 0 || arrayFast < 0)
+		{
+			fprintf(stderr, "%s failed to run\n", tests[i]);
+			continue;
+		}
+		printf("%-8s %13.3f %9.3f %11.3f %8.1fx %12.1fx\n", tests[i], scalar, array, arrayFast,
+			array > 0 ? scalar / array : 0.0, arrayFast > 0 ? scalar / arrayFast : 0.0);
+	}
+	printf("times in ms per pass over %d elements, averaged over %d rounds\n", elements, rounds);
+
+	preciseCtx->Release();
+	fastCtx->Release();
+	precise->Release();
+	fast->Release();
+	return 0;
+}
@@ -0,0 +1,236 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE-angelscript
+
+For the latest info, see http://code.google.com/p/ogre-angelscript/
+
+Copyright (c) 2006-2011 Thomas Fischer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+// Offline script compiler
+//
+// Compiles scripts against the application interface the game writes to
+// "Cache Path"/scriptinterface.txt and stores the bytecode in a bundle.
+// The bundle is put next to the game resources at package time, the game
+// then loads the precompiled modules instead of compiling the scripts.
+//
+// usage: scriptcompiler -c <interface> -o <bundle> [-I <dir>]... [-D <word>]... [-a] [-z] [-j <threads>] <script>...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include <angelscript.h>
+#include "scriptbuilder/scriptbuilder.h"
+#include "scripthelper/scripthelper.h"
+
+#include "CBytecodeStream.h"
+#include "CBytecodeBundle.h"
+
+using namespace std;
+using namespace AngelScript;
+
+// loads scripts and includes by name from a list of directories, like the game does through the resource system
+class FileScriptBuilder : public CScriptBuilder
+{
+public:
+	FileScriptBuilder(const vector<string> &_dirs) : dirs(_dirs) {};
+protected:
+	vector<string> dirs;
+	int ReadScriptSection(const char *filename, string &code);
+};
+
+int FileScriptBuilder::ReadScriptSection(const char *filename, string &code)
+{
+	for(unsigned int i = 0; i < dirs.size(); i++)
+	{
+		string path = dirs[i].empty() ? string(filename) : dirs[i] + "/" + filename;
+		FILE *f = fopen(path.c_str(), "rb");
+		if(!f) continue;
+
+		// Read the entire file
+		code.clear();
+		fseek(f, 0, SEEK_END);
+		long len = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		if(len > 0)
+		{
+			code.resize(len);
+			len = (long)fread(&code[0], 1, len, f);
+			code.resize(len);
+		}
+		fclose(f);
+
+		// the section is named like the game names it, otherwise the hashes would not match
+		return 0;
+	}
+
+	fprintf(stderr, "script file not found: %s\n", filename);
+	return -1;
+}
+
+static void MessageCallback(const asSMessageInfo *msg, void *param)
+{
+	const char *type = "ERR ";
+	if(msg->type == asMSGTYPE_WARNING)
+		type = "WARN";
+	else if(msg->type == asMSGTYPE_INFORMATION)
+		type = "INFO";
+
+	fprintf(stderr, "%s (%d, %d) : %s : %s\n", msg->section, msg->row, msg->col, type, msg->message);
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: scriptcompiler -c <interface> -o <bundle> [-I <dir>]... [-D <word>]... [-a] [-z] [-j <threads>] <script>...\n");
+	fprintf(stderr, "  -c <interface>  application interface written by the game\n");
+	fprintf(stderr, "  -o <bundle>     bytecode bundle to write\n");
+	fprintf(stderr, "  -I <dir>        directory with scripts and includes, can be repeated\n");
+	fprintf(stderr, "  -D <word>       define a word for conditional compilation, can be repeated\n");
+	fprintf(stderr, "  -a              add to an existing bundle instead of replacing it\n");
+	fprintf(stderr, "  -z              store the bytecode compressed\n");
+	fprintf(stderr, "  -j <threads>    threads reading and preprocessing the includes, default 4\n");
+}
+
+int main(int argc, char **argv)
+{
+	string configFile, bundleFile;
+	vector<string> dirs, defines, scripts;
+	bool appendBundle = false, compress = false;
+	int loaderThreads = 4;
+
+	for(int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		bool hasValue = (i + 1 < argc);
+		if(arg == "-c" && hasValue)       configFile = argv[++i];
+		else if(arg == "-o" && hasValue)  bundleFile = argv[++i];
+		else if(arg == "-I" && hasValue)  dirs.push_back(argv[++i]);
+		else if(arg == "-D" && hasValue)  defines.push_back(argv[++i]);
+		else if(arg == "-a")              appendBundle = true;
+		else if(arg == "-z")              compress = true;
+		else if(arg == "-j" && hasValue)  loaderThreads = atoi(argv[++i]);
+		else if(arg[0] == '-')
+		{
+			usage();
+			return 1;
+		}
+		else scripts.push_back(arg);
+	}
+	if(configFile.empty() || bundleFile.empty() || scripts.empty())
+	{
+		usage();
+		return 1;
+	}
+	if(dirs.empty()) dirs.push_back("");
+
+	// the game fingerprints the interface by hashing the text it writes, so hash the file as it is
+	ifstream cfg(configFile.c_str());
+	if(!cfg.is_open())
+	{
+		fprintf(stderr, "could not open the interface file %s\n", configFile.c_str());
+		return 1;
+	}
+	stringstream config;
+	config << cfg.rdbuf();
+	string configText = config.str();
+	asQWORD fingerprint = hashBytecode(configText.c_str(), configText.size());
+
+	asIScriptEngine *engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+	if(!engine)
+	{
+		fprintf(stderr, "could not create the script engine\n");
+		return 1;
+	}
+	engine->SetMessageCallback(asFUNCTION(MessageCallback), 0, asCALL_CDECL);
+
+	if(ConfigEngineFromStream(engine, config, configFile.c_str()) < 0)
+	{
+		engine->Release();
+		return 1;
+	}
+
+	CBytecodeBundle bundle;
+	if(!appendBundle) remove(bundleFile.c_str());
+	if(bundle.open(bundleFile))
+	{
+		fprintf(stderr, "%s is not a valid bundle\n", bundleFile.c_str());
+		engine->Release();
+		return 1;
+	}
+
+	// the scripts share most of their includes, those are only preprocessed once
+	CScriptBuilder::CSectionCache sectionCache;
+
+	int failed = 0;
+	clock_t totalStart = clock();
+	for(unsigned int i = 0; i < scripts.size(); i++)
+	{
+		clock_t start = clock();
+		const char *name = scripts[i].c_str();
+
+		FileScriptBuilder builder(dirs);
+		builder.SetLoaderThreads(loaderThreads);
+		builder.SetSectionCache(&sectionCache);
+		int r = builder.StartNewModule(engine, name);
+		for(unsigned int j = 0; j < defines.size() && r >= 0; j++)
+			builder.DefineWord(defines[j].c_str());
+		if(r >= 0) r = builder.AddSectionFromFile(name);
+		if(r >= 0) r = builder.BuildModule();
+		if(r < 0)
+		{
+			fprintf(stderr, "%s: failed to compile\n", name);
+			failed++;
+			continue;
+		}
+
+		CBytecodeStream bstream("", builder.GetSectionsHash(), fingerprint);
+		asIScriptModule *mod = engine->GetModule(name, asGM_ONLY_IF_EXISTS);
+		if(mod->SaveByteCode(&bstream) < 0 || bundle.append(name, builder.GetSectionsHash(), fingerprint, bstream.getBytecode(), compress))
+		{
+			fprintf(stderr, "%s: could not add the bytecode to %s\n", name, bundleFile.c_str());
+			failed++;
+		} else
+		{
+			printf("%s: %u bytes, %.1f ms\n", name, (unsigned int)bstream.getBytecode().size(), (clock() - start) * 1000.0 / CLOCKS_PER_SEC);
+		}
+		engine->DiscardModule(name);
+	}
+
+	// only keep the newest module per script, modules for other interfaces are useless for this build
+	if(bundle.compact(fingerprint))
+	{
+		fprintf(stderr, "could not compact %s\n", bundleFile.c_str());
+		failed++;
+	}
+
+	printf("%u of %u scripts compiled into %s (%u modules, %u bytes) in %.1f ms\n",
+		(unsigned int)(scripts.size() - failed), (unsigned int)scripts.size(), bundleFile.c_str(),
+		bundle.getModuleCount(), (unsigned int)bundle.getFileSize(), (clock() - totalStart) * 1000.0 / CLOCKS_PER_SEC);
+
+	engine->Release();
+	return failed ? 1 : 0;
+}